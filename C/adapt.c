@@ -0,0 +1,227 @@
+/****************************************************************************
+FILE          : adapt.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Adaptive ordering of AND and OR operands.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+If the operands of an AND are independent, operand i is false with
+probability p[i] and costs c[i] questions on average, the expected
+number of questions is least when the operands are sorted by p[i]/c[i]
+with the largest first (for an OR, p[i] is the chance of being true).
+The estimates come from the answers seen so far. An operand that has
+never been tried counts as even odds, so a new condition starts in its
+written order.
+
+An operand only moves ahead of another when its score is clearly
+better, so that two operands with nearly equal scores don't trade
+places every time their statistics are checked.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdlib.h>
+#include "adapt.h"
+#include "module.h"
+
+// The order of a node is checked after this many evaluations.
+#define ADAPT_INTERVAL 32
+
+// How much better a score must be to move an operand forward.
+#define ADAPT_MARGIN 1.10
+
+struct adapter *execution_adapter = NULL;
+
+static void find_owners(
+  struct adapter *a, struct expression *e, const struct statement *owner, int *next)
+{
+  int i;
+
+  a->owner[e->id] = owner;
+  if (e->count > 0) {
+    a->first[e->id] = *next;
+    for (i = 0; i < e->count; ++i) a->order[(*next)++] = i;
+  }
+  if (e->first != NULL) find_owners(a, e->first, owner, next);
+  if (e->second != NULL) find_owners(a, e->second, owner, next);
+  for (i = 0; i < e->count; ++i) find_owners(a, e->operands[i], owner, next);
+}
+
+
+struct adapter *new_adapter(const struct tree_info *info, FILE *trace)
+{
+  struct adapter *a = (struct adapter *)calloc(1, sizeof(struct adapter));
+  int n = info->expression_count + 1;
+  int next = 0;
+  int i;
+
+  a->expression_count = info->expression_count;
+  a->tries       = (unsigned long long *)calloc(n, sizeof(unsigned long long));
+  a->decisive    = (unsigned long long *)calloc(n, sizeof(unsigned long long));
+  a->questions   = (unsigned long long *)calloc(n, sizeof(unsigned long long));
+  a->evaluations = (unsigned long long *)calloc(n, sizeof(unsigned long long));
+  a->first       = (int *)malloc(n * sizeof(int));
+  // Every operand is a different expression, so this is big enough.
+  a->order       = (int *)malloc(n * sizeof(int));
+  a->owner       = (const struct statement **)calloc(n, sizeof(struct statement *));
+  a->trace       = trace;
+  for (i = 0; i < info->expression_count; ++i) a->first[i] = -1;
+  for (i = 0; i < info->statement_count; ++i) {
+    struct statement *s = info->statements[i];
+    if (s->conditional != NULL) find_owners(a, s->conditional, s, &next);
+  }
+  return a;
+}
+
+
+void free_adapter(struct adapter *a)
+{
+  if (a == NULL) return;
+  free(a->tries);
+  free(a->decisive);
+  free(a->questions);
+  free(a->evaluations);
+  free(a->first);
+  free(a->order);
+  free(a->owner);
+  free(a);
+}
+
+
+static double score(const struct adapter *a, const struct expression *e)
+{
+  double p = (a->decisive[e->id] + 1.0) / (a->tries[e->id] + 2.0);
+  double c = 1.0;
+
+  if (a->tries[e->id] != 0 && a->questions[e->id] != 0) {
+    c = (double)a->questions[e->id] / a->tries[e->id];
+  }
+  return p / c;
+}
+
+
+// Writes a condition in the order the adapter asks it.
+static void write_condition(const struct adapter *a, struct expression *e, int outer)
+{
+  const int *order;
+  int i;
+
+  switch (e->op) {
+    case PASSop:
+      write_condition(a, e->first, outer);
+      break;
+
+    case NOTop:
+      fputs("NOT ", a->trace);
+      write_condition(a, e->first, 0);
+      break;
+
+    case ANDop:
+    case ORop:
+      if (!outer) putc('(', a->trace);
+      if (e->count == 0) {
+        write_condition(a, e->first, 0);
+        fputs(e->op == ANDop ? " AND " : " OR ", a->trace);
+        write_condition(a, e->second, 0);
+      }
+      else {
+        order = &a->order[a->first[e->id]];
+        for (i = 0; i < e->count; ++i) {
+          if (i > 0) fputs(e->op == ANDop ? " AND " : " OR ", a->trace);
+          write_condition(a, e->operands[order[i]], 0);
+        }
+      }
+      if (!outer) putc(')', a->trace);
+      break;
+
+    case PROMPTop:
+      fputs(vtc_string_getcharp(e->ep), a->trace);
+      break;
+  }
+}
+
+
+// Insertion sort by score, largest first.
+static void reorder(struct adapter *a, struct expression *e)
+{
+  int    *order = &a->order[a->first[e->id]];
+  int     changed = 0;
+  int     i, j, moving;
+  double  moving_score;
+  char    where[300];
+
+  for (i = 1; i < e->count; ++i) {
+    moving = order[i];
+    moving_score = score(a, e->operands[moving]);
+    for (j = i; j > 0; --j) {
+      if (moving_score <= ADAPT_MARGIN * score(a, e->operands[order[j - 1]])) break;
+      order[j] = order[j - 1];
+    }
+    if (j != i) {
+      order[j] = moving;
+      changed = 1;
+    }
+  }
+  if (!changed) return;
+  ++a->reorders;
+  if (a->trace != NULL) {
+    fprintf(a->trace, "(Reordered the condition on %s: ", describe_line(where, sizeof(where),
+      a->owner[e->id]->module, a->owner[e->id]->line));
+    write_condition(a, e, 1);
+    fprintf(a->trace, ")\n");
+  }
+}
+
+
+int adapt_evaluate(
+  struct adapter *a, struct expression *e, adapt_question ask, void *context)
+{
+  struct expression *operand;
+  const int *order;
+  unsigned long long before;
+  int stop, result = 0;
+  int i;
+
+  switch (e->op) {
+    case PASSop:
+      return adapt_evaluate(a, e->first, ask, context);
+
+    case NOTop:
+      return !adapt_evaluate(a, e->first, ask, context);
+
+    case PROMPTop:
+      ++a->asked;
+      return ask(context, e);
+
+    case ANDop:
+    case ORop:
+      if (e->count == 0) {
+        result = adapt_evaluate(a, e->first, ask, context);
+        if (result == (e->op == ORop)) return result;
+        return adapt_evaluate(a, e->second, ask, context);
+      }
+
+      // An AND stops at the first false operand, an OR at the first true.
+      stop   = (e->op == ORop);
+      result = !stop;
+      order  = &a->order[a->first[e->id]];
+      for (i = 0; i < e->count; ++i) {
+        operand = e->operands[order[i]];
+        before  = a->asked;
+        result  = adapt_evaluate(a, operand, ask, context);
+        a->tries[operand->id]++;
+        a->questions[operand->id] += a->asked - before;
+        if (result == stop) {
+          a->decisive[operand->id]++;
+          break;
+        }
+      }
+      if (++a->evaluations[e->id] % ADAPT_INTERVAL == 0) reorder(a, e);
+      break;
+  }
+  return result;
+}
@@ -0,0 +1,62 @@
+/****************************************************************************
+FILE          : adapt.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to adaptive ordering of AND and OR operands.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Normally the operands of AND and OR are asked about left to right. When
+a condition is evaluated many times the answers show which operands
+usually settle the result: an operand that is nearly always false ends
+an AND at once, while one that is nearly always true only adds a
+question. An adapter keeps answer statistics for each operand of the
+optimized n-ary AND and OR nodes (see opt.h) and from time to time puts
+the operands in the order that is expected to need the fewest questions.
+
+Every phrase in a condition is a pure question, so asking them in a
+different order doesn't change the value of the condition, only which
+questions are needed to find it. The order is kept by the adapter, not in
+the tree, so several adapters (one per simulator thread) can share a tree.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef ADAPT_H
+#define ADAPT_H
+
+#include <stdio.h>
+#include "tree.h"
+
+// Answers a question. The expression is a PROMPTop node.
+typedef int (*adapt_question)(void *context, struct expression *prompt);
+
+struct adapter {
+  int                 expression_count;
+  unsigned long long *tries;        // Times evaluated as an operand.
+  unsigned long long *decisive;     // Times it settled its AND or OR.
+  unsigned long long *questions;    // Questions asked evaluating it.
+  unsigned long long *evaluations;  // AND and OR nodes: times evaluated.
+  int                *first;        // AND and OR nodes: index into order.
+  int                *order;        // The current order of the operands.
+  const struct statement **owner;   // The statement owning each node.
+  unsigned long long  asked;        // Questions asked in total.
+  long                reorders;     // Times an order was changed.
+  FILE               *trace;        // Reorders are reported here if not NULL.
+};
+
+// The interpreter uses this adapter if it isn't NULL.
+extern struct adapter *execution_adapter;
+
+// Make an adapter for a tree that has been through optimize_expressions().
+struct adapter *new_adapter(const struct tree_info *info, FILE *trace);
+void free_adapter(struct adapter *a);
+
+// Evaluate a condition asking questions in the adapter's order.
+int adapt_evaluate(
+  struct adapter *a, struct expression *e, adapt_question ask, void *context);
+
+#endif
@@ -0,0 +1,117 @@
+/****************************************************************************
+FILE          : budget.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Execution budgets.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+This file implements the functions declared in budget.h.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "budget.h"
+#include "events.h"
+#include "tree.h"
+
+long budget_countdown = LONG_MAX;
+
+static struct budget   limits;
+static long            statements;   // Executed before the current countdown began.
+static long            batch;        // What the countdown began at.
+static long            decisions;
+static long            output;
+static struct timespec started;
+
+// Starts the next countdown.
+static void wind(void)
+{
+  batch = LONG_MAX / 2;
+  if (limits.seconds > 0) batch = BUDGET_CLOCK_STEPS;
+  if (limits.statements > 0 && limits.statements + 1 - statements < batch) {
+    batch = limits.statements + 1 - statements;
+  }
+  budget_countdown = batch;
+}
+
+
+void budget_start(const struct budget *given)
+{
+  limits = *given;
+  clock_gettime(CLOCK_MONOTONIC, &started);
+  wind();
+}
+
+
+// Says which budget ran out and where, then stops.
+static void stop(enum budget_status status, const char *what, double amount)
+{
+  char reason[128];
+
+  // Nothing written from here on counts against a budget.
+  limits.output = 0;
+
+  if (status == BUDGET_TIME) sprintf(reason, "%s budget of %g seconds ran out", what, amount);
+  else sprintf(reason, "%s budget of %.0f ran out", what, amount);
+  if (events_on) {
+    event_end("stop", reason);
+  }
+  else {
+    printf("\nStopped: the %s after %ld statements, %ld questions. Execution was at\n",
+      reason, statements + batch - budget_countdown, decisions);
+    write_position(stdout);
+  }
+  exit(status);
+}
+
+
+static void check_clock(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if ((now.tv_sec - started.tv_sec) + (now.tv_nsec - started.tv_nsec) / 1e9 > limits.seconds) {
+    stop(BUDGET_TIME, "time", limits.seconds);
+  }
+}
+
+
+void budget_check(void)
+{
+  // The statement that ran the countdown out hasn't been executed yet.
+  statements += batch - 1;
+  batch = budget_countdown = 0;
+  if (limits.statements > 0 && statements >= limits.statements) {
+    stop(BUDGET_STATEMENTS, "statement", limits.statements);
+  }
+  ++statements;
+  if (limits.seconds > 0) check_clock();
+  wind();
+}
+
+
+void budget_decision(void)
+{
+  if (limits.decisions > 0 && decisions >= limits.decisions) {
+    stop(BUDGET_DECISIONS, "question", limits.decisions);
+  }
+  ++decisions;
+  if (limits.seconds > 0) check_clock();
+}
+
+
+void budget_output(long bytes)
+{
+  output += bytes;
+  if (limits.output > 0 && output > limits.output) {
+    stop(BUDGET_OUTPUT, "output", limits.output);
+  }
+}
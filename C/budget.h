@@ -0,0 +1,67 @@
+/****************************************************************************
+FILE          : budget.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to execution budgets.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+An execution can be given budgets for the questions answered, the
+statements executed, the wall clock time and the bytes of output. When
+one runs out the program says where execution was and stops with an
+exit status that tells which budget it was (see enum budget_status), so
+that a batch job running a program that never ends fails quickly.
+
+The statement count is kept with a countdown that the executor
+decrements for each statement; only when it reaches zero are the
+budgets actually looked at. The countdown is set so that this happens
+when the statement budget runs out, or every BUDGET_CLOCK_STEPS
+statements if there is a time budget.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#define BUDGET_CLOCK_STEPS 4096
+
+// Exit statuses for the budgets.
+enum budget_status {
+  BUDGET_DECISIONS  = 3,
+  BUDGET_STATEMENTS = 4,
+  BUDGET_TIME       = 5,
+  BUDGET_OUTPUT     = 6
+};
+
+// The budgets. Zero means no limit.
+struct budget {
+  long   decisions;
+  long   statements;
+  double seconds;
+  long   output;
+};
+
+// Statements left before the budgets are looked at again.
+extern long budget_countdown;
+
+// Starts counting. The clock starts now.
+void budget_start(const struct budget *limits);
+
+// Looks at the budgets when the countdown runs out.
+void budget_check(void);
+
+// Called by the executor for each statement, question and piece of
+// output.
+static inline void budget_statement(void)
+{
+  if (--budget_countdown <= 0) budget_check();
+}
+
+void budget_decision(void);
+void budget_output(long bytes);
+
+#endif
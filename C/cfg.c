@@ -0,0 +1,885 @@
+/****************************************************************************
+FILE          : cfg.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Control flow graph construction and analysis.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Everything here is written to handle programs with millions of nodes.
+Blocks and edges live in flat arrays, adjacency is kept in compressed
+form, and no function recurses on anything but the nesting depth of the
+source (depth first searches use explicit stacks).
+
+Dominators are computed with the Lengauer-Tarjan algorithm (the "simple"
+version with path compression, O(m log n)). Post-dominators are the
+dominators of the reversed graph rooted at the exit block. A natural loop
+is found for every back edge u->h where h dominates u; loops with the
+same header are merged.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "cfg.h"
+#include "intern.h"
+#include "module.h"
+
+// Loop context while lowering.
+struct loop_target {
+  int continue_block;
+  int break_block;
+};
+
+struct builder {
+  struct cfg         *graph;
+  int                 block_capacity;
+  int                 edge_capacity;
+  int                 action_capacity;
+  struct loop_target *loops;
+  int                 loop_depth;
+  int                 loop_capacity;
+};
+
+//-----------------------------
+//      Construction
+//-----------------------------
+
+static int new_block(struct builder *b, enum cfg_block_kind kind, int line, int module)
+{
+  struct cfg *g = b->graph;
+  struct cfg_block *block;
+
+  if (g->block_count == b->block_capacity) {
+    b->block_capacity = b->block_capacity ? 2 * b->block_capacity : 64;
+    g->blocks = (struct cfg_block *)
+      realloc(g->blocks, b->block_capacity * sizeof(struct cfg_block));
+  }
+  block = &g->blocks[g->block_count];
+  block->kind         = kind;
+  block->first_action = -1;
+  block->last_action  = -1;
+  block->action_count = 0;
+  block->test         = NULL;
+  block->statement    = NULL;
+  block->line         = line;
+  block->module       = module;
+  return g->block_count++;
+}
+
+
+static void new_edge(
+  struct builder *b, int from, int to, enum cfg_edge_kind kind,
+  struct case_branch *cb)
+{
+  struct cfg *g = b->graph;
+
+  if (from < 0) return;   // Unreachable code has nowhere to come from.
+  if (g->edge_count == b->edge_capacity) {
+    b->edge_capacity = b->edge_capacity ? 2 * b->edge_capacity : 64;
+    g->edge_from = (int *)realloc(g->edge_from, b->edge_capacity * sizeof(int));
+    g->edge_to   = (int *)realloc(g->edge_to, b->edge_capacity * sizeof(int));
+    g->edge_kind = (unsigned char *)realloc(g->edge_kind, b->edge_capacity);
+    g->edge_case = (struct case_branch **)
+      realloc(g->edge_case, b->edge_capacity * sizeof(struct case_branch *));
+  }
+  g->edge_from[g->edge_count] = from;
+  g->edge_to[g->edge_count]   = to;
+  g->edge_kind[g->edge_count] = (unsigned char)kind;
+  g->edge_case[g->edge_count] = cb;
+  g->edge_count++;
+}
+
+
+static void add_action(struct builder *b, int block, struct statement *s)
+{
+  struct cfg *g = b->graph;
+  struct cfg_block *blk = &g->blocks[block];
+
+  if (g->action_count == b->action_capacity) {
+    b->action_capacity = b->action_capacity ? 2 * b->action_capacity : 64;
+    g->action_statement = (struct statement **)
+      realloc(g->action_statement, b->action_capacity * sizeof(struct statement *));
+    g->action_next = (int *)
+      realloc(g->action_next, b->action_capacity * sizeof(int));
+  }
+  g->action_statement[g->action_count] = s;
+  g->action_next[g->action_count] = -1;
+  if (blk->last_action >= 0) g->action_next[blk->last_action] = g->action_count;
+  else {
+    blk->first_action = g->action_count;
+    blk->line   = s->line;
+    blk->module = s->module;
+  }
+  blk->last_action = g->action_count++;
+  blk->action_count++;
+}
+
+
+// Lower a condition so that control leaves block 'from' and reaches
+// 'on_true' or 'on_false'. Each question ends a block of its own.
+//
+static void lower_condition(
+  struct builder *b, struct expression *e, struct statement *owner,
+  int from, int on_true, int on_false)
+{
+  int middle;
+
+  switch (e->op) {
+    case PASSop:
+      lower_condition(b, e->first, owner, from, on_true, on_false);
+      break;
+
+    case NOTop:
+      lower_condition(b, e->first, owner, from, on_false, on_true);
+      break;
+
+    case ANDop:
+      middle = new_block(b, PLAINblock, owner->line, owner->module);
+      lower_condition(b, e->first, owner, from, middle, on_false);
+      lower_condition(b, e->second, owner, middle, on_true, on_false);
+      break;
+
+    case ORop:
+      middle = new_block(b, PLAINblock, owner->line, owner->module);
+      lower_condition(b, e->first, owner, from, on_true, middle);
+      lower_condition(b, e->second, owner, middle, on_true, on_false);
+      break;
+
+    case PROMPTop:
+      if (from < 0) break;
+      b->graph->blocks[from].kind      = TESTblock;
+      b->graph->blocks[from].test      = e;
+      b->graph->blocks[from].statement = owner;
+      new_edge(b, from, on_true, TRUEedge, NULL);
+      new_edge(b, from, on_false, FALSEedge, NULL);
+      break;
+  }
+}
+
+
+static int lower_list(struct builder *b, struct statement_list *list, int current);
+
+static void push_loop(struct builder *b, int continue_block, int break_block)
+{
+  if (b->loop_depth == b->loop_capacity) {
+    b->loop_capacity = b->loop_capacity ? 2 * b->loop_capacity : 16;
+    b->loops = (struct loop_target *)
+      realloc(b->loops, b->loop_capacity * sizeof(struct loop_target));
+  }
+  b->loops[b->loop_depth].continue_block = continue_block;
+  b->loops[b->loop_depth].break_block    = break_block;
+  b->loop_depth++;
+}
+
+
+// Lower one statement. 'current' is the open block control is in (or -1
+// if the statement can not be reached). Returns the open block where
+// control continues afterward.
+//
+static int lower_statement(struct builder *b, struct statement *s, int current)
+{
+  struct cfg *g = b->graph;
+  int then_block, else_block, head, body, after, end;
+  struct case_list *cl;
+  int i;
+
+  // A statement that ends a block needs a block of its own to start in
+  // if the one before it was closed.
+  if (current < 0) current = new_block(b, PLAINblock, s->line, s->module);
+
+  switch (s->type) {
+    case EPtype:
+    case RETURNtype:
+      add_action(b, current, s);
+      return current;
+
+    case BREAKtype:
+      if (b->loop_depth == 0) new_edge(b, current, g->exit, BREAKedge, NULL);
+      else {
+        new_edge(b, current, b->loops[b->loop_depth - 1].break_block,
+                 BREAKedge, NULL);
+      }
+      return -1;
+
+    case CONTINUEtype:
+      if (b->loop_depth == 0) new_edge(b, current, g->exit, CONTINUEedge, NULL);
+      else {
+        new_edge(b, current, b->loops[b->loop_depth - 1].continue_block,
+                 CONTINUEedge, NULL);
+      }
+      return -1;
+
+    case IFtype:
+    case IFELSEtype:
+      then_block = new_block(b, PLAINblock, s->line, s->module);
+      after      = new_block(b, PLAINblock, s->line, s->module);
+      else_block = s->type == IFELSEtype ? new_block(b, PLAINblock, s->line, s->module) : after;
+      lower_condition(b, s->conditional, s, current, then_block, else_block);
+      end = lower_list(b, s->first, then_block);
+      new_edge(b, end, after, ALWAYSedge, NULL);
+      if (s->type == IFELSEtype) {
+        end = lower_list(b, s->second, else_block);
+        new_edge(b, end, after, ALWAYSedge, NULL);
+      }
+      return after;
+
+    case FORtype:
+    case WHILEtype:
+      head  = new_block(b, PLAINblock, s->line, s->module);
+      body  = new_block(b, PLAINblock, s->line, s->module);
+      after = new_block(b, PLAINblock, s->line, s->module);
+      new_edge(b, current, head, ALWAYSedge, NULL);
+      lower_condition(b, s->conditional, s, head, body, after);
+      push_loop(b, head, after);
+      end = lower_list(b, s->first, body);
+      b->loop_depth--;
+      new_edge(b, end, head, ALWAYSedge, NULL);
+      return after;
+
+    case REPEATtype:
+      body  = new_block(b, PLAINblock, s->line, s->module);
+      head  = new_block(b, PLAINblock, s->line, s->module);   // Where UNTIL is tested.
+      after = new_block(b, PLAINblock, s->line, s->module);
+      new_edge(b, current, body, ALWAYSedge, NULL);
+      push_loop(b, head, after);
+      end = lower_list(b, s->first, body);
+      b->loop_depth--;
+      new_edge(b, end, head, ALWAYSedge, NULL);
+      lower_condition(b, s->conditional, s, head, after, body);
+      return after;
+
+    case SWITCHtype:
+      g->blocks[current].kind      = SWITCHblock;
+      g->blocks[current].statement = s;
+      after = new_block(b, PLAINblock, s->line, s->module);
+      for (i = 0; i <= s->case_count; ++i) {
+        struct case_branch *branch = i < s->case_count ? s->cases[i] : s->default_case;
+        if (branch == NULL) break;
+        body = new_block(b, PLAINblock, s->line, s->module);
+        new_edge(b, current, body, CASEedge, branch);
+        end = lower_list(b, branch->first, body);
+        new_edge(b, end, after, ALWAYSedge, NULL);
+      }
+      if (s->default_case == NULL) new_edge(b, current, after, ALWAYSedge, NULL);
+
+      // A second DEFAULT can never be chosen.
+      for (cl = s->cl; cl != NULL; cl = cl->first) {
+        if (cl->second->case_condition != NULL || cl->second == s->default_case) continue;
+        end = lower_list(b, cl->second->first, new_block(b, PLAINblock, s->line, s->module));
+        new_edge(b, end, after, ALWAYSedge, NULL);
+      }
+      return after;
+
+    case PARALLELtype:
+      // The branches follow one another, as the executor runs them. A
+      // BREAK or CONTINUE that leaves a branch goes on to the next.
+      for (i = 0; i < s->case_count; ++i) {
+        after = new_block(b, PLAINblock, s->line, s->module);
+        push_loop(b, after, after);
+        end = lower_list(b, s->cases[i]->first, current);
+        b->loop_depth--;
+        new_edge(b, end, after, ALWAYSedge, NULL);
+        current = after;
+      }
+      return current;
+  }
+  return current;
+}
+
+
+static int lower_list(struct builder *b, struct statement_list *list, int current)
+{
+  int i;
+
+  if (list == NULL) return current;
+  for (i = 0; i < list->count; ++i) {
+    current = lower_statement(b, list->items[i], current);
+  }
+  return current;
+}
+
+
+// Build the compressed adjacency arrays with a counting sort.
+static void index_edges(struct cfg *g)
+{
+  int  n = g->block_count;
+  int *cursor = (int *)malloc((n + 1) * sizeof(int));
+  int  i;
+
+  g->succ_start = (int *)calloc(n + 1, sizeof(int));
+  g->pred_start = (int *)calloc(n + 1, sizeof(int));
+  g->succ = (int *)malloc((g->edge_count + 1) * sizeof(int));
+  g->pred = (int *)malloc((g->edge_count + 1) * sizeof(int));
+
+  for (i = 0; i < g->edge_count; ++i) {
+    g->succ_start[g->edge_from[i] + 1]++;
+    g->pred_start[g->edge_to[i] + 1]++;
+  }
+  for (i = 0; i < n; ++i) {
+    g->succ_start[i + 1] += g->succ_start[i];
+    g->pred_start[i + 1] += g->pred_start[i];
+  }
+
+  memcpy(cursor, g->succ_start, (n + 1) * sizeof(int));
+  for (i = 0; i < g->edge_count; ++i) g->succ[cursor[g->edge_from[i]]++] = i;
+  memcpy(cursor, g->pred_start, (n + 1) * sizeof(int));
+  for (i = 0; i < g->edge_count; ++i) g->pred[cursor[g->edge_to[i]]++] = i;
+  free(cursor);
+}
+
+
+struct cfg *build_cfg(struct statement_list *top, const struct tree_info *info)
+{
+  struct builder b;
+  struct cfg    *g = (struct cfg *)calloc(1, sizeof(struct cfg));
+  int            end;
+
+  // Reserve enough up front that the arrays never have to be copied. A
+  // statement opens at most four blocks, an AND or OR one more, and a
+  // case one more. Only SWITCH blocks have more than two out edges.
+  memset(&b, 0, sizeof(b));
+  b.graph = g;
+  b.block_capacity  = 3 + 4 * info->statement_count + info->expression_count +
+                      info->case_count;
+  b.edge_capacity   = 2 * b.block_capacity + info->case_count;
+  b.action_capacity = info->statement_count + 1;
+  g->blocks = (struct cfg_block *)malloc(b.block_capacity * sizeof(struct cfg_block));
+  g->edge_from = (int *)malloc(b.edge_capacity * sizeof(int));
+  g->edge_to   = (int *)malloc(b.edge_capacity * sizeof(int));
+  g->edge_kind = (unsigned char *)malloc(b.edge_capacity);
+  g->edge_case = (struct case_branch **)
+    malloc(b.edge_capacity * sizeof(struct case_branch *));
+  g->action_statement = (struct statement **)
+    malloc(b.action_capacity * sizeof(struct statement *));
+  g->action_next = (int *)malloc(b.action_capacity * sizeof(int));
+  g->entry = new_block(&b, ENTRYblock, 0, 0);
+  g->exit  = new_block(&b, EXITblock, 0, 0);
+  end = lower_list(&b, top, new_block(&b, PLAINblock, 1, 0));
+  new_edge(&b, g->entry, 2, ALWAYSedge, NULL);
+  new_edge(&b, end, g->exit, ALWAYSedge, NULL);
+  free(b.loops);
+  index_edges(g);
+  return g;
+}
+
+//-----------------------------
+//      Dominators
+//-----------------------------
+
+// The dominator algorithm runs on the graph or on its reverse. A view
+// resolves the direction once so the inner loops need not test it.
+struct view {
+  const int *out_start;   // Successor lists (edge numbers) ...
+  const int *out;
+  const int *out_end;     // ... and the block each edge leads to.
+  const int *in_start;    // Likewise for predecessors.
+  const int *in;
+  const int *in_end;
+};
+
+
+static void make_view(const struct cfg *g, int reverse, struct view *v)
+{
+  v->out_start = reverse ? g->pred_start : g->succ_start;
+  v->out       = reverse ? g->pred : g->succ;
+  v->out_end   = reverse ? g->edge_from : g->edge_to;
+  v->in_start  = reverse ? g->succ_start : g->pred_start;
+  v->in        = reverse ? g->succ : g->pred;
+  v->in_end    = reverse ? g->edge_to : g->edge_from;
+}
+
+struct lt_state {
+  int *semi;       // Semidominator, as a DFS number.
+  int *vertex;     // DFS number -> block.
+  int *parent;     // DFS tree parent.
+  int *ancestor;   // Forest used by eval/link.
+  int *label;
+  int *bucket;     // Head of each block's bucket list.
+  int *next;       // Bucket list links.
+  int *stack;
+};
+
+
+static void compress(struct lt_state *s, int v)
+{
+  int top = 0;
+  int x = v;
+
+  // Collect the path up to the root of v's tree, then shorten it starting
+  // from the end nearest the root (what the recursive version does on
+  // the way back out).
+  while (s->ancestor[s->ancestor[x]] != -1) {
+    s->stack[top++] = x;
+    x = s->ancestor[x];
+  }
+  while (top > 0) {
+    x = s->stack[--top];
+    if (s->semi[s->label[s->ancestor[x]]] < s->semi[s->label[x]]) {
+      s->label[x] = s->label[s->ancestor[x]];
+    }
+    s->ancestor[x] = s->ancestor[s->ancestor[x]];
+  }
+}
+
+
+static int eval(struct lt_state *s, int v)
+{
+  if (s->ancestor[v] == -1) return v;
+  compress(s, v);
+  return s->label[v];
+}
+
+
+static void lengauer_tarjan(const struct view *v, int n, int root, int *idom)
+{
+  struct lt_state s;
+  int *edge_pos;
+  int count = 0, top = 0, i, k, w, x;
+
+  s.semi     = (int *)malloc(n * sizeof(int));
+  s.vertex   = (int *)malloc(n * sizeof(int));
+  s.parent   = (int *)malloc(n * sizeof(int));
+  s.ancestor = (int *)malloc(n * sizeof(int));
+  s.label    = (int *)malloc(n * sizeof(int));
+  s.bucket   = (int *)malloc(n * sizeof(int));
+  s.next     = (int *)malloc(n * sizeof(int));
+  s.stack    = (int *)malloc(n * sizeof(int));
+  edge_pos   = (int *)malloc(n * sizeof(int));
+
+  for (i = 0; i < n; ++i) {
+    s.semi[i]     = -1;
+    s.ancestor[i] = -1;
+    s.label[i]    = i;
+    s.bucket[i]   = -1;
+    idom[i]       = -1;
+  }
+
+  // Depth first numbering with an explicit stack. Each stack entry is a
+  // block; edge_pos remembers how far through its successors we are.
+  s.semi[root] = count;
+  s.vertex[count++] = root;
+  s.parent[root] = -1;
+  s.stack[top++] = root;
+  edge_pos[root] = v->out_start[root];
+  while (top > 0) {
+    int limit;
+    x = s.stack[top - 1];
+    limit = v->out_start[x + 1];
+    if (edge_pos[x] == limit) {
+      --top;
+      continue;
+    }
+    k = edge_pos[x]++;
+    w = v->out_end[v->out[k]];
+    if (s.semi[w] != -1) continue;
+    s.semi[w] = count;
+    s.vertex[count++] = w;
+    s.parent[w] = x;
+    edge_pos[w] = v->out_start[w];
+    s.stack[top++] = w;
+  }
+
+  for (i = count - 1; i > 0; --i) {
+    int p;
+    w = s.vertex[i];
+    p = s.parent[w];
+    for (k = v->in_start[w]; k < v->in_start[w + 1]; ++k) {
+      int u;
+      x = v->in_end[v->in[k]];
+      if (s.semi[x] == -1) continue;     // Not reachable from the root.
+      u = eval(&s, x);
+      if (s.semi[u] < s.semi[w]) s.semi[w] = s.semi[u];
+    }
+    x = s.vertex[s.semi[w]];
+    s.next[w] = s.bucket[x];
+    s.bucket[x] = w;
+    s.ancestor[w] = p;
+
+    for (x = s.bucket[p]; x != -1; x = s.next[x]) {
+      int u = eval(&s, x);
+      idom[x] = s.semi[u] < s.semi[x] ? u : p;
+    }
+    s.bucket[p] = -1;
+  }
+  for (i = 1; i < count; ++i) {
+    w = s.vertex[i];
+    if (idom[w] != s.vertex[s.semi[w]]) idom[w] = idom[idom[w]];
+  }
+
+  free(s.semi);
+  free(s.vertex);
+  free(s.parent);
+  free(s.ancestor);
+  free(s.label);
+  free(s.bucket);
+  free(s.next);
+  free(s.stack);
+  free(edge_pos);
+}
+
+
+// Number the dominator tree so that dominance can be tested in constant
+// time: a dominates b when b's number falls in a's range.
+//
+static void number_dominator_tree(struct cfg *g)
+{
+  int  n = g->block_count;
+  int *child_start = (int *)calloc(n + 2, sizeof(int));
+  int *children    = (int *)malloc((n + 1) * sizeof(int));
+  int *stack       = (int *)malloc((n + 1) * sizeof(int));
+  int *position    = (int *)malloc((n + 1) * sizeof(int));
+  int  counter = 0, top = 0, i;
+
+  g->dom_enter = (int *)malloc(n * sizeof(int));
+  g->dom_leave = (int *)malloc(n * sizeof(int));
+  for (i = 0; i < n; ++i) {
+    g->dom_enter[i] = -1;
+    g->dom_leave[i] = -2;
+    if (g->idom[i] >= 0) child_start[g->idom[i] + 2]++;
+  }
+  for (i = 0; i < n; ++i) child_start[i + 2] += child_start[i + 1];
+  for (i = 0; i < n; ++i) {
+    if (g->idom[i] >= 0) children[child_start[g->idom[i] + 1]++] = i;
+  }
+
+  stack[top++] = g->entry;
+  position[g->entry] = child_start[g->entry];
+  g->dom_enter[g->entry] = counter++;
+  while (top > 0) {
+    int x = stack[top - 1];
+    if (position[x] == child_start[x + 1]) {
+      g->dom_leave[x] = counter - 1;
+      --top;
+      continue;
+    }
+    i = children[position[x]++];
+    g->dom_enter[i] = counter++;
+    position[i] = child_start[i];
+    stack[top++] = i;
+  }
+
+  free(child_start);
+  free(children);
+  free(stack);
+  free(position);
+}
+
+
+int cfg_dominates(const struct cfg *g, int a, int b)
+{
+  if (g->dom_enter[a] < 0 || g->dom_enter[b] < 0) return 0;
+  return g->dom_enter[a] <= g->dom_enter[b] && g->dom_enter[b] <= g->dom_leave[a];
+}
+
+//-----------------------------
+//      Loops
+//-----------------------------
+
+static const struct cfg *sort_graph;
+
+// Loops whose headers come later in the dominator tree's preorder are
+// nested inside (or disjoint from) those before them.
+static int inner_loop_first(const void *left, const void *right)
+{
+  int a = sort_graph->dom_enter[sort_graph->loops[*(const int *)left]];
+  int b = sort_graph->dom_enter[sort_graph->loops[*(const int *)right]];
+
+  return b - a;
+}
+
+
+// The outermost loop found so far that contains loop k.
+static int outermost(int *outer, int k)
+{
+  int root = k, next;
+
+  while (outer[root] != root) root = outer[root];
+  while (outer[k] != root) {
+    next = outer[k];
+    outer[k] = root;
+    k = next;
+  }
+  return root;
+}
+
+
+// Find the natural loops. Loops are collected from the inside out so
+// that an inner loop's body is walked once: when the search for an outer
+// loop reaches it, the whole inner loop is taken over at once and the
+// search continues from the inner loop's header.
+//
+static void find_loops(struct cfg *g)
+{
+  int  n = g->block_count;
+  int *loop_of_header = (int *)malloc(n * sizeof(int));
+  int *work, *order, *outer, *parent, *depth;
+  int  i, k, e;
+
+  g->back_edge   = (unsigned char *)calloc(g->edge_count + 1, 1);
+  g->loop_header = (int *)malloc(n * sizeof(int));
+  g->loop_depth  = (int *)calloc(n, sizeof(int));
+  g->loops       = (int *)malloc((n + 1) * sizeof(int));
+  g->loop_size   = (int *)malloc((n + 1) * sizeof(int));
+  g->loop_count  = 0;
+  for (i = 0; i < n; ++i) {
+    loop_of_header[i] = -1;
+    g->loop_header[i] = -1;
+  }
+
+  for (i = 0; i < g->edge_count; ++i) {
+    int h = g->edge_to[i];
+    if (!cfg_dominates(g, h, g->edge_from[i])) continue;
+    g->back_edge[i] = 1;
+    if (loop_of_header[h] < 0) {
+      loop_of_header[h] = g->loop_count;
+      g->loops[g->loop_count] = h;
+      g->loop_size[g->loop_count] = 0;
+      g->loop_count++;
+    }
+  }
+
+  work   = (int *)malloc((2 * g->edge_count + 1) * sizeof(int));
+  order  = (int *)malloc((g->loop_count + 1) * sizeof(int));
+  outer  = (int *)malloc((g->loop_count + 1) * sizeof(int));
+  parent = (int *)malloc((g->loop_count + 1) * sizeof(int));
+  depth  = (int *)malloc((g->loop_count + 1) * sizeof(int));
+  for (k = 0; k < g->loop_count; ++k) {
+    order[k]  = k;
+    outer[k]  = k;
+    parent[k] = -1;
+  }
+  sort_graph = g;
+  qsort(order, g->loop_count, sizeof(int), inner_loop_first);
+
+  for (i = 0; i < g->loop_count; ++i) {
+    int k = order[i], h = g->loops[k], top = 0, size = 1;
+
+    g->loop_header[h] = k;
+    for (e = g->pred_start[h]; e < g->pred_start[h + 1]; ++e) {
+      if (g->back_edge[g->pred[e]]) work[top++] = g->edge_from[g->pred[e]];
+    }
+    while (top > 0) {
+      int x = work[--top], from;
+
+      if (g->loop_header[x] < 0) {
+        g->loop_header[x] = k;
+        ++size;
+        from = x;
+      }
+      else {
+        int inner = outermost(outer, g->loop_header[x]);
+        if (inner == k) continue;
+        outer[inner]  = k;
+        parent[inner] = k;
+        size += g->loop_size[inner];
+        from = g->loops[inner];
+      }
+      for (e = g->pred_start[from]; e < g->pred_start[from + 1]; ++e) {
+        int u = g->edge_from[g->pred[e]];
+        if (g->dom_enter[u] >= 0) work[top++] = u;
+      }
+    }
+    g->loop_size[k] = size;
+  }
+
+  // Outer loops come last in 'order'.
+  for (i = g->loop_count - 1; i >= 0; --i) {
+    k = order[i];
+    depth[k] = parent[k] < 0 ? 1 : depth[parent[k]] + 1;
+  }
+  for (i = 0; i < n; ++i) {
+    if (g->loop_header[i] >= 0) g->loop_depth[i] = depth[g->loop_header[i]];
+  }
+
+  free(loop_of_header);
+  free(work);
+  free(order);
+  free(outer);
+  free(parent);
+  free(depth);
+}
+
+
+void cfg_analyze(struct cfg *g)
+{
+  struct view forward, backward;
+
+  g->idom  = (int *)malloc(g->block_count * sizeof(int));
+  g->ipdom = (int *)malloc(g->block_count * sizeof(int));
+  make_view(g, 0, &forward);
+  make_view(g, 1, &backward);
+  lengauer_tarjan(&forward, g->block_count, g->entry, g->idom);
+  lengauer_tarjan(&backward, g->block_count, g->exit, g->ipdom);
+  number_dominator_tree(g);
+  find_loops(g);
+}
+
+//-----------------------------
+//      Output
+//-----------------------------
+
+// Write text for a DOT label, escaping as needed and stopping at 'limit'
+// characters.
+static void write_label_text(FILE *out, const char *text, int limit)
+{
+  int n = 0;
+
+  for (; *text && n < limit; ++text, ++n) {
+    switch (*text) {
+      case '"':  fputs("\\\"", out); break;
+      case '\\': fputs("\\\\", out); break;
+      case '\n':
+      case '\r':
+      case '\t': fputc(' ', out); break;
+      default:   fputc(*text, out); break;
+    }
+  }
+  if (*text) fputs("...", out);
+}
+
+
+int cfg_write_dot(const struct cfg *g, FILE *out)
+{
+  int i;
+
+  fprintf(out, "digraph cfg {\n");
+  fprintf(out, "  node [shape=box, fontname=\"Helvetica\", fontsize=10];\n");
+  fprintf(out, "  edge [fontname=\"Helvetica\", fontsize=9];\n");
+  for (i = 0; i < g->block_count; ++i) {
+    const struct cfg_block *b = &g->blocks[i];
+    int a, shown = 0;
+
+    fprintf(out, "  b%d [label=\"", i);
+    if (b->kind == ENTRYblock) fputs("ENTRY", out);
+    if (b->kind == EXITblock) fputs("EXIT", out);
+    for (a = b->first_action; a >= 0 && shown < 4; a = g->action_next[a], ++shown) {
+      struct statement *s = g->action_statement[a];
+      if (s->type == RETURNtype) fputs("RETURN", out);
+      else write_label_text(out, phrase_text(s->phrase), 40);
+      fputs("\\l", out);
+    }
+    if (b->action_count > shown) {
+      fprintf(out, "(%d more)\\l", b->action_count - shown);
+    }
+    if (b->kind == TESTblock) {
+      write_label_text(out, phrase_text(b->test->phrase), 40);
+      fputs(" ?", out);
+    }
+    if (b->kind == SWITCHblock) {
+      fputs("SWITCH ", out);
+      write_label_text(out, phrase_text(b->statement->phrase), 40);
+    }
+    fputs("\"", out);
+    if (b->kind == TESTblock || b->kind == SWITCHblock) fputs(", shape=diamond", out);
+    if (b->kind == ENTRYblock || b->kind == EXITblock) fputs(", shape=oval", out);
+    if (g->loop_header != NULL && g->loop_header[i] >= 0 &&
+        g->loops[g->loop_header[i]] == i) {
+      fputs(", peripheries=2", out);
+    }
+    fputs("];\n", out);
+  }
+  for (i = 0; i < g->edge_count; ++i) {
+    int bold = g->back_edge != NULL && g->back_edge[i];
+
+    fprintf(out, "  b%d -> b%d", g->edge_from[i], g->edge_to[i]);
+    if (g->edge_kind[i] != ALWAYSedge || bold) fputs(" [", out);
+    switch (g->edge_kind[i]) {
+      case TRUEedge:     fputs("label=\"T\"", out); break;
+      case FALSEedge:    fputs("label=\"F\"", out); break;
+      case BREAKedge:    fputs("label=\"BREAK\"", out); break;
+      case CONTINUEedge: fputs("label=\"CONTINUE\"", out); break;
+      case CASEedge:
+        fputs("label=\"", out);
+        if (g->edge_case[i]->phrase < 0) fputs("DEFAULT", out);
+        else write_label_text(out, phrase_text(g->edge_case[i]->phrase), 24);
+        fputs("\"", out);
+        break;
+    }
+    if (bold) fputs(g->edge_kind[i] != ALWAYSedge ? ", style=bold" : "style=bold", out);
+    if (g->edge_kind[i] != ALWAYSedge || bold) fputs("]", out);
+    fputs(";\n", out);
+  }
+  fprintf(out, "}\n");
+  return !ferror(out);
+}
+
+
+// Is block i code that can never run? Empty join blocks left behind after
+// BREAK or CONTINUE are not worth mentioning.
+static int is_dead(const struct cfg *g, int i)
+{
+  return g->idom[i] < 0 && i != g->entry && i != g->exit &&
+    (g->blocks[i].action_count > 0 || g->blocks[i].kind != PLAINblock);
+}
+
+
+// Lines of detail printed per section of the report.
+#define REPORT_LIMIT 20
+
+void cfg_report(const struct cfg *g)
+{
+  int unreachable = 0, shown = 0, i;
+  char where[300];
+
+  for (i = 0; i < g->block_count; ++i) {
+    if (is_dead(g, i)) ++unreachable;
+  }
+  printf("Control flow graph: %d blocks, %d edges, %d actions, %d natural loop%s\n",
+    g->block_count, g->edge_count, g->action_count, g->loop_count,
+    g->loop_count == 1 ? "" : "s");
+  if (unreachable != 0) {
+    printf("  %d block%s can not be reached:\n",
+      unreachable, unreachable == 1 ? "" : "s");
+    for (i = 0; i < g->block_count && shown < REPORT_LIMIT; ++i) {
+      if (is_dead(g, i)) {
+        printf("    %s\n",
+          describe_line(where, sizeof(where), g->blocks[i].module, g->blocks[i].line));
+        ++shown;
+      }
+    }
+    if (unreachable > shown) printf("    ... and %d more\n", unreachable - shown);
+  }
+  for (i = 0; i < g->loop_count && i < REPORT_LIMIT; ++i) {
+    int h = g->loops[i];
+    const struct cfg_block *b = &g->blocks[h];
+    printf("  loop at %s: %d blocks, depth %d, header %s\n",
+      describe_line(where, sizeof(where), b->module, b->line), g->loop_size[i], g->loop_depth[h],
+      b->kind == TESTblock ? phrase_text(b->test->phrase) :
+      b->first_action >= 0 ?
+        phrase_text(g->action_statement[b->first_action]->phrase) : "(empty)");
+  }
+  if (g->loop_count > REPORT_LIMIT) {
+    printf("  ... and %d more loops\n", g->loop_count - REPORT_LIMIT);
+  }
+}
+
+
+void free_cfg(struct cfg *g)
+{
+  free(g->blocks);
+  free(g->action_statement);
+  free(g->action_next);
+  free(g->edge_from);
+  free(g->edge_to);
+  free(g->edge_kind);
+  free(g->edge_case);
+  free(g->succ_start);
+  free(g->succ);
+  free(g->pred_start);
+  free(g->pred);
+  free(g->idom);
+  free(g->ipdom);
+  free(g->loop_header);
+  free(g->loop_depth);
+  free(g->loops);
+  free(g->loop_size);
+  free(g->back_edge);
+  free(g->dom_enter);
+  free(g->dom_leave);
+  free(g);
+}
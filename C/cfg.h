@@ -0,0 +1,108 @@
+/****************************************************************************
+FILE          : cfg.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the control flow graph builder.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The statement tree is lowered into a graph of basic blocks. A block holds
+a run of action statements and ends in at most one decision: a single
+question (conditions are split at AND and OR so that short circuit
+evaluation is explicit in the graph) or a SWITCH. BREAK and CONTINUE
+become edges to the exit or to the continue point of the enclosing loop.
+
+Once built, the graph can be analyzed for dominators, post-dominators
+and natural loops and written out in Graphviz DOT format.
+
+RETURN is treated as the executor treats it (as an action with no
+effect on control flow).
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef CFG_H
+#define CFG_H
+
+#include <stdio.h>
+#include "tree.h"
+
+enum cfg_block_kind { ENTRYblock, EXITblock, PLAINblock, TESTblock, SWITCHblock };
+
+enum cfg_edge_kind {
+  ALWAYSedge, TRUEedge, FALSEedge, CASEedge, BREAKedge, CONTINUEedge
+};
+
+struct cfg_block {
+  enum cfg_block_kind  kind;
+  int                  first_action;   // Index into the action arrays or -1.
+  int                  last_action;
+  int                  action_count;
+  struct expression   *test;           // The question of a TEST block.
+  struct statement    *statement;      // Statement the decision belongs to.
+  int                  line;
+  int                  module;         // File of the line (see module.h).
+};
+
+struct cfg {
+  int                  block_count;
+  struct cfg_block    *blocks;
+  int                  entry;
+  int                  exit;
+
+  // The actions of all blocks. Each block's actions are linked through
+  // action_next in source order.
+  int                  action_count;
+  struct statement   **action_statement;
+  int                 *action_next;
+
+  // Edges in the order they were created.
+  int                  edge_count;
+  int                 *edge_from;
+  int                 *edge_to;
+  unsigned char       *edge_kind;
+  struct case_branch **edge_case;
+
+  // Adjacency in compressed form: the successors of block b are
+  // succ[succ_start[b]] .. succ[succ_start[b+1]-1], likewise for preds.
+  // The entries are edge numbers.
+  int                 *succ_start;
+  int                 *succ;
+  int                 *pred_start;
+  int                 *pred;
+
+  // Filled in by cfg_analyze(). -1 means "none" (for example blocks that
+  // can not be reached from the entry).
+  int                 *idom;           // Immediate dominator.
+  int                 *ipdom;          // Immediate post-dominator.
+  int                 *loop_header;    // Innermost loop containing a block.
+  int                 *loop_depth;     // Number of loops containing it.
+  int                  loop_count;
+  int                 *loops;          // Header block of each loop.
+  int                 *loop_size;      // Blocks in each loop.
+  unsigned char       *back_edge;      // By edge: closes a natural loop.
+  int                 *dom_enter;      // Dominator tree preorder number.
+  int                 *dom_leave;      // Largest preorder number below.
+};
+
+// Lower a prepared tree into a graph. The counts in info size the arrays.
+struct cfg *build_cfg(struct statement_list *top, const struct tree_info *info);
+
+// Compute dominators, post-dominators and natural loops.
+void cfg_analyze(struct cfg *graph);
+
+// Does block a dominate block b? Only valid after cfg_analyze().
+int cfg_dominates(const struct cfg *graph, int a, int b);
+
+// Write the graph in DOT format.
+int cfg_write_dot(const struct cfg *graph, FILE *out);
+
+// Print a summary of the graph and its loops.
+void cfg_report(const struct cfg *graph);
+
+void free_cfg(struct cfg *graph);
+
+#endif
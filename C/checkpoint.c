@@ -0,0 +1,210 @@
+/****************************************************************************
+FILE          : checkpoint.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Execution checkpoints.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+A checkpoint file is text. The first line gives the number of statements
+in the program, the next how many questions had been answered and how
+many frames follow, then there is one line for each frame:
+
+  statement index part trips remaining outcome flip active iterations
+
+The frames are checked against the tree before anything is resumed: each
+statement must be the one at that index of the list its parent frame is
+running, and the last frame must be at a question.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "checkpoint.h"
+#include "module.h"
+
+static const struct tree_info *checkpoint_info;
+static const char             *checkpoint_file;
+static long                    checkpoint_every;
+static long                    questions;        // Asked so far, counting the current one.
+static struct position        *positions;
+static int                     position_capacity;
+
+void checkpoint_start(const struct tree_info *info, const char *file, long every)
+{
+  checkpoint_info  = info;
+  checkpoint_file  = file;
+  checkpoint_every = every;
+}
+
+
+// Writes the current position. Returns zero if the file can't be written.
+static int save_checkpoint(void)
+{
+  char  *temporary;
+  FILE  *out;
+  int    depth, i;
+  const struct position *p;
+
+  depth = execution_position(positions, position_capacity);
+  if (depth > position_capacity) {
+    position_capacity = 2 * depth;
+    positions = (struct position *)realloc(positions, position_capacity * sizeof(struct position));
+    depth = execution_position(positions, position_capacity);
+  }
+
+  temporary = (char *)malloc(strlen(checkpoint_file) + 5);
+  sprintf(temporary, "%s.new", checkpoint_file);
+  out = fopen(temporary, "w");
+  if (out == NULL) {
+    printf("Unable to write %s.\n", temporary);
+    free(temporary);
+    return 0;
+  }
+  fprintf(out, "# checkpoint of %d statements\n", checkpoint_info->statement_count);
+  fprintf(out, "%ld questions answered, %d frames\n", questions - 1, depth);
+  for (i = 0; i < depth; ++i) {
+    p = &positions[i];
+    fprintf(out, "%d %d %d %d %ld %d %d %d %ld\n", p->statement, p->index, p->part,
+      p->trips, p->remaining, p->outcome, p->flip, p->active, p->iterations);
+  }
+  if (fclose(out) != 0 || rename(temporary, checkpoint_file) != 0) {
+    printf("Unable to write %s.\n", checkpoint_file);
+    remove(temporary);
+    free(temporary);
+    return 0;
+  }
+  free(temporary);
+  return 1;
+}
+
+
+void checkpoint_question(void)
+{
+  if (checkpoint_file == NULL) return;
+  ++questions;
+  if (checkpoint_every > 0 && questions % checkpoint_every == 0) save_checkpoint();
+}
+
+
+void checkpoint_command(const char *command)
+{
+  int quit = strncmp(command, "quit", 4) == 0;
+
+  if (!quit && strncmp(command, "save", 4) != 0) {
+    printf("The commands are !save and !quit. Answer again: ");
+    return;
+  }
+  if (checkpoint_file == NULL) {
+    printf("No checkpoint file was given (use -k file). Answer again: ");
+    return;
+  }
+  if (!save_checkpoint()) {
+    printf("Answer again: ");
+    return;
+  }
+  if (quit) {
+    printf("Checkpoint saved in %s. Execution stopped.\n", checkpoint_file);
+    exit(EXIT_SUCCESS);
+  }
+  printf("Checkpoint saved in %s. Answer again: ", checkpoint_file);
+}
+
+
+// Returns the list of a statement that a frame with the given part is
+// running, or NULL if there is no such list.
+static struct statement_list *part_list(const struct statement *s, int part)
+{
+  switch (s->type) {
+    case FORtype:
+    case WHILEtype:
+    case REPEATtype:
+    case IFtype:
+      return part == 0 ? s->first : NULL;
+
+    case IFELSEtype:
+      return part == 0 ? s->first : part == 1 ? s->second : NULL;
+
+    case SWITCHtype:
+    case PARALLELtype:
+      if (part >= 0 && part < s->case_count) return s->cases[part]->first;
+      if (part == s->case_count && s->default_case != NULL) return s->default_case->first;
+      return NULL;
+
+    default:
+      return NULL;
+  }
+}
+
+
+// Checks that the frames describe a position in the tree.
+static int valid_position(
+  const struct tree_info *info, struct statement_list *top, const struct position *frames, int depth)
+{
+  struct statement_list *list = top;
+  struct statement *s;
+  int i;
+
+  if (depth < 1) return 0;
+  for (i = 0; i < depth; ++i) {
+    if (frames[i].statement < 0 || frames[i].statement >= info->statement_count) return 0;
+    s = info->statements[frames[i].statement];
+    if (list == NULL || frames[i].index < 0 || frames[i].index >= list->count) return 0;
+    if (list->items[frames[i].index] != s) return 0;
+    if (frames[i].trips < 0 || frames[i].remaining < 0) return 0;
+    if (i == depth - 1) return frames[i].part == AT_QUESTION;
+    list = part_list(s, frames[i].part);
+  }
+  return 0;
+}
+
+
+int checkpoint_resume(
+  const struct tree_info *info, struct statement_list *top, const char *file)
+{
+  FILE *in;
+  struct position *frames = NULL;
+  struct position *p;
+  const struct statement *s;
+  char  where[300];
+  long  answered;
+  int   count, depth = -1, i = 0;
+
+  in = fopen(file, "r");
+  if (in == NULL) {
+    printf("Unable to open %s.\n", file);
+    return 0;
+  }
+  if (fscanf(in, "# checkpoint of %d statements", &count) == 1 &&
+      count == info->statement_count &&
+      fscanf(in, " %ld questions answered, %d frames", &answered, &depth) == 2 &&
+      depth > 0 && depth <= info->statement_count) {
+    frames = (struct position *)malloc(depth * sizeof(struct position));
+    for (i = 0; i < depth; ++i) {
+      p = &frames[i];
+      if (fscanf(in, "%d %d %d %d %ld %d %d %d %ld", &p->statement, &p->index, &p->part,
+            &p->trips, &p->remaining, &p->outcome, &p->flip, &p->active, &p->iterations) != 9) {
+        break;
+      }
+    }
+  }
+  fclose(in);
+
+  if (frames == NULL || i < depth || !valid_position(info, top, frames, depth)) {
+    printf("%s is not a checkpoint of this program.\n", file);
+    free(frames);
+    return 0;
+  }
+  resume_execution(frames, depth);
+  questions = answered;
+  s = info->statements[frames[depth - 1].statement];
+  printf("Resuming after %ld questions, at %s.\n",
+    answered, describe_line(where, sizeof(where), s->module, s->line));
+  free(frames);
+  return 1;
+}
@@ -0,0 +1,52 @@
+/****************************************************************************
+FILE          : checkpoint.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to execution checkpoints.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+A checkpoint records where an interactive execution is: the frames of the
+executor (see struct position in tree.h) from the top level statement
+down to the one whose question is waiting for an answer, with the trip
+counts and bulk answer state of the loops on the way. Resuming reads the
+frames and the executor goes straight down to that question, so it takes
+the same time however long the run had been going. Nothing is replayed.
+
+The answer memory and the operand order of -a are not saved; they start
+afresh when a run is resumed. A condition with several phrases is asked
+again from its first phrase.
+
+A checkpoint is written when the user answers a question with !save (or
+!quit, which then stops the program) and, if requested, every N
+questions. The file is replaced only once the new one is complete.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "tree.h"
+
+// Save checkpoints of the execution of a prepared tree in the named file,
+// every `every` questions (0 for only when asked).
+void checkpoint_start(const struct tree_info *info, const char *file, long every);
+
+// Reads a checkpoint and arranges for the execution of the tree to resume
+// from it. Returns zero, after printing a message, if the file can't be
+// read or isn't a checkpoint of this program.
+int checkpoint_resume(
+  const struct tree_info *info, struct statement_list *top, const char *file);
+
+// Called by the executor before it reads the answer to each question.
+void checkpoint_question(void);
+
+// Carries out a command typed in place of an answer (the text after the
+// !). The executor then reads the answer again.
+void checkpoint_command(const char *command);
+
+#endif
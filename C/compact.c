@@ -0,0 +1,479 @@
+/****************************************************************************
+FILE          : compact.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Compact (index based) representation of the parse tree.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The compact tree is built from a prepared tree in one pass over the
+statement, expression and case arrays of the tree_info; nothing here
+recurses except the executor (which recurses on nesting depth just like
+the one in tree.c).
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "compact.h"
+#include "intern.h"
+
+// Reserve a list for a statement list and copy in the IDs of its items.
+static ct_index add_list(struct compact_tree *t, struct statement_list *list)
+{
+  ct_index index;
+  int      i;
+
+  if (list == NULL) return CT_NONE;
+  index = t->list_count++;
+  t->lists[index].start = t->item_count;
+  t->lists[index].count = (ct_index)list->count;
+  for (i = 0; i < list->count; ++i) {
+    t->items[t->item_count++] = (ct_index)list->items[i]->id;
+  }
+  return index;
+}
+
+
+static ct_index add_switch(struct compact_tree *t, struct statement *s)
+{
+  struct ct_switch *sw = &t->switches[t->switch_count];
+  struct case_list *cl;
+  ct_index count = 0, i;
+
+  for (cl = s->cl; cl != NULL; cl = cl->first) ++count;
+  sw->phrase     = s->phrase < 0 ? CT_NONE : (ct_index)s->phrase;
+  sw->first_case = t->case_count;
+  sw->case_count = count;
+  t->case_count += count;
+
+  // The case list is built with the last case at its head.
+  for (cl = s->cl, i = count; cl != NULL; cl = cl->first) {
+    struct case_branch *b = cl->second;
+    t->case_items[sw->first_case + --i] = (ct_index)b->id;
+    t->case_phrase[b->id] = b->phrase < 0 ? CT_NONE : (ct_index)b->phrase;
+    t->case_body[b->id]   = add_list(t, b->first);
+  }
+  return t->switch_count++;
+}
+
+
+struct compact_tree *build_compact_tree(
+  struct statement_list *top, const struct tree_info *info)
+{
+  struct compact_tree *t = (struct compact_tree *)calloc(1, sizeof(struct compact_tree));
+  int guarded = 0, choices = 0, switches = 0, lists = 1;
+  int i;
+
+  // Count first so that each table is allocated at exactly its size.
+  for (i = 0; i < info->statement_count; ++i) {
+    struct statement *s = info->statements[i];
+    switch (s->type) {
+      case IFtype:
+      case FORtype:
+      case WHILEtype:
+      case REPEATtype: ++guarded; break;
+      case IFELSEtype: ++choices; break;
+      case SWITCHtype:
+      case PARALLELtype: ++switches; break;
+      default: break;
+    }
+    lists += (s->first != NULL) + (s->second != NULL);
+  }
+  for (i = 0; i < info->case_count; ++i) {
+    lists += info->cases[i]->first != NULL;
+  }
+
+  t->statement_count = info->statement_count;
+  t->type     = (uint8_t *)malloc(info->statement_count + 1);
+  t->line     = (uint32_t *)malloc((info->statement_count + 1) * sizeof(uint32_t));
+  t->detail   = (ct_index *)malloc((info->statement_count + 1) * sizeof(ct_index));
+  t->guarded  = (struct ct_guarded *)malloc((guarded + 1) * sizeof(struct ct_guarded));
+  t->choices  = (struct ct_choice *)malloc((choices + 1) * sizeof(struct ct_choice));
+  t->switches = (struct ct_switch *)malloc((switches + 1) * sizeof(struct ct_switch));
+  t->lists    = (struct ct_list *)malloc(lists * sizeof(struct ct_list));
+  t->items    = (ct_index *)malloc((info->statement_count + 1) * sizeof(ct_index));
+  t->expression_count = info->expression_count;
+  t->op       = (uint8_t *)malloc(info->expression_count + 1);
+  t->left     = (ct_index *)malloc((info->expression_count + 1) * sizeof(ct_index));
+  t->right    = (ct_index *)malloc((info->expression_count + 1) * sizeof(ct_index));
+  t->case_items  = (ct_index *)malloc((info->case_count + 1) * sizeof(ct_index));
+  t->case_phrase = (ct_index *)malloc((info->case_count + 1) * sizeof(ct_index));
+  t->case_body   = (ct_index *)malloc((info->case_count + 1) * sizeof(ct_index));
+
+  // List 0 is the program itself. An empty program still gets one.
+  if (top != NULL) add_list(t, top);
+  else {
+    t->lists[0].start = 0;
+    t->lists[0].count = 0;
+    t->list_count = 1;
+  }
+
+  for (i = 0; i < info->statement_count; ++i) {
+    struct statement  *s = info->statements[i];
+    struct ct_guarded *g;
+    struct ct_choice  *c;
+
+    t->type[i] = (uint8_t)s->type;
+    t->line[i] = (uint32_t)s->line;
+    switch (s->type) {
+      case EPtype:
+        t->detail[i] = (ct_index)s->phrase;
+        break;
+
+      case IFtype:
+      case FORtype:
+      case WHILEtype:
+      case REPEATtype:
+        g = &t->guarded[t->guarded_count];
+        g->condition = (ct_index)s->conditional->id;
+        g->body      = add_list(t, s->first);
+        t->detail[i] = t->guarded_count++;
+        break;
+
+      case IFELSEtype:
+        c = &t->choices[t->choice_count];
+        c->condition = (ct_index)s->conditional->id;
+        c->then_body = add_list(t, s->first);
+        c->else_body = add_list(t, s->second);
+        t->detail[i] = t->choice_count++;
+        break;
+
+      case SWITCHtype:
+      case PARALLELtype:
+        t->detail[i] = add_switch(t, s);
+        break;
+
+      default:
+        t->detail[i] = CT_NONE;
+        break;
+    }
+  }
+
+  for (i = 0; i < info->expression_count; ++i) {
+    struct expression *e = info->expressions[i];
+
+    t->op[i] = (uint8_t)e->op;
+    if (e->op == PROMPTop) t->left[i] = (ct_index)e->phrase;
+    else t->left[i] = e->first != NULL ? (ct_index)e->first->id : CT_NONE;
+    t->right[i] = e->second != NULL ? (ct_index)e->second->id : CT_NONE;
+  }
+  return t;
+}
+
+
+void free_compact_tree(struct compact_tree *t)
+{
+  free(t->type);
+  free(t->line);
+  free(t->detail);
+  free(t->guarded);
+  free(t->choices);
+  free(t->switches);
+  free(t->lists);
+  free(t->items);
+  free(t->op);
+  free(t->left);
+  free(t->right);
+  free(t->case_items);
+  free(t->case_phrase);
+  free(t->case_body);
+  free(t);
+}
+
+//-----------------------------
+//      Footprint report
+//-----------------------------
+
+// Walk each form touching every node the way an analysis pass would, so
+// that the two can be timed against each other. Both return a checksum
+// so the compiler can't skip the work.
+
+static long walk_pointer_expression(const struct expression *e)
+{
+  long sum = 0;
+
+  while (e != NULL) {
+    sum += e->op;
+    if (e->op == PROMPTop) sum += e->phrase;
+    if (e->second != NULL) sum += walk_pointer_expression(e->second);
+    e = e->first;
+  }
+  return sum;
+}
+
+
+static long walk_pointer_list(const struct statement_list *list)
+{
+  long sum = 0;
+  int  i;
+  const struct case_list *cl;
+
+  if (list == NULL) return 0;
+  for (i = 0; i < list->count; ++i) {
+    const struct statement *s = list->items[i];
+    sum += s->type + s->phrase + s->line;
+    sum += walk_pointer_expression(s->conditional);
+    sum += walk_pointer_list(s->first);
+    sum += walk_pointer_list(s->second);
+    for (cl = s->cl; cl != NULL; cl = cl->first) {
+      sum += cl->second->phrase + walk_pointer_list(cl->second->first);
+    }
+  }
+  return sum;
+}
+
+
+static long walk_compact_expression(const struct compact_tree *t, ct_index e)
+{
+  long sum = 0;
+
+  while (e != CT_NONE) {
+    enum operation op = ct_op(t, e);
+    sum += op;
+    if (op == PROMPTop) return sum + ct_prompt_phrase(t, e);
+    if (ct_right(t, e) != CT_NONE) sum += walk_compact_expression(t, ct_right(t, e));
+    e = ct_left(t, e);
+  }
+  return sum;
+}
+
+
+static long walk_compact_list(const struct compact_tree *t, ct_index list)
+{
+  long     sum = 0;
+  ct_index i, k, n = ct_list_count(t, list);
+
+  for (i = 0; i < n; ++i) {
+    ct_index s = ct_list_item(t, list, i);
+    sum += ct_type(t, s) + (int)ct_phrase(t, s) + ct_line(t, s);
+    if (ct_condition(t, s) != CT_NONE) {
+      sum += walk_compact_expression(t, ct_condition(t, s));
+    }
+    sum += walk_compact_list(t, ct_body(t, s));
+    sum += walk_compact_list(t, ct_else(t, s));
+    for (k = 0; k < ct_case_count(t, s); ++k) {
+      ct_index c = ct_case(t, s, k);
+      sum += (int)ct_case_phrase(t, c) + walk_compact_list(t, ct_case_body(t, c));
+    }
+  }
+  return sum;
+}
+
+
+static double seconds_now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+// Best of several walks, in milliseconds.
+#define WALK_TRIALS 5
+
+void compact_report(
+  const struct compact_tree *t, struct statement_list *top, const struct tree_info *info)
+{
+  size_t pointer_bytes, compact_bytes;
+  long   pointer_nodes, check_pointer = 0, check_compact = 0;
+  double pointer_time = 1e9, compact_time = 1e9, start;
+  int    trial;
+
+  // Every statement sits in one statement_list node and one slot of an
+  // items array. Each case has a case_branch, a case_list node and a slot
+  // of the cases array of its SWITCH.
+  pointer_nodes = 2L * info->statement_count + info->expression_count +
+                  2L * info->case_count;
+  pointer_bytes =
+    (size_t)info->statement_count *
+      (sizeof(struct statement) + sizeof(struct statement_list) +
+       sizeof(struct statement *)) +
+    (size_t)info->expression_count * sizeof(struct expression) +
+    (size_t)info->case_count *
+      (sizeof(struct case_branch) + sizeof(struct case_list) + sizeof(struct case_branch *));
+
+  compact_bytes =
+    (size_t)t->statement_count * (sizeof(uint8_t) + sizeof(uint32_t) + sizeof(ct_index)) +
+    (size_t)t->guarded_count * sizeof(struct ct_guarded) +
+    (size_t)t->choice_count * sizeof(struct ct_choice) +
+    (size_t)t->switch_count * sizeof(struct ct_switch) +
+    (size_t)t->list_count * sizeof(struct ct_list) +
+    (size_t)t->item_count * sizeof(ct_index) +
+    (size_t)t->expression_count * (sizeof(uint8_t) + 2 * sizeof(ct_index)) +
+    (size_t)t->case_count * 3 * sizeof(ct_index);
+
+  for (trial = 0; trial < WALK_TRIALS; ++trial) {
+    start = seconds_now();
+    check_pointer = walk_pointer_list(top);
+    start = seconds_now() - start;
+    if (start < pointer_time) pointer_time = start;
+
+    start = seconds_now();
+    check_compact = walk_compact_list(t, 0);
+    start = seconds_now() - start;
+    if (start < compact_time) compact_time = start;
+  }
+
+  printf("Tree footprint (not counting phrase text):\n");
+  printf("  pointer tree: %10lu bytes in %ld separately allocated nodes\n",
+    (unsigned long)pointer_bytes, pointer_nodes);
+  printf("  compact tree: %10lu bytes in 14 arrays (%.0f%% of the pointer tree)\n",
+    (unsigned long)compact_bytes,
+    pointer_bytes ? 100.0 * compact_bytes / pointer_bytes : 0.0);
+  printf("Full traversal (best of %d): pointer %.3f ms, compact %.3f ms%s\n",
+    WALK_TRIALS, 1000 * pointer_time, 1000 * compact_time,
+    check_pointer == check_compact ? "" : " (MISMATCH!)");
+}
+
+//-----------------------------
+//      Executor
+//-----------------------------
+
+// This works exactly like the executor in tree.c except that phrases are
+// shown as they were first written (see intern.h).
+
+static int evaluate_compact(const struct compact_tree *t, ct_index e)
+{
+  int ch;
+
+  switch (ct_op(t, e)) {
+    case PASSop:
+      return evaluate_compact(t, ct_left(t, e));
+
+    case NOTop:
+      return !evaluate_compact(t, ct_left(t, e));
+
+    case ANDop:
+      return evaluate_compact(t, ct_left(t, e)) && evaluate_compact(t, ct_right(t, e));
+
+    case ORop:
+      return evaluate_compact(t, ct_left(t, e)) || evaluate_compact(t, ct_right(t, e));
+
+    case PROMPTop:
+      printf("%s\n", phrase_text(ct_prompt_phrase(t, e)));
+      printf("True or False? ");
+      ch = read_answer();
+      return ch == 'T' || ch == 't';
+  }
+  return 0;
+}
+
+
+static enum abort_type execute_compact_list(const struct compact_tree *t, ct_index list);
+
+static enum abort_type execute_compact_statement(const struct compact_tree *t, ct_index s)
+{
+  enum abort_type result = NORMAL;
+  ct_index i, c, chosen;
+  int number, choice;
+
+  switch (ct_type(t, s)) {
+    case BREAKtype:
+      result = fromBREAK;
+      break;
+
+    case CONTINUEtype:
+      result = fromCONTINUE;
+      break;
+
+    case EPtype:
+      printf("%s\n", phrase_text(ct_phrase(t, s)));
+      read_answer();
+      break;
+
+    case FORtype:
+    case WHILEtype:
+      while (evaluate_compact(t, ct_condition(t, s))) {
+        result = execute_compact_list(t, ct_body(t, s));
+        if (result == fromBREAK) break;
+      }
+      result = NORMAL;
+      break;
+
+    case IFtype:
+      if (evaluate_compact(t, ct_condition(t, s))) {
+        result = execute_compact_list(t, ct_body(t, s));
+      }
+      break;
+
+    case IFELSEtype:
+      if (evaluate_compact(t, ct_condition(t, s))) {
+        result = execute_compact_list(t, ct_body(t, s));
+      }
+      else {
+        result = execute_compact_list(t, ct_else(t, s));
+      }
+      break;
+
+    case REPEATtype:
+      do {
+        result = execute_compact_list(t, ct_body(t, s));
+        if (result == fromBREAK) break;
+      } while (!evaluate_compact(t, ct_condition(t, s)));
+      result = NORMAL;
+      break;
+
+    case RETURNtype:
+      printf("\nRETURN not implemented!\n");
+      break;
+
+    case SWITCHtype:
+      // One menu of the CASE branches, as in execute_switch().
+      printf("Which of the following is %s?\n", phrase_text(ct_phrase(t, s)));
+      for (i = 0, number = 0; i < ct_case_count(t, s); ++i) {
+        c = ct_case(t, s, i);
+        if (ct_case_phrase(t, c) != CT_NONE) {
+          printf("  %d. %s\n", ++number, phrase_text(ct_case_phrase(t, c)));
+        }
+      }
+      if (number > 0) printf("Which one (0 for none)? ");
+      choice = number > 0 ? read_choice() : 0;
+      while (choice > number) {
+        printf("There are only %d. Which one (0 for none)? ", number);
+        choice = read_choice();
+      }
+
+      // The chosen case, or else the first DEFAULT.
+      for (i = 0, chosen = CT_NONE; i < ct_case_count(t, s) && chosen == CT_NONE; ++i) {
+        c = ct_case(t, s, i);
+        if (ct_case_phrase(t, c) != CT_NONE ? choice > 0 && --choice == 0 : choice == 0) {
+          chosen = c;
+        }
+      }
+      if (chosen != CT_NONE) result = execute_compact_list(t, ct_case_body(t, chosen));
+      break;
+
+    case PARALLELtype:
+      // The branches one after another, as in execute_parallel().
+      for (i = 0; i < ct_case_count(t, s); ++i) {
+        execute_compact_list(t, ct_case_body(t, ct_case(t, s, i)));
+      }
+      break;
+  }
+  return result;
+}
+
+
+static enum abort_type execute_compact_list(const struct compact_tree *t, ct_index list)
+{
+  enum abort_type result = NORMAL;
+  ct_index i, n = ct_list_count(t, list);
+
+  for (i = 0; i < n && result == NORMAL; ++i) {
+    result = execute_compact_statement(t, ct_list_item(t, list, i));
+  }
+  return result;
+}
+
+
+enum abort_type execute_compact(const struct compact_tree *t)
+{
+  return execute_compact_list(t, 0);
+}
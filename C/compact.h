@@ -0,0 +1,226 @@
+/****************************************************************************
+FILE          : compact.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the compact (index based) tree.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The parse tree built by the parser gives every statement the same six
+fields (most of them NULL for simple statements) and links everything
+with pointers. The compact tree holds the same program in dense arrays
+with one array per kind of node, and the nodes refer to each other with
+32 bit indices. Each statement has only a type, a line number and one
+index into the table for its variant, and each variant table holds
+exactly the fields that variant needs.
+
+Statements, expressions and cases keep the IDs prepare_tree() assigned,
+so information gathered with either form can be used with the other. A
+statement list is an index into the list table; its statements are a
+contiguous run of the item array.
+
+Code outside of compact.c should use the accessor functions below rather
+than the arrays. Phrases are held as phrase IDs (see intern.h).
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include <stdint.h>
+#include "tree.h"
+
+typedef uint32_t ct_index;
+
+// Used for missing children (an empty ELSE, the phrase of DEFAULT, etc).
+#define CT_NONE ((ct_index)0xFFFFFFFFu)
+
+// IF, WHILE, FOR and REPEAT.
+struct ct_guarded {
+  ct_index condition;
+  ct_index body;
+};
+
+// IF/ELSE.
+struct ct_choice {
+  ct_index condition;
+  ct_index then_body;
+  ct_index else_body;
+};
+
+// SWITCH. The IDs of the cases, in source order, are a run of case_items.
+struct ct_switch {
+  ct_index phrase;
+  ct_index first_case;   // Index into case_items.
+  ct_index case_count;
+};
+
+struct ct_list {
+  ct_index start;     // Index into items.
+  ct_index count;
+};
+
+struct compact_tree {
+  // Statements, indexed by statement ID. For actions detail is the phrase
+  // ID; for the other types it indexes the table for the type.
+  ct_index           statement_count;
+  uint8_t           *type;
+  uint32_t          *line;
+  ct_index          *detail;
+
+  ct_index           guarded_count;
+  struct ct_guarded *guarded;
+  ct_index           choice_count;
+  struct ct_choice  *choices;
+  ct_index           switch_count;
+  struct ct_switch  *switches;
+
+  // Statement lists. List 0 is the whole program.
+  ct_index           list_count;
+  struct ct_list    *lists;
+  ct_index           item_count;
+  ct_index          *items;
+
+  // Expressions, indexed by expression ID. For PROMPTop 'left' is the
+  // phrase ID.
+  ct_index           expression_count;
+  uint8_t           *op;
+  ct_index          *left;
+  ct_index          *right;
+
+  // Cases, indexed by case ID.
+  ct_index           case_count;
+  ct_index          *case_items;
+  ct_index          *case_phrase;
+  ct_index          *case_body;
+};
+
+// Build the compact form of a prepared tree.
+struct compact_tree *build_compact_tree(
+  struct statement_list *top, const struct tree_info *info);
+
+void free_compact_tree(struct compact_tree *tree);
+
+// Print the memory used by each form and the time taken to walk each.
+void compact_report(
+  const struct compact_tree *tree, struct statement_list *top, const struct tree_info *info);
+
+// Execute the program (interactively, like execute_statement_list()).
+enum abort_type execute_compact(const struct compact_tree *tree);
+
+// ------------------
+// Accessor functions
+// ------------------
+
+static inline enum statement_type ct_type(const struct compact_tree *t, ct_index s)
+{
+  return (enum statement_type)t->type[s];
+}
+
+static inline int ct_line(const struct compact_tree *t, ct_index s)
+{
+  return (int)t->line[s];
+}
+
+// Phrase ID of an action or SWITCH statement, CT_NONE for other types.
+static inline ct_index ct_phrase(const struct compact_tree *t, ct_index s)
+{
+  switch (t->type[s]) {
+    case EPtype:     return t->detail[s];
+    case SWITCHtype: return t->switches[t->detail[s]].phrase;
+    default:         return CT_NONE;
+  }
+}
+
+static inline ct_index ct_condition(const struct compact_tree *t, ct_index s)
+{
+  switch (t->type[s]) {
+    case IFtype:
+    case FORtype:
+    case WHILEtype:
+    case REPEATtype: return t->guarded[t->detail[s]].condition;
+    case IFELSEtype: return t->choices[t->detail[s]].condition;
+    default:         return CT_NONE;
+  }
+}
+
+// The loop body or the THEN part.
+static inline ct_index ct_body(const struct compact_tree *t, ct_index s)
+{
+  switch (t->type[s]) {
+    case IFtype:
+    case FORtype:
+    case WHILEtype:
+    case REPEATtype: return t->guarded[t->detail[s]].body;
+    case IFELSEtype: return t->choices[t->detail[s]].then_body;
+    default:         return CT_NONE;
+  }
+}
+
+static inline ct_index ct_else(const struct compact_tree *t, ct_index s)
+{
+  return t->type[s] == IFELSEtype ? t->choices[t->detail[s]].else_body : CT_NONE;
+}
+
+static inline ct_index ct_case_count(const struct compact_tree *t, ct_index s)
+{
+  switch (t->type[s]) {
+    case SWITCHtype:
+    case PARALLELtype: return t->switches[t->detail[s]].case_count;
+    default:           return 0;
+  }
+}
+
+// The ID of the i-th case of a SWITCH (or branch of a PARALLEL) in
+// source order.
+static inline ct_index ct_case(const struct compact_tree *t, ct_index s, ct_index i)
+{
+  return t->case_items[t->switches[t->detail[s]].first_case + i];
+}
+
+static inline ct_index ct_case_phrase(const struct compact_tree *t, ct_index c)
+{
+  return t->case_phrase[c];
+}
+
+static inline ct_index ct_case_body(const struct compact_tree *t, ct_index c)
+{
+  return t->case_body[c];
+}
+
+static inline ct_index ct_list_count(const struct compact_tree *t, ct_index list)
+{
+  return list == CT_NONE ? 0 : t->lists[list].count;
+}
+
+static inline ct_index ct_list_item(const struct compact_tree *t, ct_index list, ct_index i)
+{
+  return t->items[t->lists[list].start + i];
+}
+
+static inline enum operation ct_op(const struct compact_tree *t, ct_index e)
+{
+  return (enum operation)t->op[e];
+}
+
+static inline ct_index ct_left(const struct compact_tree *t, ct_index e)
+{
+  return t->left[e];
+}
+
+static inline ct_index ct_right(const struct compact_tree *t, ct_index e)
+{
+  return t->right[e];
+}
+
+// Phrase ID of a PROMPTop expression.
+static inline ct_index ct_prompt_phrase(const struct compact_tree *t, ct_index e)
+{
+  return t->left[e];
+}
+
+#endif
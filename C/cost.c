@@ -0,0 +1,467 @@
+/****************************************************************************
+FILE          : cost.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Static cost analysis of a p-code program.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+One walk over the tree works out the cost of each statement from the
+costs of the statements in it, and at the same time the number of times
+each statement is expected to run, from the chances of the decisions
+above it. Decisions are taken to be independent of each other.
+
+  + A list costs the sum of its statements, up to the first BREAK,
+    CONTINUE or RETURN in it (the rest can't run). A BREAK inside an IF
+    shortens a loop; that is what the loop's BOUND is for.
+  + An IF or SWITCH costs its cheapest branch at best, its dearest at
+    worst, and the branches weighted by their chances on average.
+  + A loop costs its body times its trips, each of best, expected and
+    worst. The expected trips follow from the chance the loop goes on
+    each time (cut off at the BOUND or the loop cap), unless the BOUND
+    gives them.
+  + A PARALLEL's work is the sum of its branches and its span is that of
+    its longest branch. The expected span is the longest expected branch,
+    which can be less than the expected longest branch.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cost.h"
+#include "intern.h"
+#include "module.h"
+#include "sim.h"
+
+struct cost {
+  double best;
+  double expected;
+  double worst;      // INFINITY if there is no bound.
+};
+
+struct analysis {
+  const struct tree_info *info;
+  double                  default_probability;
+  double                 *probability;   // By phrase ID; negative if not given.
+  long                    loop_cap;
+  struct cost            *work;          // Of one execution, by statement ID.
+  struct cost            *span;          // Likewise.
+  double                 *runs;          // Expected executions per run, by statement ID.
+  int                     actions;
+  int                     costed;        // Actions with a COST.
+  int                     parallel;      // Is there a PARALLEL?
+};
+
+static const struct cost zero_cost = { 0.0, 0.0, 0.0 };
+
+//-----------------------------
+//      Chances
+//-----------------------------
+
+static double phrase_chance(const struct analysis *a, int phrase)
+{
+  if (phrase >= 0 && a->probability[phrase] >= 0.0) return a->probability[phrase];
+  return a->default_probability;
+}
+
+
+// The chance a condition is true.
+static double chance(const struct analysis *a, const struct expression *e)
+{
+  double left, right;
+
+  switch (e->op) {
+    case PASSop:
+      return chance(a, e->first);
+
+    case NOTop:
+      return 1.0 - chance(a, e->first);
+
+    case ANDop:
+    case ORop:
+      left  = chance(a, e->first);
+      right = chance(a, e->second);
+      return e->op == ANDop ? left * right : 1.0 - (1.0 - left) * (1.0 - right);
+
+    case PROMPTop:
+      return phrase_chance(a, e->phrase);
+  }
+  return 0.0;
+}
+
+
+// x to the power n.
+static double power(double x, unsigned long long n)
+{
+  double result = 1.0;
+
+  for (; n > 0; n /= 2) {
+    if (n % 2 != 0) result *= x;
+    x *= x;
+  }
+  return result;
+}
+
+
+// The expected trips of a loop that goes on with chance p (a WHILE or FOR
+// tests before each trip, a REPEAT after), if it is stopped after 'most'.
+static double expected_trips(const struct statement *s, double p, double most)
+{
+  unsigned long long limit = (unsigned long long)most;
+  double first = s->type == REPEATtype ? 1.0 : p;   // Chance of a first trip.
+  double go_on = s->type == REPEATtype ? 1.0 - p : p;
+
+  if (limit == 0) return 0.0;
+  if (go_on >= 1.0) return first * limit;
+  return first * (1.0 - power(go_on, limit)) / (1.0 - go_on);
+}
+
+
+static struct cost loop_trips(const struct analysis *a, const struct statement *s)
+{
+  struct estimate bound;
+  struct cost     trips;
+  double least = s->type == REPEATtype ? 1.0 : 0.0;
+  double p = chance(a, s->conditional);
+
+  if (s->estimate == NULL) {
+    trips.best     = least;
+    trips.expected = expected_trips(s, p, (double)a->loop_cap);
+    trips.worst    = INFINITY;
+    return trips;
+  }
+  read_estimate(s->estimate, &bound);
+  trips.worst = bound.high;
+  trips.best  = bound.count > 1 ? bound.low : least < bound.high ? least : bound.high;
+  if (bound.count == 3) {
+    trips.expected = bound.expected;
+  }
+  else {
+    trips.expected = expected_trips(s, p, bound.high);
+    if (trips.expected < trips.best) trips.expected = trips.best;
+  }
+  return trips;
+}
+
+//-----------------------------
+//      Combining costs
+//-----------------------------
+
+static void add(struct cost *total, const struct cost *more)
+{
+  total->best     += more->best;
+  total->expected += more->expected;
+  total->worst    += more->worst;
+}
+
+
+// Takes in a branch taken with the given chance. The first branch is
+// taken in with a fresh total.
+static void take_branch(struct cost *total, const struct cost *branch, double p, int first)
+{
+  if (first || branch->best < total->best) total->best = branch->best;
+  if (first || branch->worst > total->worst) total->worst = branch->worst;
+  total->expected = (first ? 0.0 : total->expected) + p * branch->expected;
+}
+
+
+static void take_longest(struct cost *longest, const struct cost *branch)
+{
+  if (branch->best > longest->best) longest->best = branch->best;
+  if (branch->expected > longest->expected) longest->expected = branch->expected;
+  if (branch->worst > longest->worst) longest->worst = branch->worst;
+}
+
+
+// Nothing times anything (even no bound) is nothing.
+static double times(double n, double cost)
+{
+  return n == 0.0 || cost == 0.0 ? 0.0 : n * cost;
+}
+
+
+static struct cost repeated(const struct cost *trips, const struct cost *body)
+{
+  struct cost total;
+
+  total.best     = times(trips->best, body->best);
+  total.expected = times(trips->expected, body->expected);
+  total.worst    = times(trips->worst, body->worst);
+  return total;
+}
+
+//-----------------------------
+//      The walk
+//-----------------------------
+
+static void analyze_list(
+  struct analysis *a, struct statement_list *list, double runs,
+  struct cost *work, struct cost *span);
+
+static void analyze_statement(struct analysis *a, struct statement *s, double runs)
+{
+  struct cost work = zero_cost, span = zero_cost;
+  struct cost branch_work, branch_span, trips;
+  struct estimate estimate;
+  double p, left = 1.0;
+  int i;
+
+  a->runs[s->id] = runs;
+  switch (s->type) {
+    case EPtype:
+      ++a->actions;
+      if (s->estimate != NULL && read_estimate(s->estimate, &estimate)) {
+        ++a->costed;
+        work.best     = estimate.low;
+        work.expected = estimate.expected;
+        work.worst    = estimate.high;
+      }
+      else {
+        work.best = work.expected = work.worst = 1.0;
+      }
+      span = work;
+      break;
+
+    case BREAKtype:
+    case CONTINUEtype:
+    case RETURNtype:
+      break;
+
+    case IFtype:
+    case IFELSEtype:
+      p = chance(a, s->conditional);
+      analyze_list(a, s->first, runs * p, &branch_work, &branch_span);
+      take_branch(&work, &branch_work, p, 1);
+      take_branch(&span, &branch_span, p, 1);
+      branch_work = branch_span = zero_cost;
+      if (s->type == IFELSEtype) {
+        analyze_list(a, s->second, runs * (1.0 - p), &branch_work, &branch_span);
+      }
+      take_branch(&work, &branch_work, 1.0 - p, 0);
+      take_branch(&span, &branch_span, 1.0 - p, 0);
+      break;
+
+    case SWITCHtype:
+      // The first case that is accepted runs, or the DEFAULT if none is.
+      for (i = 0; i < s->case_count; ++i) {
+        p = left * phrase_chance(a, s->cases[i]->phrase);
+        left -= p;
+        analyze_list(a, s->cases[i]->first, runs * p, &branch_work, &branch_span);
+        take_branch(&work, &branch_work, p, i == 0);
+        take_branch(&span, &branch_span, p, i == 0);
+      }
+      branch_work = branch_span = zero_cost;
+      if (s->default_case != NULL) {
+        analyze_list(a, s->default_case->first, runs * left, &branch_work, &branch_span);
+      }
+      take_branch(&work, &branch_work, left, s->case_count == 0);
+      take_branch(&span, &branch_span, left, s->case_count == 0);
+      break;
+
+    case FORtype:
+    case WHILEtype:
+    case REPEATtype:
+      trips = loop_trips(a, s);
+      analyze_list(a, s->first, runs * trips.expected, &branch_work, &branch_span);
+      work = repeated(&trips, &branch_work);
+      span = repeated(&trips, &branch_span);
+      break;
+
+    case PARALLELtype:
+      a->parallel = 1;
+      for (i = 0; i < s->case_count; ++i) {
+        analyze_list(a, s->cases[i]->first, runs, &branch_work, &branch_span);
+        add(&work, &branch_work);
+        take_longest(&span, &branch_span);
+      }
+      break;
+  }
+  a->work[s->id] = work;
+  a->span[s->id] = span;
+}
+
+
+static void analyze_list(
+  struct analysis *a, struct statement_list *list, double runs,
+  struct cost *work, struct cost *span)
+{
+  struct statement *s;
+  int i;
+
+  *work = *span = zero_cost;
+  for (i = 0; i < list->count; ++i) {
+    s = list->items[i];
+    analyze_statement(a, s, runs);
+    add(work, &a->work[s->id]);
+    add(span, &a->span[s->id]);
+    if (s->type == BREAKtype || s->type == CONTINUEtype || s->type == RETURNtype) break;
+  }
+}
+
+//-----------------------------
+//      Reporting
+//-----------------------------
+
+static const char *amount(char *buffer, double value)
+{
+  if (isinf(value)) return "unbounded";
+  sprintf(buffer, "%.6g", value);
+  return buffer;
+}
+
+
+static void print_cost(const char *name, const struct cost *c)
+{
+  char best[32], expected[32], worst[32];
+
+  printf("  %-4s  %12s  %12s  %12s\n", name,
+    amount(best, c->best), amount(expected, c->expected), amount(worst, c->worst));
+}
+
+
+// Find a phrase that identifies a statement in the report.
+static const char *describe(struct statement *s)
+{
+  struct expression *e = s->conditional;
+
+  if (s->phrase >= 0) return phrase_text(s->phrase);
+  while (e != NULL && e->op != PROMPTop) e = e->first;
+  if (e != NULL) return phrase_text(e->phrase);
+  return "";
+}
+
+
+// Orders statements by expected work per run, most first, then by ID.
+static const struct analysis *sorting;
+
+static int compare_statements(const void *left, const void *right)
+{
+  int a = *(const int *)left, b = *(const int *)right;
+  double x = sorting->runs[a] * sorting->work[a].expected;
+  double y = sorting->runs[b] * sorting->work[b].expected;
+
+  if (x != y) return x < y ? 1 : -1;
+  return a - b;
+}
+
+
+static void print_report(
+  const struct analysis *a, const struct cost *work, const struct cost *span, int regions)
+{
+  const struct tree_info *info = a->info;
+  char   best[32], expected[32], worst[32], where[300];
+  int   *order;
+  int    i, count = 0, unbounded = 0, width = 5, n;
+
+  printf("Costs of the program (%d of %d actions have a COST; the others cost 1)\n\n",
+    a->costed, a->actions);
+  printf("        %12s  %12s  %12s\n", "best", "expected", "worst");
+  print_cost("work", work);
+  if (a->parallel) {
+    print_cost("span", span);
+    if (span->expected > 0.0) {
+      printf("Expected work over expected span: %.2f\n", work->expected / span->expected);
+    }
+  }
+
+  // Every statement that does something, dearest first.
+  order = (int *)malloc((info->statement_count + 1) * sizeof(int));
+  for (i = 0; i < info->statement_count; ++i) {
+    enum statement_type type = info->statements[i]->type;
+    if (type == BREAKtype || type == CONTINUEtype || type == RETURNtype) continue;
+    order[count++] = i;
+  }
+  sorting = a;
+  qsort(order, count, sizeof(int), compare_statements);
+  if (regions > 0 && regions < count) count = regions;
+
+  // The line column is as wide as the longest label (imported lines name their file).
+  for (i = 0; i < count; ++i) {
+    struct statement *s = info->statements[order[i]];
+    n = (int)strlen(line_label(where, sizeof(where), s->module, s->line));
+    if (n > width) width = n;
+  }
+
+  printf("\nThe most expensive statements, by expected work per run (costs are for one\n"
+         "execution; a compound statement includes what is inside it):\n\n");
+  printf("%*s  statement   per run          best      expected         worst   share\n",
+    width, "line");
+  for (i = 0; i < count; ++i) {
+    struct statement  *s = info->statements[order[i]];
+    const struct cost *c = &a->work[s->id];
+    double share = work->expected > 0.0 ?
+      100.0 * a->runs[s->id] * c->expected / work->expected : 0.0;
+
+    printf("%*s  %-9s %9.3f  %12s  %12s  %12s  %5.1f%%  %.40s\n",
+      width, line_label(where, sizeof(where), s->module, s->line),
+      statement_type_name(s->type), a->runs[s->id], amount(best, c->best),
+      amount(expected, c->expected), amount(worst, c->worst), share, describe(s));
+  }
+  free(order);
+
+  for (i = 0; i < info->statement_count; ++i) {
+    struct statement *s = info->statements[i];
+    if (s->type != FORtype && s->type != WHILEtype && s->type != REPEATtype) continue;
+    if (s->estimate != NULL) continue;
+    if (unbounded++ == 0) printf("\nLoops without a BOUND (no worst case) on line");
+    printf(" %s", line_label(where, sizeof(where), s->module, s->line));
+  }
+  if (unbounded > 0) printf(".\n");
+}
+
+//-----------------------------
+//      External Functions
+//-----------------------------
+
+void cost_default_options(struct cost_options *options)
+{
+  options->regions             = 10;
+  options->loop_cap            = 1000;
+  options->default_probability = 0.5;
+  options->probability_file    = NULL;
+}
+
+
+int analyze_costs(
+  struct statement_list     *top,
+  const struct tree_info    *info,
+  const struct cost_options *options)
+{
+  struct analysis a;
+  struct cost     work, span;
+  int count = phrase_count();
+  int i;
+
+  if (top == NULL) return 0;
+  a.info                = info;
+  a.default_probability = options->default_probability;
+  a.loop_cap            = options->loop_cap;
+  a.probability = (double *)malloc((count + 1) * sizeof(double));
+  for (i = 0; i < count; ++i) a.probability[i] = -1.0;
+  if (options->probability_file != NULL &&
+      !load_probabilities(options->probability_file, a.probability)) {
+    free(a.probability);
+    return 0;
+  }
+  a.work     = (struct cost *)calloc(info->statement_count + 1, sizeof(struct cost));
+  a.span     = (struct cost *)calloc(info->statement_count + 1, sizeof(struct cost));
+  a.runs     = (double *)calloc(info->statement_count + 1, sizeof(double));
+  a.actions  = 0;
+  a.costed   = 0;
+  a.parallel = 0;
+
+  analyze_list(&a, top, 1.0, &work, &span);
+  print_report(&a, &work, &span, options->regions);
+
+  free(a.probability);
+  free(a.work);
+  free(a.span);
+  free(a.runs);
+  return 1;
+}
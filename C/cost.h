@@ -0,0 +1,50 @@
+/****************************************************************************
+FILE          : cost.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the static cost analysis.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+An action costs what its COST says (one if it has none) and a loop goes
+around at most as many times as its BOUND says. From these the analysis
+works out the best, expected and worst cost of one execution of every
+statement and of the whole program, without running it. Work is the cost
+of everything done. Span is the cost of the longest chain of steps when
+the branches of each PARALLEL run at the same time.
+
+Expected values use the probabilities the simulator uses (see sim.h):
+each condition phrase is true, and each CASE is accepted when offered,
+with the chance given in the probability file or the default chance. A
+loop without a BOUND has no worst case; its expected trips are cut off
+at the loop cap, as in the simulator.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef COST_H
+#define COST_H
+
+#include "tree.h"
+
+struct cost_options {
+  int         regions;              // Statements to list (0 for all of them).
+  long        loop_cap;             // Expected trips of a loop without a BOUND stop here.
+  double      default_probability;  // For phrases not in the file.
+  const char *probability_file;     // NULL if there is none.
+};
+
+// Fill in default options.
+void cost_default_options(struct cost_options *options);
+
+// Analyze the program and print the report to stdout. Returns zero on
+// failure. The tree must have been through prepare_tree().
+int analyze_costs(
+  struct statement_list     *top,
+  const struct tree_info    *info,
+  const struct cost_options *options);
+
+#endif
@@ -0,0 +1,798 @@
+/****************************************************************************
+FILE          : cover.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Branch coverage recording and answer script generation.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Every branch outcome in the program is given a number. The outcomes of a
+statement are numbered consecutively; the outcomes of a SWITCH are its
+cases in source order.
+
+Script generation is a greedy set cover. The family of sets is the set of
+bounded walks through the program (each loop runs at most a few times
+per entry and each walk has a limited number of answers). Since that
+family is far too large to enumerate, each round of the greedy algorithm
+samples it: a number of walks are generated in parallel, each one biased
+toward outcomes that are not yet covered, and the walk that covers the
+most new outcomes is kept. Rounds continue until a round finds nothing
+new. Finally any script whose outcomes are all covered by other scripts
+is dropped.
+
+Walks are steered using the number of uncovered outcomes inside each
+branch. Statement IDs are given out in preorder so the statements of a
+subtree have consecutive IDs. A prefix sum over the uncovered outcomes
+owned by each statement gives the count for any subtree or statement
+list in constant time.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "cover.h"
+#include "intern.h"
+#include "module.h"
+#include "rng.h"
+
+// The outcome numbering of a prepared tree.
+struct outcome_map {
+  const struct tree_info *info;
+  int                     count;
+  int                    *statement_base;  // By statement ID; -1 if none.
+  int                    *case_outcome;    // By case ID.
+  int                    *owner;           // By outcome: statement ID.
+  struct case_branch    **outcome_case;    // By outcome: case or NULL.
+  int                    *subtree_end;     // By statement ID.
+};
+
+// Shared, read only state for one round of the search.
+struct plan {
+  const struct outcome_map   *map;
+  struct statement_list      *top;
+  const struct cover_options *options;
+  const unsigned char        *covered;     // By outcome.
+  int                        *pending;     // Prefix sums by statement ID.
+};
+
+// One walk through the program.
+struct walk {
+  vtc_string  script;
+  int        *reached;      // Distinct outcomes reached.
+  int         reached_count;
+  int         reached_capacity;
+  int         new_count;    // How many of those were not yet covered.
+  long        answers;
+};
+
+// One search thread.
+struct walker {
+  pthread_t          thread;
+  const struct plan *plan;
+  struct rng         random;
+  int               *stamp;          // By outcome: serial of last walk.
+  int                serial;
+  int                winding_down;   // Out of answers; head for the exit.
+  struct walk        current;
+  struct walk        best;
+};
+
+static struct outcome_map  recording_map;
+static unsigned char      *recorded = NULL;
+static const char         *recording_file = NULL;
+
+//-----------------------------
+//      Outcome numbering
+//-----------------------------
+
+static int measure(struct statement *s, int *subtree_end);
+
+static int measure_list(struct statement_list *list, int end, int *subtree_end)
+{
+  int i;
+
+  if (list == NULL) return end;
+  for (i = 0; i < list->count; ++i) end = measure(list->items[i], subtree_end);
+  return end;
+}
+
+
+static int measure(struct statement *s, int *subtree_end)
+{
+  int end = s->id + 1;
+  struct case_list *cl;
+
+  end = measure_list(s->first, end, subtree_end);
+  end = measure_list(s->second, end, subtree_end);
+  for (cl = s->cl; cl != NULL; cl = cl->first) {
+    end = measure_list(cl->second->first, end, subtree_end);
+  }
+  subtree_end[s->id] = end;
+  return end;
+}
+
+
+// Returns the cases of a SWITCH in source order. The caller frees it.
+static struct case_branch **source_order(struct case_list *cl, int *count)
+{
+  struct case_branch **cases;
+  struct case_list    *p;
+  int n = 0;
+
+  for (p = cl; p != NULL; p = p->first) ++n;
+  cases = (struct case_branch **)malloc((n + 1) * sizeof(struct case_branch *));
+  *count = n;
+  for (p = cl; p != NULL; p = p->first) cases[--n] = p->second;
+  return cases;
+}
+
+
+static void add_outcome(struct outcome_map *map, int owner, struct case_branch *b)
+{
+  if ((map->count & (map->count - 1)) == 0) {
+    int size = map->count ? 2 * map->count : 1;
+    map->owner = (int *)realloc(map->owner, size * sizeof(int));
+    map->outcome_case = (struct case_branch **)
+      realloc(map->outcome_case, size * sizeof(struct case_branch *));
+  }
+  map->owner[map->count] = owner;
+  map->outcome_case[map->count] = b;
+  map->count++;
+}
+
+
+static void build_map(struct outcome_map *map, const struct tree_info *info)
+{
+  int i, j;
+
+  map->info           = info;
+  map->count          = 0;
+  map->owner          = NULL;
+  map->outcome_case   = NULL;
+  map->statement_base = (int *)malloc((info->statement_count + 1) * sizeof(int));
+  map->case_outcome   = (int *)malloc((info->case_count + 1) * sizeof(int));
+  map->subtree_end    = (int *)malloc((info->statement_count + 1) * sizeof(int));
+
+  for (i = 0; i < info->statement_count; ++i) {
+    struct statement *s = info->statements[i];
+
+    map->statement_base[i] = -1;
+    switch (s->type) {
+      case IFtype:
+      case IFELSEtype:
+      case FORtype:
+      case WHILEtype:
+      case REPEATtype:
+        map->statement_base[i] = map->count;
+        add_outcome(map, i, NULL);
+        add_outcome(map, i, NULL);
+        break;
+
+      case SWITCHtype: {
+        int count;
+        struct case_branch **cases = source_order(s->cl, &count);
+        map->statement_base[i] = map->count;
+        for (j = 0; j < count; ++j) {
+          map->case_outcome[cases[j]->id] = map->count;
+          add_outcome(map, i, cases[j]);
+        }
+        free(cases);
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+
+  // Top level statements are not contained in any other statement.
+  for (i = 0; i < info->statement_count; ) {
+    i = measure(info->statements[i], map->subtree_end);
+  }
+}
+
+
+static void free_map(struct outcome_map *map)
+{
+  free(map->statement_base);
+  free(map->case_outcome);
+  free(map->owner);
+  free(map->outcome_case);
+  free(map->subtree_end);
+}
+
+
+static void describe_outcome(const struct outcome_map *map, int outcome, FILE *out)
+{
+  static const char *names[][2] = {
+    { "true", "false" },                                   // IF
+    { "zero iterations", "one or more iterations" },       // WHILE, FOR
+    { "left after one pass", "repeated" }                  // REPEAT
+  };
+  struct statement   *s = map->info->statements[map->owner[outcome]];
+  struct case_branch *b = map->outcome_case[outcome];
+  int k = outcome - map->statement_base[s->id];
+  char where[300];
+
+  fprintf(out, "%s %s ",
+    line_label(where, sizeof(where), s->module, s->line), statement_type_name(s->type));
+  switch (s->type) {
+    case IFtype:
+    case IFELSEtype:
+      fprintf(out, "%s", names[0][k]);
+      break;
+
+    case FORtype:
+    case WHILEtype:
+      fprintf(out, "%s", names[1][k]);
+      break;
+
+    case REPEATtype:
+      fprintf(out, "%s", names[2][k]);
+      break;
+
+    default:
+      if (b->phrase < 0) fprintf(out, "DEFAULT");
+      else fprintf(out, "CASE %.60s", phrase_text(b->phrase));
+      break;
+  }
+}
+
+//-----------------------------
+//      Walks
+//-----------------------------
+
+// Number of uncovered outcomes in a statement list.
+static int pending(const struct walker *w, const struct statement_list *list)
+{
+  const int *prefix = w->plan->pending;
+
+  if (list == NULL || list->count == 0) return 0;
+  return prefix[w->plan->map->subtree_end[list->items[list->count - 1]->id]] -
+         prefix[list->items[0]->id];
+}
+
+
+// Is this outcome still worth reaching?
+static int wanted(const struct walker *w, int outcome)
+{
+  return !w->plan->covered[outcome] && w->stamp[outcome] != w->serial;
+}
+
+
+static void reach(struct walker *w, int outcome)
+{
+  struct walk *walk = &w->current;
+
+  if (w->stamp[outcome] == w->serial) return;
+  w->stamp[outcome] = w->serial;
+  if (walk->reached_count == walk->reached_capacity) {
+    walk->reached_capacity = walk->reached_capacity ? 2 * walk->reached_capacity : 16;
+    walk->reached = (int *)
+      realloc(walk->reached, walk->reached_capacity * sizeof(int));
+  }
+  walk->reached[walk->reached_count++] = outcome;
+  if (!w->plan->covered[outcome]) walk->new_count++;
+}
+
+
+// Choose among options with the given scores. A negative score marks an
+// option that is not available. The best score wins, ties are broken at
+// random, and once in a while the choice is made at random anyway so
+// that the walks explore.
+//
+static int choose(struct walker *w, int count, const int *score)
+{
+  int best = -1, ties = 0, i;
+
+  if (!w->winding_down && rng_below(&w->random, 8) == 0) {
+    int available = 0;
+    for (i = 0; i < count; ++i) if (score[i] >= 0) ++available;
+    available = (int)rng_below(&w->random, available);
+    for (i = 0; i < count; ++i) {
+      if (score[i] >= 0 && available-- == 0) return i;
+    }
+  }
+  for (i = 0; i < count; ++i) {
+    if (score[i] < 0) continue;
+    if (best < 0 || score[i] > score[best]) {
+      best = i;
+      ties = 1;
+    }
+    else if (score[i] == score[best] && rng_below(&w->random, ++ties) == 0) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+
+// Append one answer line to the script. The phrase is added as a comment
+// to make the script readable; line breaks inside it are flattened.
+//
+static void answer(struct walker *w, const char *reply, int phrase)
+{
+  vtc_string *script = &w->current.script;
+  const char *p;
+
+  vtc_string_appendcharp(script, reply);
+  if (phrase >= 0) {
+    vtc_string_appendcharp(script, *reply ? "  # " : "# ");
+    for (p = phrase_text(phrase); *p; ++p) {
+      vtc_string_appendchar(script, (*p == '\n' || *p == '\r') ? ' ' : *p);
+    }
+  }
+  vtc_string_appendchar(script, '\n');
+  if (++w->current.answers >= w->plan->options->max_decisions) {
+    w->winding_down = 1;
+  }
+}
+
+
+// Answer the questions of a condition so that it takes the given value.
+static void solve(struct walker *w, struct expression *e, int value)
+{
+  switch (e->op) {
+    case PASSop:
+      solve(w, e->first, value);
+      break;
+
+    case NOTop:
+      solve(w, e->first, !value);
+      break;
+
+    case ANDop:
+      if (value) {
+        solve(w, e->first, 1);
+        solve(w, e->second, 1);
+      }
+      else if (rng_below(&w->random, 2) == 0) {
+        solve(w, e->first, 0);
+      }
+      else {
+        solve(w, e->first, 1);
+        solve(w, e->second, 0);
+      }
+      break;
+
+    case ORop:
+      if (!value) {
+        solve(w, e->first, 0);
+        solve(w, e->second, 0);
+      }
+      else if (rng_below(&w->random, 2) == 0) {
+        solve(w, e->first, 1);
+      }
+      else {
+        solve(w, e->first, 0);
+        solve(w, e->second, 1);
+      }
+      break;
+
+    case PROMPTop:
+      answer(w, value ? "t" : "f", e->phrase);
+      break;
+  }
+}
+
+
+static enum abort_type walk_list(struct walker *w, struct statement_list *list);
+
+static enum abort_type walk_statement(struct walker *w, struct statement *s)
+{
+  int base = w->plan->map->statement_base[s->id];
+  int max_trips = w->plan->options->max_trips;
+  int score[2];
+  int trips = 0, k;
+  enum abort_type result = NORMAL;
+
+  switch (s->type) {
+    case BREAKtype:
+      result = fromBREAK;
+      break;
+
+    case CONTINUEtype:
+      result = fromCONTINUE;
+      break;
+
+    case EPtype:
+      answer(w, "", s->phrase);
+      break;
+
+    case RETURNtype:
+      break;
+
+    case IFtype:
+    case IFELSEtype:
+      score[0] = 2 * wanted(w, base)     + pending(w, s->first);
+      score[1] = 2 * wanted(w, base + 1) + pending(w, s->second);
+      if (w->winding_down) score[0] = -1;
+      k = choose(w, 2, score);
+      solve(w, s->conditional, k == 0);
+      reach(w, base + k);
+      result = walk_list(w, k == 0 ? s->first : s->second);
+      break;
+
+    case FORtype:
+    case WHILEtype:
+      for (;;) {
+        int go;
+        if (trips == 0) {
+          score[0] = 2 * wanted(w, base);
+          score[1] = 2 * wanted(w, base + 1) + pending(w, s->first);
+          if (w->winding_down) score[1] = -1;
+          go = choose(w, 2, score) == 1;
+        }
+        else {
+          go = !w->winding_down && trips < max_trips &&
+               pending(w, s->first) > 0 && rng_below(&w->random, 2) == 0;
+        }
+        solve(w, s->conditional, go);
+        if (!go) break;
+        trips++;
+        if (walk_list(w, s->first) == fromBREAK) break;
+      }
+      reach(w, base + (trips == 0 ? 0 : 1));
+      break;
+
+    case REPEATtype:
+      for (;;) {
+        int again;
+        trips++;
+        if (walk_list(w, s->first) == fromBREAK) break;
+        if (trips == 1) {
+          score[0] = 2 * wanted(w, base);
+          score[1] = 2 * wanted(w, base + 1) + pending(w, s->first);
+          if (w->winding_down || max_trips < 2) score[1] = -1;
+          again = choose(w, 2, score) == 1;
+        }
+        else {
+          again = !w->winding_down && trips < max_trips &&
+                  pending(w, s->first) > 0 && rng_below(&w->random, 2) == 0;
+        }
+        solve(w, s->conditional, !again);
+        if (!again) break;
+      }
+      reach(w, base + (trips == 1 ? 0 : 1));
+      break;
+
+    case SWITCHtype: {
+      // One numbered menu of the cases in source order; the last option
+      // is "none of them", which runs the DEFAULT if there is one.
+      struct case_branch *chosen;
+      char number[16];
+      int i;
+      int *scores = (int *)malloc((s->case_count + 1) * sizeof(int));
+
+      for (i = 0; i < s->case_count; ++i) {
+        int outcome = w->plan->map->case_outcome[s->cases[i]->id];
+        scores[i] = w->winding_down ? -1 :
+          2 * wanted(w, outcome) + pending(w, s->cases[i]->first);
+      }
+      scores[i] = 0;
+      if (s->default_case != NULL && !w->winding_down) {
+        scores[i] = 2 * wanted(w, w->plan->map->case_outcome[s->default_case->id]) +
+          pending(w, s->default_case->first);
+      }
+      k = choose(w, s->case_count + 1, scores);
+      free(scores);
+
+      chosen = k < s->case_count ? s->cases[k] : s->default_case;
+      if (s->case_count > 0) {
+        sprintf(number, "%d", k < s->case_count ? k + 1 : 0);
+        answer(w, number, k < s->case_count ? s->cases[k]->phrase : s->phrase);
+      }
+      if (chosen != NULL) {
+        reach(w, w->plan->map->case_outcome[chosen->id]);
+        result = walk_list(w, chosen->first);
+      }
+      break;
+    }
+
+    case PARALLELtype:
+      // The executor runs the branches in order and asks nothing itself.
+      for (k = 0; k < s->case_count; ++k) walk_list(w, s->cases[k]->first);
+      break;
+  }
+  return result;
+}
+
+
+static enum abort_type walk_list(struct walker *w, struct statement_list *list)
+{
+  enum abort_type result = NORMAL;
+  int i;
+
+  if (list == NULL) return result;
+  for (i = 0; i < list->count && result == NORMAL; ++i) {
+    result = walk_statement(w, list->items[i]);
+  }
+  return result;
+}
+
+
+static void reset_walk(struct walk *walk)
+{
+  vtc_string_erase(&walk->script);
+  walk->reached_count = 0;
+  walk->new_count     = 0;
+  walk->answers       = 0;
+}
+
+
+static void *search(void *arg)
+{
+  struct walker *w = (struct walker *)arg;
+  int i;
+
+  reset_walk(&w->best);
+  for (i = 0; i < w->plan->options->candidates; ++i) {
+    struct walk temp;
+
+    reset_walk(&w->current);
+    w->serial++;
+    w->winding_down = 0;
+    walk_list(w, w->plan->top);
+
+    if (w->current.new_count > w->best.new_count ||
+        (w->current.new_count == w->best.new_count &&
+         w->current.new_count > 0 && w->current.answers < w->best.answers)) {
+      temp       = w->best;
+      w->best    = w->current;
+      w->current = temp;
+    }
+  }
+  return NULL;
+}
+
+//-----------------------------
+//      External Functions
+//-----------------------------
+
+void cover_default_options(struct cover_options *options)
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  options->threads       = cpus > 0 ? (int)cpus : 1;
+  options->candidates    = 64;
+  options->max_trips     = 2;
+  options->max_decisions = 100000;
+  options->seed          = 1;
+}
+
+
+int cover_generate(
+  struct statement_list      *top,
+  const struct tree_info     *info,
+  const struct cover_options *options,
+  const char                 *prefix)
+{
+  struct outcome_map  map;
+  struct plan         plan;
+  struct walker      *walkers;
+  struct walk        *chosen = NULL;
+  unsigned char      *covered;
+  int                *uses;
+  unsigned long long  seed = options->seed;
+  int threads = options->threads < 1 ? 1 : options->threads;
+  int chosen_count = 0, kept = 0, covered_count = 0;
+  int per_thread, i, j, ok = 1;
+  struct cover_options adjusted = *options;
+
+  build_map(&map, info);
+  covered = (unsigned char *)calloc(map.count + 1, 1);
+
+  // Spread the candidates evenly over the threads.
+  per_thread = (options->candidates + threads - 1) / threads;
+  adjusted.candidates = per_thread < 1 ? 1 : per_thread;
+
+  plan.map     = &map;
+  plan.top     = top;
+  plan.options = &adjusted;
+  plan.covered = covered;
+  plan.pending = (int *)malloc((info->statement_count + 1) * sizeof(int));
+
+  walkers = (struct walker *)calloc(threads, sizeof(struct walker));
+  for (i = 0; i < threads; ++i) {
+    walkers[i].plan  = &plan;
+    walkers[i].stamp = (int *)calloc(map.count + 1, sizeof(int));
+    vtc_string_init(&walkers[i].current.script);
+    vtc_string_init(&walkers[i].best.script);
+  }
+
+  while (covered_count < map.count && top != NULL) {
+    struct walker *best = NULL;
+
+    // Prefix sums of uncovered outcomes by owning statement.
+    memset(plan.pending, 0, (info->statement_count + 1) * sizeof(int));
+    for (i = 0; i < map.count; ++i) {
+      if (!covered[i]) plan.pending[map.owner[i] + 1]++;
+    }
+    for (i = 0; i < info->statement_count; ++i) {
+      plan.pending[i + 1] += plan.pending[i];
+    }
+
+    for (i = 0; i < threads; ++i) rng_seed(&walkers[i].random, &seed);
+    for (i = 1; i < threads; ++i) {
+      pthread_create(&walkers[i].thread, NULL, search, &walkers[i]);
+    }
+    search(&walkers[0]);
+    for (i = 1; i < threads; ++i) pthread_join(walkers[i].thread, NULL);
+
+    for (i = 0; i < threads; ++i) {
+      struct walk *b = &walkers[i].best;
+      if (b->new_count == 0) continue;
+      if (best == NULL || b->new_count > best->best.new_count ||
+          (b->new_count == best->best.new_count &&
+           b->answers < best->best.answers)) {
+        best = &walkers[i];
+      }
+    }
+    if (best == NULL) break;
+
+    // Keep the winner and give its walker a fresh buffer.
+    chosen = (struct walk *)realloc(chosen, (chosen_count + 1) * sizeof(struct walk));
+    chosen[chosen_count++] = best->best;
+    for (j = 0; j < best->best.reached_count; ++j) {
+      int outcome = best->best.reached[j];
+      if (!covered[outcome]) {
+        covered[outcome] = 1;
+        ++covered_count;
+      }
+    }
+    memset(&best->best, 0, sizeof(struct walk));
+    vtc_string_init(&best->best.script);
+  }
+
+  // Drop scripts that add nothing to the others.
+  uses = (int *)calloc(map.count + 1, sizeof(int));
+  for (i = 0; i < chosen_count; ++i) {
+    for (j = 0; j < chosen[i].reached_count; ++j) uses[chosen[i].reached[j]]++;
+  }
+  for (i = chosen_count - 1; i >= 0; --i) {
+    int needed = 0;
+    for (j = 0; j < chosen[i].reached_count; ++j) {
+      if (uses[chosen[i].reached[j]] == 1) needed = 1;
+    }
+    if (!needed) {
+      for (j = 0; j < chosen[i].reached_count; ++j) uses[chosen[i].reached[j]]--;
+      chosen[i].new_count = -1;
+    }
+  }
+
+  for (i = 0; i < chosen_count; ++i) {
+    char  *name;
+    FILE  *out;
+
+    if (chosen[i].new_count < 0) continue;
+    ++kept;
+    name = (char *)malloc(strlen(prefix) + 32);
+    sprintf(name, "%s-%d.ans", prefix, kept);
+    out = fopen(name, "w");
+    if (out == NULL || !vtc_string_write(&chosen[i].script, out)) {
+      printf("Unable to write %s.\n", name);
+      ok = 0;
+    }
+    else {
+      printf("%s: %ld answers, %d branch outcomes\n",
+        name, chosen[i].answers, chosen[i].reached_count);
+    }
+    if (out != NULL) fclose(out);
+    free(name);
+  }
+
+  printf("%d script%s cover %d of %d branch outcomes.\n",
+    kept, kept == 1 ? "" : "s", covered_count, map.count);
+  for (i = 0; i < map.count; ++i) {
+    if (covered[i]) continue;
+    printf("  not covered: ");
+    describe_outcome(&map, i, stdout);
+    printf("\n");
+  }
+
+  for (i = 0; i < chosen_count; ++i) {
+    vtc_string_destroy(&chosen[i].script);
+    free(chosen[i].reached);
+  }
+  for (i = 0; i < threads; ++i) {
+    vtc_string_destroy(&walkers[i].current.script);
+    vtc_string_destroy(&walkers[i].best.script);
+    free(walkers[i].current.reached);
+    free(walkers[i].best.reached);
+    free(walkers[i].stamp);
+  }
+  free(chosen);
+  free(walkers);
+  free(uses);
+  free(covered);
+  free(plan.pending);
+  free_map(&map);
+  return ok;
+}
+
+
+int cover_start(const struct tree_info *info, const char *file_name)
+{
+  FILE       *in;
+  vtc_string  line;
+  int         count = 0;
+  int         i = 0;
+
+  build_map(&recording_map, info);
+  recorded = (unsigned char *)calloc(recording_map.count + 1, 1);
+  recording_file = file_name;
+
+  // Merge in what earlier runs recorded, if it is for the same program.
+  in = fopen(file_name, "r");
+  if (in == NULL) return 1;
+  vtc_string_init(&line);
+  if (vtc_string_readline(&line, in) &&
+      sscanf(vtc_string_getcharp(&line), "# branch coverage of %d", &count) == 1 &&
+      count == recording_map.count) {
+    while (i < count && vtc_string_readline(&line, in)) {
+      recorded[i++] = vtc_string_getcharat(&line, 0) == '1';
+    }
+  }
+  else {
+    printf("Warning: %s does not match this program; starting over.\n", file_name);
+  }
+  vtc_string_destroy(&line);
+  fclose(in);
+  return 1;
+}
+
+
+void cover_branch(const struct statement *s, int outcome)
+{
+  if (recorded == NULL) return;
+  recorded[recording_map.statement_base[s->id] + outcome] = 1;
+}
+
+
+void cover_case(const struct case_branch *b)
+{
+  if (recorded == NULL) return;
+  recorded[recording_map.case_outcome[b->id]] = 1;
+}
+
+
+int cover_finish(void)
+{
+  FILE *out;
+  int   covered = 0, i;
+
+  if (recorded == NULL) return 1;
+  for (i = 0; i < recording_map.count; ++i) covered += recorded[i];
+
+  out = fopen(recording_file, "w");
+  if (out == NULL) {
+    printf("Unable to write %s.\n", recording_file);
+    return 0;
+  }
+  fprintf(out, "# branch coverage of %d outcomes\n", recording_map.count);
+  for (i = 0; i < recording_map.count; ++i) {
+    fprintf(out, "%d ", recorded[i]);
+    describe_outcome(&recording_map, i, out);
+    fprintf(out, "\n");
+  }
+  fclose(out);
+
+  printf("Branch coverage: %d of %d outcomes.\n", covered, recording_map.count);
+  for (i = 0; i < recording_map.count; ++i) {
+    if (recorded[i]) continue;
+    printf("  not covered: ");
+    describe_outcome(&recording_map, i, stdout);
+    printf("\n");
+  }
+  free(recorded);
+  recorded = NULL;
+  free_map(&recording_map);
+  return 1;
+}
@@ -0,0 +1,67 @@
+/****************************************************************************
+FILE          : cover.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the branch coverage tools.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+A branch outcome is one way a control structure can go:
+
+  + IF and IF/ELSE: the condition is true or false.
+  + WHILE and FOR: the body runs zero times or one or more times.
+  + REPEAT: the loop is left after one pass or it goes around again.
+  + SWITCH: each CASE (and DEFAULT) is selected.
+
+The generator produces a small set of answer scripts that together
+exercise every reachable outcome. An answer script is simply the text a
+user would type while running the program, one answer per line, so it
+can be replayed by redirecting it to standard input. Running with
+coverage recording turned on accumulates the outcomes that were reached
+in a file so that a set of runs can be checked mechanically.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef COVER_H
+#define COVER_H
+
+#include "tree.h"
+
+struct cover_options {
+  int                threads;        // Worker threads used to search.
+  int                candidates;     // Walks tried for each script chosen.
+  int                max_trips;      // Loop iterations allowed per entry.
+  long               max_decisions;  // Answers allowed in one script.
+  unsigned long long seed;
+};
+
+// Fill in default options.
+void cover_default_options(struct cover_options *options);
+
+// Generate answer scripts named <prefix>-1.ans, <prefix>-2.ans, etc. and
+// print a summary. Returns zero if the scripts could not be written.
+int cover_generate(
+  struct statement_list      *top,
+  const struct tree_info     *info,
+  const struct cover_options *options,
+  const char                 *prefix);
+
+// Start recording coverage during execution. Outcomes already recorded
+// in the file (if it exists) are kept.
+int cover_start(const struct tree_info *info, const char *file_name);
+
+// Record that a statement took the given outcome (numbered in the order
+// listed above, starting at zero). Does nothing unless recording.
+void cover_branch(const struct statement *s, int outcome);
+
+// Record that a case was selected. Does nothing unless recording.
+void cover_case(const struct case_branch *b);
+
+// Write the coverage file and print a summary.
+int cover_finish(void);
+
+#endif
@@ -0,0 +1,419 @@
+/****************************************************************************
+FILE          : debug.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Phrase breakpoints and watches.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The automaton is built in the usual way: a trie of the literal pieces,
+failure links found breadth first, and the transitions filled in from
+the failure links so that matching never backs up. Each state that ends
+a piece lists the pieces ending there, and a dictionary link leads to
+the nearest state along the failure chain that ends one, so all the
+pieces found at a position are reached without walking the whole chain.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "debug.h"
+#include "intern.h"
+#include "module.h"
+
+struct pattern {
+  char *text;       // As given, for messages.
+  char *glob;       // Normalized, between stars; NULL if there are no wildcards.
+  int   watch;
+  int   piece_next; // Next pattern whose piece ends at the same state.
+};
+
+struct hit {
+  int pattern;      // First matching pattern or -1.
+  int phrase;       // The phrase it matched.
+};
+
+static struct pattern *patterns;
+static int             pattern_count;
+static int             pattern_capacity;
+
+// The automaton. State 0 is the root.
+static int (*next_state)[256];
+static int  *failure;
+static int  *dictionary;   // Nearest state on the failure chain ending a piece, or 0.
+static int  *ends;         // First pattern whose piece ends here, or -1.
+static int   state_count;
+static int   state_capacity;
+
+static struct hit *breaks;     // Indexed by statement ID.
+static struct hit *watches;
+static int         stepping;
+
+// Lower case with white space collapsed, as phrase_key() does.
+static char *normalize(const char *text)
+{
+  char *result = (char *)malloc(strlen(text) + 1);
+  char *p = result;
+
+  while (isspace((unsigned char)*text)) ++text;
+  while (*text != '\0') {
+    if (isspace((unsigned char)*text)) {
+      while (isspace((unsigned char)*text)) ++text;
+      if (*text != '\0') *p++ = ' ';
+    }
+    else {
+      *p++ = (char)tolower((unsigned char)*text++);
+    }
+  }
+  *p = '\0';
+  return result;
+}
+
+
+static int new_state(void)
+{
+  if (state_count == state_capacity) {
+    state_capacity = state_capacity == 0 ? 64 : 2 * state_capacity;
+    next_state = (int (*)[256])realloc(next_state, state_capacity * sizeof(*next_state));
+    failure    = (int *)realloc(failure, state_capacity * sizeof(int));
+    dictionary = (int *)realloc(dictionary, state_capacity * sizeof(int));
+    ends       = (int *)realloc(ends, state_capacity * sizeof(int));
+  }
+  memset(next_state[state_count], -1, sizeof(next_state[state_count]));
+  failure[state_count]    = 0;
+  dictionary[state_count] = 0;
+  ends[state_count]       = -1;
+  return state_count++;
+}
+
+
+// Enters the literal piece of a pattern into the trie.
+static void add_piece(const char *piece, int length, int pattern)
+{
+  int state = 0, i, c;
+
+  if (state_count == 0) new_state();
+  for (i = 0; i < length; ++i) {
+    c = (unsigned char)piece[i];
+    if (next_state[state][c] < 0) {
+      int created = new_state();
+      next_state[state][c] = created;
+    }
+    state = next_state[state][c];
+  }
+  patterns[pattern].piece_next = ends[state];
+  ends[state] = pattern;
+}
+
+
+int debug_add_pattern(const char *text, int watch)
+{
+  struct pattern *p;
+  char *normal = normalize(text);
+  const char *piece = NULL, *start;
+  int length = 0, n;
+
+  if (*normal == '\0') {
+    free(normal);
+    return 0;
+  }
+  if (pattern_count == pattern_capacity) {
+    pattern_capacity = pattern_capacity == 0 ? 16 : 2 * pattern_capacity;
+    patterns = (struct pattern *)realloc(patterns, pattern_capacity * sizeof(struct pattern));
+  }
+  p = &patterns[pattern_count];
+  p->text       = strcpy((char *)malloc(strlen(text) + 1), text);
+  p->glob       = NULL;
+  p->watch      = watch;
+  p->piece_next = -1;
+
+  // The longest run without wildcards goes into the automaton. A pattern
+  // that is all wildcards has none and is tried on every phrase.
+  for (start = normal; *start != '\0'; start += n) {
+    n = (int)strcspn(start, "*?");
+    if (n > length) {
+      piece  = start;
+      length = n;
+    }
+    if (start[n] != '\0') ++n;
+  }
+  if (length > 0) add_piece(piece, length, pattern_count);
+  else p->piece_next = -2;
+
+  // A glob may match any part of a phrase.
+  if (strpbrk(normal, "*?") != NULL) {
+    p->glob = (char *)malloc(strlen(normal) + 3);
+    sprintf(p->glob, "*%s*", normal);
+  }
+  free(normal);
+  ++pattern_count;
+  return 1;
+}
+
+
+int debug_read_patterns(const char *file_name)
+{
+  FILE       *in;
+  vtc_string  line;
+  const char *text;
+
+  if ((in = fopen(file_name, "r")) == NULL) return 0;
+  vtc_string_init(&line);
+  while (vtc_string_readline(&line, in)) {
+    text = vtc_string_getcharp(&line);
+    while (isspace((unsigned char)*text)) ++text;
+    if (*text == '#' || *text == '\0') continue;
+    if (strncmp(text, "watch", 5) == 0 && isspace((unsigned char)text[5])) {
+      debug_add_pattern(text + 5, 1);
+    }
+    else {
+      debug_add_pattern(text, 0);
+    }
+  }
+  vtc_string_destroy(&line);
+  fclose(in);
+  return 1;
+}
+
+
+// Computes the failure and dictionary links and completes the transitions.
+static void build_automaton(void)
+{
+  int *queue = (int *)malloc(state_count * sizeof(int));
+  int  head = 0, tail = 0;
+  int  state, child, c;
+
+  for (c = 0; c < 256; ++c) {
+    child = next_state[0][c];
+    if (child < 0) {
+      next_state[0][c] = 0;
+    }
+    else {
+      failure[child] = 0;
+      queue[tail++]  = child;
+    }
+  }
+  while (head < tail) {
+    state = queue[head++];
+    for (c = 0; c < 256; ++c) {
+      child = next_state[state][c];
+      if (child < 0) {
+        next_state[state][c] = next_state[failure[state]][c];
+        continue;
+      }
+      failure[child]    = next_state[failure[state]][c];
+      dictionary[child] = ends[failure[child]] >= 0 ? failure[child] : dictionary[failure[child]];
+      queue[tail++]     = child;
+    }
+  }
+  free(queue);
+}
+
+
+// Matches a glob against the whole of a text (both normalized).
+static int glob_match(const char *glob, const char *text)
+{
+  const char *star = NULL, *resume = NULL;
+
+  while (*text != '\0') {
+    if (*glob == '?' || (*glob != '*' && *glob == *text)) {
+      ++glob;
+      ++text;
+    }
+    else if (*glob == '*') {
+      star   = glob++;
+      resume = text;
+    }
+    else if (star != NULL) {
+      glob = star + 1;
+      text = ++resume;
+    }
+    else {
+      return 0;
+    }
+  }
+  while (*glob == '*') ++glob;
+  return *glob == '\0';
+}
+
+
+// Does a pattern whose piece was found (or that has none) match the text?
+static int pattern_matches(const struct pattern *p, const char *text)
+{
+  return p->glob == NULL || glob_match(p->glob, text);
+}
+
+
+// Finds the first breakpoint and the first watch that match each phrase.
+// Only the patterns whose piece turned up in the phrase (and those without
+// a piece) are looked at.
+static void match_phrases(struct hit *phrase_break, struct hit *phrase_watch)
+{
+  int *found      = (int *)malloc(pattern_count * sizeof(int));
+  int *candidates = (int *)malloc(pattern_count * sizeof(int));
+  int  count = phrase_count();
+  int  always = 0, n;
+  int  id, state, t, k, i;
+  const unsigned char *text;
+  struct hit *h;
+
+  for (k = 0; k < pattern_count; ++k) {
+    found[k] = -1;
+    if (patterns[k].piece_next == -2) candidates[always++] = k;
+  }
+  for (id = 0; id < count; ++id) {
+    phrase_break[id].pattern = phrase_watch[id].pattern = -1;
+    phrase_break[id].phrase  = phrase_watch[id].phrase  = id;
+
+    n = always;
+    state = 0;
+    for (text = (const unsigned char *)phrase_key(id); *text != '\0'; ++text) {
+      state = next_state[state][*text];
+      for (t = ends[state] >= 0 ? state : dictionary[state]; t != 0; t = dictionary[t]) {
+        for (k = ends[t]; k >= 0; k = patterns[k].piece_next) {
+          if (found[k] == id) continue;
+          found[k] = id;
+          candidates[n++] = k;
+        }
+      }
+    }
+
+    for (i = 0; i < n; ++i) {
+      k = candidates[i];
+      h = patterns[k].watch ? &phrase_watch[id] : &phrase_break[id];
+      if (h->pattern >= 0 && h->pattern < k) continue;
+      if (pattern_matches(&patterns[k], phrase_key(id))) h->pattern = k;
+    }
+  }
+  free(candidates);
+  free(found);
+}
+
+
+// Keeps the earlier of two hits.
+static void first_hit(struct hit *h, const struct hit *candidate)
+{
+  if (candidate->pattern >= 0 && (h->pattern < 0 || candidate->pattern < h->pattern)) {
+    *h = *candidate;
+  }
+}
+
+
+static void expression_hits(
+  const struct expression *e, const struct hit *phrase_break, const struct hit *phrase_watch,
+  struct hit *b, struct hit *w)
+{
+  int i;
+
+  if (e == NULL) return;
+  if (e->op == PROMPTop && e->phrase >= 0) {
+    first_hit(b, &phrase_break[e->phrase]);
+    first_hit(w, &phrase_watch[e->phrase]);
+    return;
+  }
+  for (i = 0; i < e->count; ++i) {
+    expression_hits(e->operands[i], phrase_break, phrase_watch, b, w);
+  }
+  expression_hits(e->first, phrase_break, phrase_watch, b, w);
+  expression_hits(e->second, phrase_break, phrase_watch, b, w);
+}
+
+
+void debug_start(const struct tree_info *info)
+{
+  struct hit *phrase_break, *phrase_watch;
+  const struct statement *s;
+  int count = phrase_count();
+  int id, i;
+
+  if (pattern_count == 0) return;
+  if (state_count == 0) new_state();
+  build_automaton();
+
+  phrase_break = (struct hit *)malloc((count + 1) * sizeof(struct hit));
+  phrase_watch = (struct hit *)malloc((count + 1) * sizeof(struct hit));
+  match_phrases(phrase_break, phrase_watch);
+
+  breaks  = (struct hit *)malloc((info->statement_count + 1) * sizeof(struct hit));
+  watches = (struct hit *)malloc((info->statement_count + 1) * sizeof(struct hit));
+  for (id = 0; id < info->statement_count; ++id) {
+    s = info->statements[id];
+    breaks[id].pattern = watches[id].pattern = -1;
+    if (s->phrase >= 0) {
+      first_hit(&breaks[id], &phrase_break[s->phrase]);
+      first_hit(&watches[id], &phrase_watch[s->phrase]);
+    }
+    expression_hits(s->conditional, phrase_break, phrase_watch, &breaks[id], &watches[id]);
+    for (i = 0; i < s->case_count; ++i) {
+      if (s->cases[i]->phrase < 0) continue;
+      first_hit(&breaks[id], &phrase_break[s->cases[i]->phrase]);
+      first_hit(&watches[id], &phrase_watch[s->cases[i]->phrase]);
+    }
+  }
+  free(phrase_break);
+  free(phrase_watch);
+}
+
+
+// Asks what to do at a breakpoint or after a step.
+static void debug_prompt(void)
+{
+  for (;;) {
+    printf("debug> ");
+    switch (read_answer()) {
+      case '\n': case 'c': case 'C':
+        stepping = 0;
+        return;
+
+      case 's': case 'S':
+        stepping = 1;
+        return;
+
+      case 'w': case 'W':
+        write_position(stdout);
+        break;
+
+      case 'q': case 'Q':
+        printf("Execution stopped.\n");
+        exit(EXIT_SUCCESS);
+
+      default:
+        printf("c (or Enter) continues, s steps to the next statement, w shows where\n"
+               "execution is, q stops.\n");
+        break;
+    }
+  }
+}
+
+
+void debug_statement(const struct statement *s)
+{
+  const struct hit *h;
+  char where[300];
+
+  if (breaks == NULL) return;
+  describe_line(where, sizeof(where), s->module, s->line);
+  h = &watches[s->id];
+  if (h->pattern >= 0) {
+    printf("(watch \"%s\": %s, %s)\n",
+      patterns[h->pattern].text, where, phrase_text(h->phrase));
+  }
+  h = &breaks[s->id];
+  if (h->pattern >= 0) {
+    printf("Breakpoint \"%s\": %s, %s\n",
+      patterns[h->pattern].text, where, phrase_text(h->phrase));
+    debug_prompt();
+  }
+  else if (stepping) {
+    printf("Step: %s, %s", where, statement_type_name(s->type));
+    if (s->phrase >= 0) printf(" %s", phrase_text(s->phrase));
+    printf("\n");
+    debug_prompt();
+  }
+}
@@ -0,0 +1,53 @@
+/****************************************************************************
+FILE          : debug.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to phrase breakpoints and watches.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+A breakpoint or a watch is a pattern that is looked for in the phrases
+of the program: a piece of text, or a glob in which * stands for any
+run of characters and ? for any one character. A pattern matches a
+phrase if it matches some part of it. Letter case and the amount of
+white space between words don't matter. When the executor reaches a
+statement with a phrase (its action, a phrase of its condition, or a
+CASE) that matches a breakpoint it stops and asks what to do; a watch
+only prints a note.
+
+All the patterns are matched at once, before execution starts: they go
+into one Aho-Corasick automaton that is run over the text of each
+distinct phrase (see intern.h). A glob contributes its longest literal
+piece to the automaton and is only tried in full on the phrases that
+contain that piece. The first breakpoint and watch of each statement are
+then kept in a table, so reaching a statement costs one lookup however
+many patterns there are.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef DEBUG_H
+#define DEBUG_H
+
+#include "tree.h"
+
+// Adds a breakpoint (watch zero) or a watch pattern. Returns zero if the
+// pattern is empty.
+int debug_add_pattern(const char *pattern, int watch);
+
+// Adds the patterns in a file, one per line. A line starting with "watch"
+// gives a watch; blank lines and lines starting with # are skipped.
+// Returns zero if the file can't be read.
+int debug_read_patterns(const char *file_name);
+
+// Matches the patterns against a prepared tree. Does nothing if there are
+// no patterns.
+void debug_start(const struct tree_info *info);
+
+// Called by the executor as it reaches each statement.
+void debug_statement(const struct statement *s);
+
+#endif
@@ -0,0 +1,273 @@
+/****************************************************************************
+FILE          : events.c
+LAST REVISION : 2026-10-19
+SUBJECT       : The event stream.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Each event is built directly in the output buffer. Answers are parsed
+just far enough to find the "answer", "repeat" and "then" members.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "budget.h"
+#include "events.h"
+#include "intern.h"
+#include "module.h"
+#include "outbuf.h"
+
+int events_on = 0;
+
+static struct outbuf events;
+static long          counted;   // Bytes of events given to budget_output().
+
+static void put_text(const char *text)
+{
+  out_write(&events, text, strlen(text));
+}
+
+
+static void put_number(long number)
+{
+  char buffer[24];
+
+  sprintf(buffer, "%ld", number);
+  put_text(buffer);
+}
+
+
+static void put_string(const char *s)
+{
+  char escape[8];
+
+  out_char(&events, '"');
+  for (; *s != '\0'; ++s) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\') {
+      out_char(&events, '\\');
+      out_char(&events, (char)c);
+    }
+    else if (c == '\n') put_text("\\n");
+    else if (c == '\t') put_text("\\t");
+    else if (c < ' ') {
+      sprintf(escape, "\\u%04x", c);
+      put_text(escape);
+    }
+    else out_char(&events, (char)c);
+  }
+  out_char(&events, '"');
+}
+
+
+// Starts an event about a statement.
+static void begin(const char *event, const struct statement *s)
+{
+  put_text("{\"event\":\"");
+  put_text(event);
+  put_text("\",\"id\":");
+  put_number(s->id);
+  put_text(",\"line\":");
+  put_number(s->line);
+  if (s->module != 0) {
+    put_text(",\"module\":");
+    put_string(module_name(s->module));
+  }
+}
+
+
+static void end(void)
+{
+  long total;
+
+  out_char(&events, '}');
+  out_newline(&events);
+  total = events.written + (long)events.used;
+  budget_output(total - counted);
+  counted = total;
+}
+
+
+void events_start(FILE *out, const struct tree_info *info)
+{
+  out_open(&events, out);
+  events_on = 1;
+  put_text("{\"event\":\"parsed\",\"statements\":");
+  put_number(info->statement_count);
+  put_text(",\"expressions\":");
+  put_number(info->expression_count);
+  put_text(",\"cases\":");
+  put_number(info->case_count);
+  end();
+}
+
+
+void events_flush(void)
+{
+  if (!events_on) return;
+  out_drain(&events);
+  fflush(events.file);
+}
+
+
+void event_action(const struct statement *s)
+{
+  begin("action", s);
+  put_text(",\"phrase\":");
+  put_string(phrase_text(s->phrase));
+  end();
+}
+
+
+void event_question(const struct statement *s, const struct expression *prompt)
+{
+  begin("question", s);
+  put_text(",\"expression\":");
+  put_number(prompt->id);
+  put_text(",\"phrase\":");
+  put_string(phrase_text(prompt->phrase));
+  end();
+}
+
+
+void event_answer(
+  const struct statement *s, const struct expression *prompt, int value, int remembered)
+{
+  begin("answer", s);
+  put_text(",\"expression\":");
+  put_number(prompt->id);
+  put_text(value ? ",\"value\":true" : ",\"value\":false");
+  if (remembered) put_text(",\"remembered\":true");
+  end();
+}
+
+
+void event_menu(const struct statement *s)
+{
+  int i;
+
+  begin("menu", s);
+  put_text(",\"phrase\":");
+  put_string(phrase_text(s->phrase));
+  put_text(",\"cases\":[");
+  for (i = 0; i < s->case_count; ++i) {
+    if (i > 0) out_char(&events, ',');
+    put_string(phrase_text(s->cases[i]->phrase));
+  }
+  put_text("],\"default\":");
+  put_text(s->default_case != NULL ? "true" : "false");
+  end();
+}
+
+
+void event_switch(const struct statement *s, int choice, const struct case_branch *chosen)
+{
+  begin("switch", s);
+  put_text(",\"choice\":");
+  put_number(choice);
+  put_text(",\"case\":");
+  put_number(chosen != NULL ? chosen->id : -1);
+  end();
+}
+
+
+void event_loop(const struct statement *s)
+{
+  begin("loop", s);
+  end();
+}
+
+
+void event_exit(const struct statement *s, int trips, long fast_forwarded)
+{
+  begin("exit", s);
+  put_text(",\"trips\":");
+  put_number(trips);
+  put_text(",\"fast_forwarded\":");
+  put_number(fast_forwarded);
+  end();
+}
+
+
+void event_return(const struct statement *s)
+{
+  begin("return", s);
+  end();
+}
+
+
+// The branch of a PARALLEL about to run, numbered from 0.
+void event_branch(const struct statement *s, int branch)
+{
+  begin("branch", s);
+  put_text(",\"branch\":");
+  put_number(branch);
+  put_text(",\"case\":");
+  put_number(s->cases[branch]->id);
+  end();
+}
+
+
+void event_end(const char *event, const char *reason)
+{
+  put_text("{\"event\":\"");
+  put_text(event);
+  put_text("\",\"reason\":");
+  put_string(reason);
+  end();
+  events_flush();
+}
+
+
+// Finds a member of a JSON object and returns a pointer to its value, or
+// NULL. Good enough for the flat objects answers are.
+static const char *member(const char *object, const char *name)
+{
+  size_t length = strlen(name);
+  const char *p = object;
+
+  while ((p = strchr(p, '"')) != NULL) {
+    ++p;
+    if (strncmp(p, name, length) == 0 && p[length] == '"') {
+      p += length + 1;
+      while (isspace((unsigned char)*p)) ++p;
+      if (*p != ':') return NULL;
+      ++p;
+      while (isspace((unsigned char)*p)) ++p;
+      return p;
+    }
+  }
+  return NULL;
+}
+
+
+void event_translate_answer(char *line, int size)
+{
+  char answer[64];
+  const char *value, *repeat, *then;
+  int length;
+
+  if (line[0] != '{') return;
+  value  = member(line, "answer");
+  repeat = member(line, "repeat");
+  then   = member(line, "then");
+
+  if (value == NULL) length = sprintf(answer, "\n");
+  else if (strncmp(value, "true", 4) == 0) length = sprintf(answer, "t");
+  else if (strncmp(value, "false", 5) == 0) length = sprintf(answer, "f");
+  else length = sprintf(answer, "%ld", strtol(value, NULL, 10));
+
+  if (value != NULL && repeat != NULL) {
+    length += sprintf(answer + length, " x%ld", strtol(repeat, NULL, 10));
+    if (then != NULL) length += sprintf(answer + length, " then %c", *then == 't' ? 't' : 'f');
+  }
+  if (length < size) strcpy(line, answer);
+}
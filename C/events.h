@@ -0,0 +1,72 @@
+/****************************************************************************
+FILE          : events.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the event stream.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+In protocol mode the executor describes what it does as a stream of
+events, one JSON object per line, instead of prose for a person. Every
+event names its kind and the statement it concerns by ID and line:
+
+  {"event":"action","id":7,"line":12,"phrase":"[free the buffer]"}
+  {"event":"question","id":9,"line":14,"expression":21,"phrase":"[...]"}
+  {"event":"answer","id":9,"line":14,"expression":21,"value":true}
+  {"event":"menu","id":30,"line":40,"phrase":"[...]","cases":["[...]",...]}
+  {"event":"switch","id":30,"line":40,"choice":2,"case":5}
+  {"event":"loop","id":3,"line":5}
+  {"event":"exit","id":3,"line":5,"trips":4,"fast_forwarded":0}
+  {"event":"branch","id":44,"line":50,"branch":1,"case":8}
+
+with "parsed" first, "return" for a RETURN, "end" when the program is
+done and "stop" if it is stopped. The line of a statement brought in by
+IMPORT is a line of that file, and "module" after it gives the file's
+path (see module.h). Actions are not waited for. An answer
+is written as a line such as {"answer":true}, {"answer":2} for a menu,
+or {"answer":true,"repeat":1000,"then":false} for a loop condition (see
+tree.h). A line that doesn't start with { is taken as a typed answer.
+
+Events are collected in a large buffer (see outbuf.h) that is written
+out only when it fills or the executor is about to wait for an answer,
+so a long stretch of actions costs one write.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdio.h>
+#include "tree.h"
+
+// Nonzero in protocol mode.
+extern int events_on;
+
+// Starts protocol mode, writing events to the given stream.
+void events_start(FILE *out, const struct tree_info *info);
+
+// Writes out the buffered events (before waiting for input).
+void events_flush(void);
+
+void event_action(const struct statement *s);
+void event_question(const struct statement *s, const struct expression *prompt);
+void event_answer(
+  const struct statement *s, const struct expression *prompt, int value, int remembered);
+void event_menu(const struct statement *s);
+void event_switch(const struct statement *s, int choice, const struct case_branch *chosen);
+void event_loop(const struct statement *s);
+void event_exit(const struct statement *s, int trips, long fast_forwarded);
+void event_return(const struct statement *s);
+void event_branch(const struct statement *s, int branch);
+
+// The last event. The reason is "normal" or describes what went wrong.
+void event_end(const char *event, const char *reason);
+
+// Rewrites a structured answer in place as the line a user would type.
+void event_translate_answer(char *line, int size);
+
+#endif
@@ -0,0 +1,873 @@
+/****************************************************************************
+FILE          : explore.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Exploration of the schedules of PARALLEL branches.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The state of a run is a set of threads, each with a stack of frames like
+the executor's, stopped just before its next action or decision. A step
+takes one thread past that point and on to its next one. Everything in
+between (entering a loop, a BREAK, the end of a list) is done as part
+of the step. A thread that reaches a PARALLEL starts one thread for
+each branch and waits for them all to finish.
+
+Reduction keeps only the schedules that are in normal form: a schedule
+isn't reported if one of its steps could be moved, past steps it doesn't
+interfere with, in front of a step of a thread that comes after its own
+(threads are ordered by where they were started). Every interleaving is
+equivalent to exactly one schedule in normal form, and a schedule that
+isn't in normal form can be recognized as its steps are added, so whole
+parts of the search are cut off at once. A step never moves past its
+own thread, the thread that started it, or the threads it started.
+
+The search is split into pieces (the choices made at the first few
+steps) that the workers take in turn. Each piece's schedules are kept
+apart and printed in order at the end, so the report doesn't depend on
+the number of threads.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "explore.h"
+#include "module.h"
+
+// Pieces of the search made for each worker.
+#define PIECES_PER_WORKER 8
+
+// Shorter words are never taken to be shared.
+#define SHORTEST_WORD 4
+
+//-----------------------------
+//      Interference
+//-----------------------------
+
+// The words of a statement's phrases, as sorted hashes.
+struct words {
+  uint64_t *hashes;
+  int       count;
+  int       capacity;
+};
+
+static const char *const common_words[] = {
+  "after", "also", "been", "before", "each", "from", "have", "into", "more", "only",
+  "over", "some", "than", "that", "their", "them", "then", "there", "they", "this",
+  "what", "when", "which", "will", "with", NULL
+};
+
+static int is_common(const char *word, int length)
+{
+  const char *const *c;
+
+  for (c = common_words; *c != NULL; ++c) {
+    if ((int)strlen(*c) == length && memcmp(*c, word, length) == 0) return 1;
+  }
+  return 0;
+}
+
+
+static void add_words(struct words *w, vtc_string *phrase)
+{
+  const char *p = vtc_string_getcharp(phrase);
+  char word[16];
+
+  while (*p != '\0') {
+    uint64_t hash = 14695981039346656037ULL;
+    int length = 0;
+
+    if (!isalnum((unsigned char)*p)) {
+      ++p;
+      continue;
+    }
+    for (; isalnum((unsigned char)*p); ++p, ++length) {
+      int ch = tolower((unsigned char)*p);
+      if (length < (int)sizeof(word)) word[length] = (char)ch;
+      hash = (hash ^ (unsigned char)ch) * 1099511628211ULL;
+    }
+    if (length < SHORTEST_WORD) continue;
+    if (length <= (int)sizeof(word) && is_common(word, length)) continue;
+    if (w->count == w->capacity) {
+      w->capacity = w->capacity ? 2 * w->capacity : 8;
+      w->hashes = (uint64_t *)realloc(w->hashes, w->capacity * sizeof(uint64_t));
+    }
+    w->hashes[w->count++] = hash;
+  }
+}
+
+
+static void add_condition_words(struct words *w, struct expression *e)
+{
+  if (e == NULL) return;
+  if (e->op == PROMPTop) add_words(w, e->ep);
+  add_condition_words(w, e->first);
+  add_condition_words(w, e->second);
+}
+
+
+static int compare_hashes(const void *left, const void *right)
+{
+  uint64_t a = *(const uint64_t *)left, b = *(const uint64_t *)right;
+  return a < b ? -1 : a > b;
+}
+
+
+static void collect_words(struct words *w, struct statement *s)
+{
+  int i, j;
+
+  memset(w, 0, sizeof(struct words));
+  if (s->ep != NULL) add_words(w, s->ep);
+  add_condition_words(w, s->conditional);
+  if (s->type == SWITCHtype) {
+    for (i = 0; i < s->case_count; ++i) add_words(w, s->cases[i]->case_condition);
+  }
+  if (w->count == 0) return;
+  qsort(w->hashes, w->count, sizeof(uint64_t), compare_hashes);
+  for (i = j = 0; i < w->count; ++i) {
+    if (j == 0 || w->hashes[j - 1] != w->hashes[i]) w->hashes[j++] = w->hashes[i];
+  }
+  w->count = j;
+}
+
+
+static int share_word(const struct words *a, const struct words *b)
+{
+  int i = 0, j = 0;
+
+  while (i < a->count && j < b->count) {
+    if (a->hashes[i] == b->hashes[j]) return 1;
+    if (a->hashes[i] < b->hashes[j]) ++i;
+    else ++j;
+  }
+  return 0;
+}
+
+//-----------------------------
+//      Threads
+//-----------------------------
+
+struct frame {
+  struct statement_list *list;
+  int                    index;   // Of the next statement to run.
+  struct statement      *loop;    // The loop whose body this is, or NULL.
+  int                    trips;   // Iterations begun (loops only).
+};
+
+enum thread_status { RUNNING, WAITING, FINISHED };
+
+struct thread {
+  enum thread_status status;
+  struct frame      *frames;
+  int                depth;
+  int                capacity;
+  struct statement  *at;        // Its action or test is next (RUNNING only).
+  int                parent;    // Index of the starting thread, or -1.
+  int                waiting;   // Branches still running (WAITING only).
+  int                forks;     // PARALLELs started so far.
+
+  // The fork and branch numbers of each PARALLEL on the way from the main
+  // thread. Threads are ordered by these; the main thread's is empty.
+  int               *key;
+  int                key_length;
+};
+
+struct state {
+  struct thread *threads;
+  int            count;
+  int            capacity;
+};
+
+// A step: one thread's action, or a decision and the way it went.
+struct event {
+  int               thread;
+  struct statement *statement;
+  int               outcome;   // For a SWITCH the case, else 1 or 0.
+};
+
+struct piece {
+  struct event *prefix;
+  int           length;
+  vtc_string    text;      // The schedules found.
+  int          *starts;    // Where each begins in the text.
+  long          found;
+  long          pruned;    // Steps skipped by the reduction.
+};
+
+// Everything the workers share.
+struct explorer {
+  const struct explore_options *options;
+  struct statement_list        *top;
+  struct words                 *words;   // By statement ID.
+  struct piece                 *pieces;
+  int                           piece_count;
+  int                           next_piece;
+  pthread_mutex_t               lock;
+};
+
+struct worker {
+  pthread_t        thread;
+  struct explorer *x;
+  struct event    *sequence;   // The steps taken so far.
+  int              length;
+  int              capacity;
+  struct piece    *piece;
+};
+
+static int list_count(const struct statement_list *list)
+{
+  return list == NULL ? 0 : list->count;
+}
+
+
+static void push_frame(
+  struct thread *t, struct statement_list *list, struct statement *loop, int trips)
+{
+  struct frame *f;
+
+  if (t->depth == t->capacity) {
+    t->capacity = t->capacity ? 2 * t->capacity : 8;
+    t->frames = (struct frame *)realloc(t->frames, t->capacity * sizeof(struct frame));
+  }
+  f = &t->frames[t->depth++];
+  f->list  = list;
+  f->index = 0;
+  f->loop  = loop;
+  f->trips = trips;
+}
+
+
+// Adds a thread that is about to start, and returns its index.
+static int new_thread(struct state *st, int parent, int length)
+{
+  struct thread *t;
+
+  if (st->count == st->capacity) {
+    st->capacity = st->capacity ? 2 * st->capacity : 8;
+    st->threads = (struct thread *)realloc(st->threads, st->capacity * sizeof(struct thread));
+  }
+  t = &st->threads[st->count];
+  memset(t, 0, sizeof(struct thread));
+  t->status     = RUNNING;
+  t->parent     = parent;
+  t->key        = (int *)malloc((length + 1) * sizeof(int));
+  t->key_length = length;
+  return st->count++;
+}
+
+
+static void copy_state(struct state *to, const struct state *from)
+{
+  int i;
+
+  to->count    = from->count;
+  to->capacity = from->count;
+  to->threads  = (struct thread *)malloc((from->count + 1) * sizeof(struct thread));
+  for (i = 0; i < from->count; ++i) {
+    struct thread       *t = &to->threads[i];
+    const struct thread *f = &from->threads[i];
+
+    *t = *f;
+    t->capacity = f->depth;
+    t->frames   = (struct frame *)malloc((f->depth + 1) * sizeof(struct frame));
+    memcpy(t->frames, f->frames, f->depth * sizeof(struct frame));
+    t->key = (int *)malloc((f->key_length + 1) * sizeof(int));
+    memcpy(t->key, f->key, f->key_length * sizeof(int));
+  }
+}
+
+
+static void free_state(struct state *st)
+{
+  int i;
+
+  for (i = 0; i < st->count; ++i) {
+    free(st->threads[i].frames);
+    free(st->threads[i].key);
+  }
+  free(st->threads);
+}
+
+
+static void advance(struct state *st, int index);
+
+static void finish(struct state *st, int index)
+{
+  int parent = st->threads[index].parent;
+
+  st->threads[index].status = FINISHED;
+  if (parent >= 0 && --st->threads[parent].waiting == 0) {
+    st->threads[parent].status = RUNNING;
+    advance(st, parent);
+  }
+}
+
+
+static void fork_branches(struct state *st, int index, struct statement *s)
+{
+  int fork = st->threads[index].forks++;
+  int length = st->threads[index].key_length;
+  int i, child;
+
+  st->threads[index].status  = WAITING;
+  st->threads[index].waiting = s->case_count;
+  for (i = 0; i < s->case_count; ++i) {
+    child = new_thread(st, index, length + 2);
+    memcpy(st->threads[child].key, st->threads[index].key, length * sizeof(int));
+    st->threads[child].key[length]     = fork;
+    st->threads[child].key[length + 1] = i;
+    push_frame(&st->threads[child], s->cases[i]->first, NULL, 0);
+    advance(st, child);
+  }
+}
+
+
+// BREAK and CONTINUE. One that isn't inside a loop of its thread ends
+// the thread.
+static void jump(struct state *st, int index, int is_break)
+{
+  struct thread *t = &st->threads[index];
+
+  while (t->depth > 0 && t->frames[t->depth - 1].loop == NULL) --t->depth;
+  if (t->depth == 0) return;
+  if (is_break) --t->depth;
+  else t->frames[t->depth - 1].index = list_count(t->frames[t->depth - 1].list);
+}
+
+
+// Runs a thread up to its next action or decision.
+static void advance(struct state *st, int index)
+{
+  struct thread    *t;
+  struct frame     *f;
+  struct statement *s;
+
+  for (;;) {
+    t = &st->threads[index];
+    if (t->depth == 0) {
+      finish(st, index);
+      return;
+    }
+    f = &t->frames[t->depth - 1];
+    if (f->index >= list_count(f->list)) {
+      if (f->loop != NULL) {
+        t->at = f->loop;   // Its test is next.
+        return;
+      }
+      --t->depth;
+      continue;
+    }
+    s = f->list->items[f->index++];
+    switch (s->type) {
+      case EPtype:
+      case IFtype:
+      case IFELSEtype:
+      case SWITCHtype:
+        t->at = s;
+        return;
+
+      case BREAKtype:
+      case CONTINUEtype:
+        jump(st, index, s->type == BREAKtype);
+        break;
+
+      case RETURNtype:
+        break;
+
+      case FORtype:
+      case WHILEtype:
+        push_frame(t, s->first, s, 0);
+        t->frames[t->depth - 1].index = list_count(s->first);
+        break;
+
+      case REPEATtype:
+        push_frame(t, s->first, s, 1);
+        break;
+
+      case PARALLELtype:
+        fork_branches(st, index, s);
+        return;
+    }
+  }
+}
+
+
+// The number of ways the next step of a running thread can go.
+static int outcome_count(const struct explorer *x, const struct thread *t)
+{
+  switch (t->at->type) {
+    case IFtype:
+    case IFELSEtype:
+      return 2;
+
+    case FORtype:
+    case WHILEtype:
+    case REPEATtype:
+      return t->frames[t->depth - 1].trips >= x->options->trips ? 1 : 2;
+
+    case SWITCHtype:
+      return t->at->case_count + 1;
+
+    default:
+      return 1;
+  }
+}
+
+
+// The k-th of those ways. A condition is tried true first. A loop that
+// has gone around as often as allowed can only stop.
+static int nth_outcome(const struct thread *t, int count, int k)
+{
+  switch (t->at->type) {
+    case SWITCHtype:
+      return k;
+
+    case FORtype:
+    case WHILEtype:
+      return count == 2 && k == 0;
+
+    default:
+      return k == 0;
+  }
+}
+
+
+static void take_step(struct state *st, const struct event *e)
+{
+  struct thread      *t = &st->threads[e->thread];
+  struct statement   *s = e->statement;
+  struct frame       *f = &t->frames[t->depth - 1];
+  struct case_branch *chosen;
+
+  switch (s->type) {
+    case IFtype:
+    case IFELSEtype:
+      if (e->outcome) push_frame(t, s->first, NULL, 0);
+      else if (s->type == IFELSEtype) push_frame(t, s->second, NULL, 0);
+      break;
+
+    case FORtype:
+    case WHILEtype:
+      if (!e->outcome) --t->depth;
+      else {
+        ++f->trips;
+        f->index = 0;
+      }
+      break;
+
+    case REPEATtype:
+      if (e->outcome) --t->depth;
+      else {
+        ++f->trips;
+        f->index = 0;
+      }
+      break;
+
+    case SWITCHtype:
+      chosen = e->outcome < s->case_count ? s->cases[e->outcome] : s->default_case;
+      if (chosen != NULL) push_frame(t, chosen->first, NULL, 0);
+      break;
+
+    default:
+      break;
+  }
+  advance(st, e->thread);
+}
+
+//-----------------------------
+//      Searching
+//-----------------------------
+
+// Compares the order of two threads.
+static int compare_threads(const struct thread *a, const struct thread *b)
+{
+  int i;
+
+  for (i = 0; i < a->key_length && i < b->key_length; ++i) {
+    if (a->key[i] != b->key[i]) return a->key[i] < b->key[i] ? -1 : 1;
+  }
+  return a->key_length - b->key_length;
+}
+
+
+static int interfere(
+  const struct explorer *x, const struct state *st, const struct event *a, const struct event *b)
+{
+  const struct thread *ta = &st->threads[a->thread];
+  const struct thread *tb = &st->threads[b->thread];
+  int shorter = ta->key_length < tb->key_length ? ta->key_length : tb->key_length;
+
+  // The same thread, or one started (perhaps indirectly) by the other.
+  if (memcmp(ta->key, tb->key, shorter * sizeof(int)) == 0) return 1;
+
+  if (a->statement->type != EPtype && b->statement->type != EPtype) return 0;
+  return share_word(&x->words[a->statement->id], &x->words[b->statement->id]);
+}
+
+
+// Would adding e to the steps taken keep them in normal form?
+static int in_normal_form(const struct worker *w, const struct state *st, const struct event *e)
+{
+  int i;
+
+  for (i = w->length - 1; i >= 0; --i) {
+    const struct event *before = &w->sequence[i];
+    if (interfere(w->x, st, before, e)) return 1;
+    if (compare_threads(&st->threads[before->thread], &st->threads[e->thread]) > 0) return 0;
+  }
+  return 1;
+}
+
+
+static void push_event(struct worker *w, const struct event *e)
+{
+  if (w->length == w->capacity) {
+    w->capacity = w->capacity ? 2 * w->capacity : 64;
+    w->sequence = (struct event *)realloc(w->sequence, w->capacity * sizeof(struct event));
+  }
+  w->sequence[w->length++] = *e;
+}
+
+
+static void write_condition(vtc_string *out, struct expression *e, enum operation outer)
+{
+  int parenthesize;
+
+  while (e->op == PASSop) e = e->first;
+  switch (e->op) {
+    case PROMPTop:
+      vtc_string_append(out, e->ep);
+      break;
+
+    case NOTop:
+      vtc_string_appendcharp(out, "NOT ");
+      write_condition(out, e->first, NOTop);
+      break;
+
+    case ANDop:
+    case ORop:
+      parenthesize = outer == NOTop || (outer == ANDop && e->op == ORop);
+      if (parenthesize) vtc_string_appendchar(out, '(');
+      write_condition(out, e->first, e->op);
+      vtc_string_appendcharp(out, e->op == ANDop ? " AND " : " OR ");
+      write_condition(out, e->second, e->op);
+      if (parenthesize) vtc_string_appendchar(out, ')');
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+// The line of a step, with the file if the statement was imported.
+static const char *step_line(char *buffer, size_t size, const struct statement *s)
+{
+  return line_label(buffer, size, s->module, s->type == REPEATtype ? s->end_line : s->line);
+}
+
+
+// The thread is named by its branch numbers, from 1. The line is padded
+// to 'width'.
+static void write_step(vtc_string *out, const struct state *st, const struct event *e, int width)
+{
+  const struct thread *t = &st->threads[e->thread];
+  struct statement    *s = e->statement;
+  char name[32] = "main";
+  char where[300];
+  int  i, used = 0;
+
+  for (i = 1; i < t->key_length && used < (int)sizeof(name) - 12; i += 2) {
+    used += sprintf(name + used, "%s%d", i > 1 ? "." : "", t->key[i] + 1);
+  }
+  vtc_string_appendf(out, "  %-8s %-*s  ", name, width, step_line(where, sizeof(where), s));
+  switch (s->type) {
+    case EPtype:
+      vtc_string_append(out, s->ep);
+      break;
+
+    case SWITCHtype:
+      vtc_string_appendcharp(out, "SWITCH ");
+      vtc_string_append(out, s->ep);
+      vtc_string_appendcharp(out, ": ");
+      if (e->outcome < s->case_count) vtc_string_append(out, s->cases[e->outcome]->case_condition);
+      else vtc_string_appendcharp(out, s->default_case != NULL ? "DEFAULT" : "none");
+      break;
+
+    default:
+      vtc_string_appendcharp(out, s->type == REPEATtype ? "UNTIL " :
+                                  s->type == IFELSEtype ? "IF " : statement_type_name(s->type));
+      if (s->type != REPEATtype && s->type != IFELSEtype) vtc_string_appendchar(out, ' ');
+      write_condition(out, s->conditional, PASSop);
+      vtc_string_appendcharp(out, e->outcome ? ": true" : ": false");
+      break;
+  }
+  vtc_string_appendchar(out, '\n');
+}
+
+
+static void record(struct worker *w, const struct state *st)
+{
+  struct piece *p = w->piece;
+  char where[300];
+  int  width = 5, i, n;
+
+  if ((p->found & (p->found - 1)) == 0) {
+    p->starts = (int *)realloc(p->starts, (p->found ? 2 * p->found : 1) * sizeof(int));
+  }
+  p->starts[p->found++] = vtc_string_length(&p->text);
+  for (i = 0; i < w->length; ++i) {
+    n = (int)strlen(step_line(where, sizeof(where), w->sequence[i].statement));
+    if (n > width) width = n;
+  }
+  for (i = 0; i < w->length; ++i) write_step(&p->text, st, &w->sequence[i], width);
+}
+
+
+static void search(struct worker *w, const struct state *st)
+{
+  const struct explore_options *options = w->x->options;
+  struct state next;
+  struct event e;
+  int i, k, count;
+
+  if (st->threads[0].status == FINISHED) {
+    record(w, st);
+    return;
+  }
+  for (i = 0; i < st->count; ++i) {
+    if (st->threads[i].status != RUNNING) continue;
+    count = outcome_count(w->x, &st->threads[i]);
+    for (k = 0; k < count; ++k) {
+      e.thread    = i;
+      e.statement = st->threads[i].at;
+      e.outcome   = nth_outcome(&st->threads[i], count, k);
+      if (options->reduce && !in_normal_form(w, st, &e)) {
+        w->piece->pruned++;
+        continue;
+      }
+      copy_state(&next, st);
+      take_step(&next, &e);
+      push_event(w, &e);
+      search(w, &next);
+      --w->length;
+      free_state(&next);
+      if (w->piece->found >= options->schedules) return;
+    }
+  }
+}
+
+
+// Sets up the state at the start of the program and takes the steps of a
+// piece's prefix.
+static void replay(struct worker *w, struct state *st, const struct piece *p)
+{
+  int i;
+
+  memset(st, 0, sizeof(struct state));
+  new_thread(st, -1, 0);
+  push_frame(&st->threads[0], w->x->top, NULL, 0);
+  advance(st, 0);
+  w->length = 0;
+  for (i = 0; i < p->length; ++i) {
+    take_step(st, &p->prefix[i]);
+    push_event(w, &p->prefix[i]);
+  }
+}
+
+//-----------------------------
+//      Dividing the work
+//-----------------------------
+
+// Leaves room in the prefix for one more step.
+static void init_piece(struct piece *p, const struct event *prefix, int length)
+{
+  memset(p, 0, sizeof(struct piece));
+  vtc_string_init(&p->text);
+  p->prefix = (struct event *)malloc((length + 1) * sizeof(struct event));
+  if (length > 0) memcpy(p->prefix, prefix, length * sizeof(struct event));
+  p->length = length;
+}
+
+
+// Replaces each piece that isn't a complete schedule with one piece for
+// each step that can follow it, in the order the search would take them.
+// Returns the number of pieces that aren't complete, or -1 if none could
+// be split. Steps skipped by the reduction are counted in 'pruned'.
+//
+static int split_pieces(struct explorer *x, struct worker *w, long *pruned)
+{
+  struct piece *pieces = NULL;
+  struct state  st;
+  struct event  e;
+  int count = 0, open = 0, split = 0;
+  int i, t, k, n;
+
+  for (i = 0; i < x->piece_count; ++i) {
+    struct piece *p = &x->pieces[i];
+
+    replay(w, &st, p);
+    if (st.threads[0].status == FINISHED) {
+      pieces = (struct piece *)realloc(pieces, (count + 1) * sizeof(struct piece));
+      pieces[count++] = *p;
+      free_state(&st);
+      continue;
+    }
+    split = 1;
+    for (t = 0; t < st.count; ++t) {
+      if (st.threads[t].status != RUNNING) continue;
+      n = outcome_count(x, &st.threads[t]);
+      for (k = 0; k < n; ++k) {
+        e.thread    = t;
+        e.statement = st.threads[t].at;
+        e.outcome   = nth_outcome(&st.threads[t], n, k);
+        if (x->options->reduce && !in_normal_form(w, &st, &e)) {
+          ++*pruned;
+          continue;
+        }
+        pieces = (struct piece *)realloc(pieces, (count + 1) * sizeof(struct piece));
+        init_piece(&pieces[count], p->prefix, p->length);
+        pieces[count].prefix[p->length] = e;
+        pieces[count].length = p->length + 1;
+        ++count;
+        ++open;
+      }
+    }
+    vtc_string_destroy(&p->text);
+    free(p->prefix);
+    free_state(&st);
+  }
+  free(x->pieces);
+  x->pieces      = pieces;
+  x->piece_count = count;
+  return split ? open : -1;
+}
+
+
+static void *worker_main(void *arg)
+{
+  struct worker   *w = (struct worker *)arg;
+  struct explorer *x = w->x;
+  struct state     st;
+  int i;
+
+  for (;;) {
+    pthread_mutex_lock(&x->lock);
+    i = x->next_piece++;
+    pthread_mutex_unlock(&x->lock);
+    if (i >= x->piece_count) break;
+
+    w->piece = &x->pieces[i];
+    replay(w, &st, w->piece);
+    search(w, &st);
+    free_state(&st);
+  }
+  return NULL;
+}
+
+//-----------------------------
+//      External Functions
+//-----------------------------
+
+void explore_default_options(struct explore_options *options)
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  options->schedules = 100;
+  options->trips     = 2;
+  options->threads   = cpus > 0 ? (int)cpus : 1;
+  options->reduce    = 1;
+}
+
+
+int explore(
+  struct statement_list        *top,
+  const struct tree_info       *info,
+  const struct explore_options *options)
+{
+  struct explorer x;
+  struct worker  *workers;
+  long shown = 0, pruned = 0;
+  int  more = 0;
+  int  threads = options->threads;
+  int  i, j, open;
+
+  if (top == NULL || options->schedules <= 0 || options->trips < 0) return 0;
+  if (threads < 1) threads = 1;
+
+  memset(&x, 0, sizeof(x));
+  x.options = options;
+  x.top     = top;
+  x.words   = (struct words *)malloc((info->statement_count + 1) * sizeof(struct words));
+  for (i = 0; i < info->statement_count; ++i) collect_words(&x.words[i], info->statements[i]);
+  pthread_mutex_init(&x.lock, NULL);
+
+  workers = (struct worker *)calloc(threads, sizeof(struct worker));
+  for (i = 0; i < threads; ++i) workers[i].x = &x;
+
+  // Split the search until every worker has several pieces to take.
+  x.pieces = (struct piece *)malloc(sizeof(struct piece));
+  init_piece(&x.pieces[0], NULL, 0);
+  x.piece_count = 1;
+  do {
+    open = split_pieces(&x, &workers[0], &pruned);
+  } while (open > 0 && open < PIECES_PER_WORKER * threads);
+
+  // Worker 0 runs on this thread.
+  for (i = 1; i < threads; ++i) {
+    if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) {
+      printf("Unable to start exploration thread %d.\n", i);
+      exit(EXIT_FAILURE);
+    }
+  }
+  worker_main(&workers[0]);
+  for (i = 1; i < threads; ++i) pthread_join(workers[i].thread, NULL);
+
+  for (i = 0; i < x.piece_count; ++i) {
+    struct piece *p = &x.pieces[i];
+    const char   *text = vtc_string_getcharp(&p->text);
+
+    pruned += p->pruned;
+    if (p->found >= options->schedules) more = 1;
+    for (j = 0; j < p->found; ++j) {
+      int end = j + 1 < p->found ? p->starts[j + 1] : vtc_string_length(&p->text);
+      if (shown == options->schedules) {
+        more = 1;
+        break;
+      }
+      printf("\nSchedule %ld:\n%.*s", ++shown, end - p->starts[j], text + p->starts[j]);
+    }
+  }
+
+  printf("\n%ld schedule%s", shown, shown == 1 ? "" : "s");
+  if (more) printf(" shown; there are more");
+  printf(" (loops cut off after %d iteration%s).\n",
+    options->trips, options->trips == 1 ? "" : "s");
+  if (options->reduce && pruned > 0) {
+    printf("%ld step%s skipped as reorderings of steps that don't interfere.\n",
+      pruned, pruned == 1 ? " was" : "s were");
+  }
+
+  for (i = 0; i < x.piece_count; ++i) {
+    vtc_string_destroy(&x.pieces[i].text);
+    free(x.pieces[i].prefix);
+    free(x.pieces[i].starts);
+  }
+  for (i = 0; i < threads; ++i) free(workers[i].sequence);
+  for (i = 0; i < info->statement_count; ++i) free(x.words[i].hashes);
+  free(x.pieces);
+  free(workers);
+  free(x.words);
+  pthread_mutex_destroy(&x.lock);
+  return 1;
+}
@@ -0,0 +1,53 @@
+/****************************************************************************
+FILE          : explore.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the schedule explorer.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The branches of a PARALLEL are logical threads. The executor runs them
+one after another, which is only one of the ways they could be
+interleaved. The explorer finds the others: it runs the program with
+every decision taken both ways (a loop goes around at most a given
+number of times) and every runnable thread allowed to take the next
+step, and reports each schedule it finds as the sequence of actions and
+decisions made, with the thread that made each one.
+
+Most interleavings differ only in the order of steps that can't affect
+each other, and those are reported once (partial-order reduction). Two
+steps of different threads are taken to interfere when one is an action
+and they share a word of four or more letters, other than a few common
+ones: [append to the queue] and [the queue is empty] interfere, while
+[append to the queue] and [close the log] do not. Conditions only look,
+so two conditions never interfere.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef EXPLORE_H
+#define EXPLORE_H
+
+#include "tree.h"
+
+struct explore_options {
+  long schedules;   // Most schedules to report.
+  int  trips;       // Iterations allowed per loop entry.
+  int  threads;     // Worker threads to use.
+  int  reduce;      // Report equivalent interleavings once?
+};
+
+// Fill in default options.
+void explore_default_options(struct explore_options *options);
+
+// Explore the schedules of the program and print them to stdout. Returns
+// zero on failure. The tree must have been through prepare_tree().
+int explore(
+  struct statement_list        *top,
+  const struct tree_info       *info,
+  const struct explore_options *options);
+
+#endif
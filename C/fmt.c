@@ -0,0 +1,1023 @@
+/****************************************************************************
+FILE          : fmt.c
+LAST REVISION : 2026-10-19
+SUBJECT       : The p-code formatter.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Each output line starts with a token whose source line is known (the
+first token of a statement, ELSE, END, UNTIL, CASE or DEFAULT). Comments
+are placed by comparing their source lines with those:
+
+  + A comment that follows a token on its line is written at the end of
+    the output line holding that token. If that line already has one, it
+    is treated like the next kind.
+  + Any other comment is written on a line of its own just before the
+    next output line, indented like the statements at that point.
+  + A blank line is written before an output line (or a comment on its
+    own) if the source has a line with nothing on it since the previous
+    one, but never after a line that opens a block or before one that
+    closes a block.
+
+The tree walker and the streaming formatter share the printer below and
+apply these rules the same way, so they agree. The rules only look at
+things the output preserves, which makes formatting idempotent.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fmt.h"
+#include "outbuf.h"
+#include "parse.h"
+
+extern YYSTYPE yylval;
+extern YYLTYPE yylloc;
+extern int     current_line;
+extern int     yylex(void);
+
+#define INDENT       2   // Spaces per level of nesting.
+#define CONTINUATION 4   // Extra indentation of the later lines of a phrase.
+
+// Properties of an output line.
+#define OPENS  1         // Opens a block: no blank line after it.
+#define CLOSES 2         // Closes a block: no blank line before it.
+
+//-----------------------------
+//      Source layout
+//-----------------------------
+
+// Follows the source lines used by tokens and comments as they go by.
+struct tracker {
+  int last_used;      // Last line holding part of a token or comment.
+  int last_gap;       // Last line seen holding nothing.
+  int token_line;     // Line where the last token ended.
+};
+
+// Note something on lines first..last and return the last empty line
+// before it.
+static int track(struct tracker *t, int first, int last)
+{
+  if (first > t->last_used + 1) t->last_gap = first - 1;
+  if (last > t->last_used) t->last_used = last;
+  return t->last_gap;
+}
+
+struct comment {
+  char *text;
+  int   line;
+  int   gap;          // Last empty line before it.
+  int   trailing;     // Does it follow a token on its line?
+};
+
+//-----------------------------
+//      Printer
+//-----------------------------
+
+struct printer {
+  struct outbuf   out;
+  int             width;
+  int             open;           // Is an output line in progress?
+  int             indent;         // Its level of nesting.
+  int             fresh;          // Nothing written on it yet?
+  char            last;           // Last character written on it.
+  char           *trailing;       // Comment to end it with.
+  struct comment *queue;          // Comments waiting for lines of their own.
+  int             queued;
+  int             capacity;
+  int             started;        // Has anything been printed?
+  int             previous_line;  // Source line of the last thing printed.
+  int             previous_opens; // Did it open a block?
+};
+
+static void printer_open(struct printer *p, FILE *file, int width)
+{
+  out_open(&p->out, file);
+  p->width          = width;
+  p->open           = 0;
+  p->indent         = 0;
+  p->fresh          = 1;
+  p->last           = ' ';
+  p->trailing       = NULL;
+  p->queue          = NULL;
+  p->queued         = 0;
+  p->capacity       = 0;
+  p->started        = 0;
+  p->previous_line  = 0;
+  p->previous_opens = 0;
+}
+
+
+static void blank_line(struct printer *p, int gap, int flags)
+{
+  if (p->started && !(flags & CLOSES) && !p->previous_opens && gap > p->previous_line) {
+    out_newline(&p->out);
+  }
+}
+
+
+static void end_line(struct printer *p)
+{
+  if (!p->open) return;
+  if (p->trailing != NULL) {
+    out_spaces(&p->out, 2);
+    out_write(&p->out, p->trailing, strlen(p->trailing));
+    free(p->trailing);
+    p->trailing = NULL;
+  }
+  out_newline(&p->out);
+  p->open = 0;
+}
+
+
+// Finish the current line and write the waiting comments at the given
+// level of nesting.
+static void flush_comments(struct printer *p, int indent)
+{
+  int i;
+
+  end_line(p);
+  for (i = 0; i < p->queued; ++i) {
+    struct comment *c = &p->queue[i];
+    blank_line(p, c->gap, 0);
+    out_spaces(&p->out, INDENT * indent);
+    out_write(&p->out, c->text, strlen(c->text));
+    out_newline(&p->out);
+    free(c->text);
+    p->started        = 1;
+    p->previous_line  = c->line;
+    p->previous_opens = 0;
+  }
+  p->queued = 0;
+}
+
+
+// Takes ownership of c.text.
+static void add_comment(struct printer *p, struct comment c)
+{
+  if (c.trailing && p->open && p->trailing == NULL) {
+    p->trailing = c.text;
+    return;
+  }
+  if (p->queued == p->capacity) {
+    p->capacity = p->capacity ? 2 * p->capacity : 16;
+    p->queue = (struct comment *)realloc(p->queue, p->capacity * sizeof(struct comment));
+  }
+  p->queue[p->queued++] = c;
+}
+
+
+// Start an output line for a token from source line 'line'. Comments
+// before it are written at level 'context'.
+//
+static void begin_line(
+  struct printer *p, int indent, int context, int line, int gap, int flags)
+{
+  flush_comments(p, context);
+  blank_line(p, gap, flags);
+  out_spaces(&p->out, INDENT * indent);
+  p->open           = 1;
+  p->indent         = indent;
+  p->fresh          = 1;
+  p->started        = 1;
+  p->previous_line  = line;
+  p->previous_opens = flags & OPENS;
+}
+
+
+static int printer_close(struct printer *p)
+{
+  flush_comments(p, 0);
+  free(p->queue);
+  return out_close(&p->out);
+}
+
+
+static void put_word(struct printer *p, const char *word)
+{
+  size_t length = strlen(word);
+
+  if (!p->fresh && p->last != '(' && word[0] != ')' && word[0] != ':' && word[0] != ',') {
+    out_char(&p->out, ' ');
+  }
+  out_write(&p->out, word, length);
+  p->last  = word[length - 1];
+  p->fresh = 0;
+}
+
+
+// Find the next word of a phrase at or after *text. Returns its length
+// (zero if there are no more) and leaves *text pointing at it.
+static size_t next_word(const char **text, const char *end)
+{
+  const char *p = *text, *start;
+
+  while (p < end && isspace((unsigned char)*p)) ++p;
+  start = p;
+  while (p < end && !isspace((unsigned char)*p)) ++p;
+  *text = start;
+  return p - start;
+}
+
+
+// Write a phrase with each run of white space in it made a single space
+// (which doesn't change its meaning; see intern.c), starting new lines
+// between words where it would run past the width.
+//
+static void put_phrase(struct printer *p, vtc_string *phrase)
+{
+  const char *text = vtc_string_getcharp(phrase);
+  const char *end  = text + vtc_string_length(phrase) - 1;   // At the ']'.
+  const char *word;
+  size_t length, total = 2;
+  int    words = 0, space, wrap, continuation;
+
+  for (word = text + 1; (length = next_word(&word, end)) > 0; word += length) {
+    total += length + (words++ > 0);
+  }
+  space = !p->fresh && p->last != '(';
+  wrap  = p->out.column + space + (int)total > p->width;
+  continuation = INDENT * p->indent + CONTINUATION;
+
+  if (space) out_char(&p->out, ' ');
+  out_char(&p->out, '[');
+  words = 0;
+  for (word = text + 1; (length = next_word(&word, end)) > 0; word += length) {
+    if (words++ > 0) {
+      // Leave room for the ']' after the last word.
+      const char *rest = word + length;
+      int closing = next_word(&rest, end) == 0;
+      if (wrap && p->out.column + 1 + (int)length + closing > p->width) {
+        out_newline(&p->out);
+        out_spaces(&p->out, continuation);
+      }
+      else {
+        out_char(&p->out, ' ');
+      }
+    }
+    out_write(&p->out, word, length);
+  }
+  out_char(&p->out, ']');
+  p->last  = ']';
+  p->fresh = 0;
+}
+
+
+static char *copy_comment(const char *text)
+{
+  size_t length = strlen(text);
+  char  *copy;
+
+  while (length > 0 && isspace((unsigned char)text[length - 1])) --length;
+  copy = (char *)malloc(length + 1);
+  memcpy(copy, text, length);
+  copy[length] = '\0';
+  return copy;
+}
+
+//-----------------------------
+//      Formatter state
+//-----------------------------
+
+struct formatter {
+  struct printer  printer;
+  struct tracker  tracker;
+  int             streaming;
+
+  // Used when walking the tree, which is built before anything is
+  // printed: the comments in order, and for each line the last empty
+  // line before the first token on it.
+  struct comment *comments;
+  int             comment_count;
+  int             comment_capacity;
+  int             next_comment;
+  int            *gaps;
+  int             gap_capacity;
+  int             declare;
+  int             import;
+};
+
+// The comment hook has no argument to say which formatter is running.
+static struct formatter *current;
+
+static void note_comment(const char *text, int line)
+{
+  struct formatter *f = current;
+  struct comment c;
+
+  c.gap      = track(&f->tracker, line, line);
+  c.trailing = line == f->tracker.token_line;
+  c.line     = line;
+  c.text     = copy_comment(text);
+  if (f->streaming) {
+    add_comment(&f->printer, c);
+    return;
+  }
+  if (f->comment_count == f->comment_capacity) {
+    f->comment_capacity = f->comment_capacity ? 2 * f->comment_capacity : 64;
+    f->comments = (struct comment *)
+      realloc(f->comments, f->comment_capacity * sizeof(struct comment));
+  }
+  f->comments[f->comment_count++] = c;
+}
+
+
+static int note_token(struct formatter *f, const YYLTYPE *location)
+{
+  int gap = track(&f->tracker, location->first_line, location->last_line);
+
+  f->tracker.token_line = location->last_line;
+  return gap;
+}
+
+
+static void formatter_open(struct formatter *f, FILE *out, int width, int streaming)
+{
+  memset(f, 0, sizeof(struct formatter));
+  printer_open(&f->printer, out, width);
+  f->streaming = streaming;
+  current      = f;
+  comment_hook = note_comment;
+}
+
+
+static int formatter_close(struct formatter *f, int ok)
+{
+  int i;
+
+  comment_hook = NULL;
+  current      = NULL;
+  if (!printer_close(&f->printer)) {
+    fprintf(stderr, "Error writing the formatted program.\n");
+    ok = 0;
+  }
+  for (i = f->next_comment; i < f->comment_count; ++i) free(f->comments[i].text);
+  free(f->comments);
+  free(f->gaps);
+  return ok;
+}
+
+//-----------------------------
+//      Walking the tree
+//-----------------------------
+
+static void observe_token(int token, const YYLTYPE *location, void *data)
+{
+  struct formatter *f = (struct formatter *)data;
+  int line = location->first_line;
+  int gap  = note_token(f, location);
+
+  if (token == DECLARE) f->declare = 1;
+  if (token == IMPORT) f->import = 1;
+  if (line >= f->gap_capacity) {
+    int old = f->gap_capacity;
+    f->gap_capacity = 2 * line + 64;
+    f->gaps = (int *)realloc(f->gaps, f->gap_capacity * sizeof(int));
+    memset(f->gaps + old, 0, (f->gap_capacity - old) * sizeof(int));
+  }
+  f->gaps[line] = gap;
+}
+
+
+// Start the output line for a token on source line 'line', first giving
+// the printer the comments that come before it.
+//
+static void tree_begin(struct formatter *f, int indent, int context, int line, int flags)
+{
+  while (f->next_comment < f->comment_count && f->comments[f->next_comment].line < line) {
+    add_comment(&f->printer, f->comments[f->next_comment++]);
+  }
+  begin_line(&f->printer, indent, context, line, f->gaps[line], flags);
+}
+
+
+static void tree_end(struct formatter *f, int indent, int line)
+{
+  tree_begin(f, indent, indent + 1, line, CLOSES);
+  put_word(&f->printer, "END");
+}
+
+// The expression levels follow the grammar. A PASSop node where a simple
+// expression belongs was written in parentheses.
+
+static void tree_simple(struct printer *p, struct expression *e);
+
+static void tree_and(struct printer *p, struct expression *e)
+{
+  if (e->op == ANDop) {
+    tree_and(p, e->first);
+    put_word(p, "AND");
+    tree_simple(p, e->second);
+  }
+  else {
+    tree_simple(p, e->first);
+  }
+}
+
+
+static void tree_condition(struct printer *p, struct expression *e)
+{
+  if (e->op == ORop) {
+    tree_condition(p, e->first);
+    put_word(p, "OR");
+    tree_and(p, e->second);
+  }
+  else {
+    tree_and(p, e->first);
+  }
+}
+
+
+static void tree_simple(struct printer *p, struct expression *e)
+{
+  switch (e->op) {
+    case NOTop:
+      put_word(p, "NOT");
+      tree_simple(p, e->first);
+      break;
+
+    case PASSop:
+      put_word(p, "(");
+      tree_condition(p, e->first);
+      put_word(p, ")");
+      break;
+
+    case PROMPTop:
+      put_phrase(p, e->ep);
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+static void tree_list(struct formatter *f, struct statement_list *list, int indent);
+
+// The COST of an action or the BOUND of a loop, if it has one.
+static void tree_estimate(struct printer *p, const char *keyword, vtc_string *estimate)
+{
+  if (estimate == NULL) return;
+  put_word(p, keyword);
+  put_phrase(p, estimate);
+}
+
+static void tree_cases(struct formatter *f, struct case_list *cl, int indent)
+{
+  struct case_branch *c;
+
+  // Case lists are left recursive; the first case written is deepest.
+  if (cl == NULL) return;
+  tree_cases(f, cl->first, indent);
+  c = cl->second;
+  tree_begin(f, indent, indent, c->line, OPENS);
+  if (c->case_condition != NULL) {
+    put_word(&f->printer, "CASE");
+    put_phrase(&f->printer, c->case_condition);
+  }
+  else {
+    put_word(&f->printer, "DEFAULT");
+  }
+  put_word(&f->printer, ":");
+  tree_list(f, c->first, indent + 1);
+  tree_end(f, indent, c->end_line);
+}
+
+
+// The branches of a PARALLEL, the first after the PARALLEL itself and
+// the others after an AND.
+static void tree_branches(struct formatter *f, struct case_list *cl, int indent)
+{
+  struct case_branch *c;
+
+  if (cl == NULL) return;
+  tree_branches(f, cl->first, indent);
+  c = cl->second;
+  if (cl->first == NULL) {
+    tree_begin(f, indent, indent, c->line, OPENS);
+    put_word(&f->printer, "PARALLEL");
+  }
+  else {
+    tree_begin(f, indent, indent + 1, c->line, OPENS | CLOSES);
+    put_word(&f->printer, "AND");
+  }
+  tree_list(f, c->first, indent + 1);
+}
+
+
+static void tree_statement(struct formatter *f, struct statement *s, int indent)
+{
+  struct printer *p = &f->printer;
+
+  switch (s->type) {
+    case EPtype:
+      tree_begin(f, indent, indent, s->line, 0);
+      put_phrase(p, s->ep);
+      tree_estimate(p, "COST", s->estimate);
+      break;
+
+    case BREAKtype:
+    case CONTINUEtype:
+    case RETURNtype:
+      tree_begin(f, indent, indent, s->line, 0);
+      put_word(p, statement_type_name(s->type));
+      break;
+
+    case IFtype:
+    case IFELSEtype:
+      tree_begin(f, indent, indent, s->line, OPENS);
+      put_word(p, "IF");
+      tree_condition(p, s->conditional);
+      put_word(p, "THEN");
+      tree_list(f, s->first, indent + 1);
+      if (s->type == IFELSEtype) {
+        tree_begin(f, indent, indent + 1, s->else_line, OPENS | CLOSES);
+        put_word(p, "ELSE");
+        tree_list(f, s->second, indent + 1);
+      }
+      tree_end(f, indent, s->end_line);
+      break;
+
+    case FORtype:
+    case WHILEtype:
+      tree_begin(f, indent, indent, s->line, OPENS);
+      put_word(p, s->type == WHILEtype ? "WHILE" : s->foreach ? "FOREACH" : "FOR");
+      tree_condition(p, s->conditional);
+      tree_estimate(p, "BOUND", s->estimate);
+      put_word(p, "LOOP");
+      tree_list(f, s->first, indent + 1);
+      tree_end(f, indent, s->end_line);
+      break;
+
+    case REPEATtype:
+      tree_begin(f, indent, indent, s->line, OPENS);
+      put_word(p, "REPEAT");
+      tree_list(f, s->first, indent + 1);
+      tree_begin(f, indent, indent + 1, s->end_line, CLOSES);
+      put_word(p, "UNTIL");
+      tree_condition(p, s->conditional);
+      tree_estimate(p, "BOUND", s->estimate);
+      break;
+
+    case SWITCHtype:
+      tree_begin(f, indent, indent, s->line, OPENS);
+      put_word(p, "SWITCH");
+      put_phrase(p, s->ep);
+      tree_cases(f, s->cl, indent + 1);
+      tree_end(f, indent, s->end_line);
+      break;
+
+    case PARALLELtype:
+      tree_branches(f, s->cl, indent);
+      tree_end(f, indent, s->end_line);
+      break;
+  }
+}
+
+
+static void tree_list(struct formatter *f, struct statement_list *list, int indent)
+{
+  int i;
+
+  for (i = 0; i < list->count; ++i) tree_statement(f, list->items[i], indent);
+}
+
+
+int format_tree(FILE *out, int width)
+{
+  struct formatter      f;
+  struct parse_context  context = { NULL, NULL, 1, 1, 1, observe_token, NULL };
+  struct tree_info      info;
+  int ok;
+
+  formatter_open(&f, out, width, 0);
+  context.observer = &f;
+  ok = yyparse(&context) == 0;
+
+  // The imported statements are in the tree in place of the IMPORTs.
+  if (f.import) {
+    fprintf(stderr, "The tree doesn't keep IMPORT directives; use -F to format this program.\n");
+    return formatter_close(&f, 0);
+  }
+  if (!ok) {
+    fprintf(stderr, "Syntax error: [line %d] syntax error\n", context.line);
+    return formatter_close(&f, 0);
+  }
+  if (f.declare) {
+    fprintf(stderr, "The tree doesn't keep DECLARE blocks; use -F to format this program.\n");
+    return formatter_close(&f, 0);
+  }
+  prepare_tree(context.top, &info);
+  tree_list(&f, context.top, 0);
+  while (f.next_comment < f.comment_count) {
+    add_comment(&f.printer, f.comments[f.next_comment++]);
+  }
+  ok = formatter_close(&f, 1);
+  free(info.statements);
+  free(info.expressions);
+  free(info.cases);
+  return ok;
+}
+
+//-----------------------------
+//      Streaming
+//-----------------------------
+
+// What the tokens at the current point belong to.
+enum block_kind {
+  THEN_BLOCK, ELSE_BLOCK, LOOP_BLOCK, REPEAT_BLOCK,
+  SWITCH_BLOCK, CASE_BLOCK, DECLARE_BLOCK, PARALLEL_BLOCK
+};
+
+// Headers of statements, which end at a particular token (or, for UNTIL,
+// after a complete condition).
+enum header_kind {
+  NO_HEADER, IF_HEADER, LOOP_HEADER, UNTIL_HEADER,
+  SWITCH_HEADER, CASE_HEADER, DEFAULT_HEADER, IMPORT_HEADER,
+  BOUND_HEADER, ESTIMATE_HEADER
+};
+
+struct block {
+  enum block_kind kind;
+  int             count;    // Statements (or cases, or types) in it so far.
+};
+
+struct stream {
+  struct formatter  f;
+  struct block     *stack;   // The level of nesting is the depth.
+  int               depth;
+  int               capacity;
+  int               top_count;
+  enum header_kind  header;
+  int               phrase_seen;   // Case headers: has the phrase been seen?
+  int               parentheses;   // In a condition.
+  int               operand;       // Did the condition's last token end an operand?
+  int               of_depth;      // In a DECLARE block: open OF lists.
+  int               after_action;  // May a COST come next?
+};
+
+static void push_block(struct stream *s, enum block_kind kind)
+{
+  if (s->depth == s->capacity) {
+    s->capacity = s->capacity ? 2 * s->capacity : 16;
+    s->stack = (struct block *)realloc(s->stack, s->capacity * sizeof(struct block));
+  }
+  s->stack[s->depth].kind  = kind;
+  s->stack[s->depth].count = 0;
+  ++s->depth;
+}
+
+
+// Count one more item in the innermost block.
+static void count_item(struct stream *s)
+{
+  if (s->depth == 0) ++s->top_count;
+  else ++s->stack[s->depth - 1].count;
+}
+
+
+static void start_condition(struct stream *s, enum header_kind header)
+{
+  s->header      = header;
+  s->parentheses = 0;
+  s->operand     = 0;
+}
+
+
+// Handle a token of a condition. Returns zero if it can't go there.
+static int condition_token(struct stream *s, int token, YYSTYPE *value)
+{
+  struct printer *p = &s->f.printer;
+
+  if (!s->operand) {
+    switch (token) {
+      case EP:  put_phrase(p, value->stringp); s->operand = 1; return 1;
+      case NOT: put_word(p, "NOT"); return 1;
+      case '(': put_word(p, "("); ++s->parentheses; return 1;
+    }
+    return 0;
+  }
+  switch (token) {
+    case AND: put_word(p, "AND"); s->operand = 0; return 1;
+    case OR:  put_word(p, "OR");  s->operand = 0; return 1;
+    case ')':
+      if (s->parentheses == 0) return 0;
+      put_word(p, ")");
+      --s->parentheses;
+      return 1;
+  }
+  return 0;
+}
+
+
+// Is the condition complete (so that the header may end)?
+static int condition_done(const struct stream *s)
+{
+  return s->operand && s->parentheses == 0;
+}
+
+
+// Handle a token that ends a block. Returns zero if it can't go there.
+static int close_block(struct stream *s, int token, int line, int gap)
+{
+  struct printer *p = &s->f.printer;
+  struct block   *b = s->depth > 0 ? &s->stack[s->depth - 1] : NULL;
+
+  if (b == NULL || b->count == 0) return 0;
+  switch (token) {
+    case ELSE:
+      if (b->kind != THEN_BLOCK) return 0;
+      b->kind  = ELSE_BLOCK;
+      b->count = 0;
+      begin_line(p, s->depth - 1, s->depth, line, gap, OPENS | CLOSES);
+      put_word(p, "ELSE");
+      return 1;
+
+    case AND:
+      if (b->kind != PARALLEL_BLOCK) return 0;
+      b->count = 0;
+      begin_line(p, s->depth - 1, s->depth, line, gap, OPENS | CLOSES);
+      put_word(p, "AND");
+      return 1;
+
+    case UNTIL:
+      if (b->kind != REPEAT_BLOCK) return 0;
+      --s->depth;
+      begin_line(p, s->depth, s->depth + 1, line, gap, CLOSES);
+      put_word(p, "UNTIL");
+      start_condition(s, UNTIL_HEADER);
+      return 1;
+
+    case END:
+      if (b->kind == REPEAT_BLOCK) return 0;
+      --s->depth;
+      begin_line(p, s->depth, s->depth + 1, line, gap, CLOSES);
+      put_word(p, "END");
+      return 1;
+  }
+  return 0;
+}
+
+
+// Handle a token in a DECLARE block. Returns zero if it can't go there.
+static int declare_token(struct stream *s, int token, YYSTYPE *value, int line, int gap)
+{
+  struct printer *p = &s->f.printer;
+
+  switch (token) {
+    case TYPE:
+      if (s->of_depth > 0) return 0;
+      count_item(s);
+      begin_line(p, s->depth, s->depth, line, gap, 0);
+      put_word(p, "TYPE");
+      return 1;
+
+    case EP:
+      put_phrase(p, value->stringp);
+      return 1;
+
+    case IS:  put_word(p, "IS"); return 1;
+    case ',': put_word(p, ","); return 1;
+    case ':': put_word(p, ":"); return 1;
+    case OF:  put_word(p, "OF"); ++s->of_depth; return 1;
+
+    case END:
+      if (s->of_depth > 0) {
+        put_word(p, "END");
+        --s->of_depth;
+        return 1;
+      }
+      return close_block(s, token, line, gap);
+  }
+  return 0;
+}
+
+
+// Handle a token where a statement (or case) may start, or a block may
+// end. Returns zero if it can't go there.
+//
+static int statement_token(struct stream *s, int token, YYSTYPE *value, int line, int gap)
+{
+  struct printer *p = &s->f.printer;
+  int after_action = s->after_action;
+
+  s->after_action = 0;
+  if (token == COST) {
+    if (!after_action) return 0;
+    put_word(p, "COST");
+    s->header = ESTIMATE_HEADER;
+    return 1;
+  }
+  if (token == ELSE || token == END || token == UNTIL || token == AND) {
+    return close_block(s, token, line, gap);
+  }
+
+  if (s->depth > 0 && s->stack[s->depth - 1].kind == SWITCH_BLOCK) {
+    if (token != CASE && token != DEFAULT) return 0;
+    count_item(s);
+    begin_line(p, s->depth, s->depth, line, gap, OPENS);
+    put_word(p, token == CASE ? "CASE" : "DEFAULT");
+    s->header      = token == CASE ? CASE_HEADER : DEFAULT_HEADER;
+    s->phrase_seen = 0;
+    return 1;
+  }
+
+  switch (token) {
+    case EP:
+      count_item(s);
+      begin_line(p, s->depth, s->depth, line, gap, 0);
+      put_phrase(p, value->stringp);
+      s->after_action = 1;
+      return 1;
+
+    case BREAK:
+    case CONTINUE:
+    case RETURN:
+      count_item(s);
+      begin_line(p, s->depth, s->depth, line, gap, 0);
+      put_word(p, token == BREAK ? "BREAK" : token == CONTINUE ? "CONTINUE" : "RETURN");
+      return 1;
+
+    case IF:
+    case WHILE:
+    case FOR:
+    case FOREACH:
+      count_item(s);
+      begin_line(p, s->depth, s->depth, line, gap, OPENS);
+      put_word(p, token == IF ? "IF" : token == WHILE ? "WHILE" :
+                  token == FOR ? "FOR" : "FOREACH");
+      start_condition(s, token == IF ? IF_HEADER : LOOP_HEADER);
+      return 1;
+
+    case REPEAT:
+      count_item(s);
+      begin_line(p, s->depth, s->depth, line, gap, OPENS);
+      put_word(p, "REPEAT");
+      push_block(s, REPEAT_BLOCK);
+      return 1;
+
+    case PARALLEL:
+      count_item(s);
+      begin_line(p, s->depth, s->depth, line, gap, OPENS);
+      put_word(p, "PARALLEL");
+      push_block(s, PARALLEL_BLOCK);
+      return 1;
+
+    case SWITCH:
+      count_item(s);
+      begin_line(p, s->depth, s->depth, line, gap, OPENS);
+      put_word(p, "SWITCH");
+      s->header = SWITCH_HEADER;
+      return 1;
+
+    case IMPORT:
+      count_item(s);
+      begin_line(p, s->depth, s->depth, line, gap, 0);
+      put_word(p, "IMPORT");
+      s->header = IMPORT_HEADER;
+      return 1;
+
+    case DECLARE:
+      // Only at the very start of the program.
+      if (s->depth > 0 || s->top_count > 0 || s->f.printer.started) return 0;
+      begin_line(p, 0, 0, line, gap, OPENS);
+      put_word(p, "DECLARE");
+      push_block(s, DECLARE_BLOCK);
+      s->of_depth = 0;
+      return 1;
+  }
+  return 0;
+}
+
+
+// Handle a token of a statement's header. Returns zero if it can't go
+// there.
+static int header_token(struct stream *s, int token, YYSTYPE *value)
+{
+  struct printer *p = &s->f.printer;
+
+  switch (s->header) {
+    case IF_HEADER:
+    case LOOP_HEADER:
+      if (token == (s->header == IF_HEADER ? THEN : LOOP)) {
+        if (!condition_done(s)) return 0;
+        put_word(p, token == THEN ? "THEN" : "LOOP");
+        push_block(s, token == THEN ? THEN_BLOCK : LOOP_BLOCK);
+        s->header = NO_HEADER;
+        return 1;
+      }
+      if (token == BOUND && s->header == LOOP_HEADER && condition_done(s)) {
+        put_word(p, "BOUND");
+        s->header      = BOUND_HEADER;
+        s->phrase_seen = 0;
+        return 1;
+      }
+      return condition_token(s, token, value);
+
+    case BOUND_HEADER:
+      if (!s->phrase_seen) {
+        if (token != EP) return 0;
+        put_phrase(p, value->stringp);
+        s->phrase_seen = 1;
+        return 1;
+      }
+      if (token != LOOP) return 0;
+      put_word(p, "LOOP");
+      push_block(s, LOOP_BLOCK);
+      s->header = NO_HEADER;
+      return 1;
+
+    case UNTIL_HEADER:
+      if (token == BOUND && condition_done(s)) {
+        put_word(p, "BOUND");
+        s->header = ESTIMATE_HEADER;
+        return 1;
+      }
+      return condition_token(s, token, value);
+
+    case SWITCH_HEADER:
+      if (token != EP) return 0;
+      put_phrase(p, value->stringp);
+      push_block(s, SWITCH_BLOCK);
+      s->header = NO_HEADER;
+      return 1;
+
+    case IMPORT_HEADER:
+    case ESTIMATE_HEADER:
+      if (token != EP) return 0;
+      put_phrase(p, value->stringp);
+      s->header = NO_HEADER;
+      return 1;
+
+    case CASE_HEADER:
+      if (!s->phrase_seen) {
+        if (token != EP) return 0;
+        put_phrase(p, value->stringp);
+        s->phrase_seen = 1;
+        return 1;
+      }
+      // Fall through to look for the ':'.
+
+    case DEFAULT_HEADER:
+      if (token != ':') return 0;
+      put_word(p, ":");
+      push_block(s, CASE_BLOCK);
+      s->header = NO_HEADER;
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+
+int format_stream(FILE *out, int width)
+{
+  struct stream s;
+  YYSTYPE value;
+  int     token, gap, line, ok = 1;
+
+  memset(&s, 0, sizeof(struct stream));
+  formatter_open(&s.f, out, width, 1);
+
+  for (;;) {
+    token = yylex();
+    value = yylval;
+    line  = yylloc.first_line;
+
+    // An UNTIL condition ends at the first token that can't continue it.
+    if (s.header == UNTIL_HEADER && condition_done(&s) &&
+        token != AND && token != OR && token != BOUND) {
+      s.header = NO_HEADER;
+    }
+    if (token == 0) break;
+
+    gap = note_token(&s.f, &yylloc);
+    if (s.header != NO_HEADER) {
+      ok = header_token(&s, token, &value);
+    }
+    else if (s.depth > 0 && s.stack[s.depth - 1].kind == DECLARE_BLOCK) {
+      ok = declare_token(&s, token, &value, line, gap);
+    }
+    else {
+      ok = statement_token(&s, token, &value, line, gap);
+    }
+    if (token == EP) {
+      vtc_string_destroy(value.stringp);
+      free(value.stringp);
+    }
+    if (!ok) break;
+  }
+
+  // Everything must be closed at the end.
+  if (ok && (s.depth > 0 || s.header != NO_HEADER || s.top_count == 0)) ok = 0;
+  if (!ok) fprintf(stderr, "Syntax error: [line %d] syntax error\n", current_line);
+  free(s.stack);
+  return formatter_close(&s.f, ok);
+}
@@ -0,0 +1,38 @@
+/****************************************************************************
+FILE          : fmt.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the p-code formatter.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The formatter writes a program back out in a canonical layout: one
+statement per line, two spaces of indentation per level of nesting,
+single spaces between the words of a condition, and long phrases
+re-wrapped to fit the line width. Comments and (single) blank lines are
+kept. Formatting its own output changes nothing.
+
+Both functions read the program from yyin with the Flex scanner. The
+first builds the tree and walks it; the second formats the tokens as they
+arrive and needs memory only in proportion to the depth of nesting. They
+produce the same output, except that only the second handles a DECLARE
+block (the tree doesn't keep one). Both return zero if the program has a
+syntax error or the output can't be written.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdio.h>
+
+#define FORMAT_WIDTH 80
+
+int format_tree(FILE *out, int width);
+int format_stream(FILE *out, int width);
+
+#endif
@@ -0,0 +1,361 @@
+/****************************************************************************
+FILE          : gen.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Translation of p-code into C.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The only statements that don't map directly onto C are BREAK and
+CONTINUE inside a SWITCH, because in C they would apply to the switch
+statement. Those become jumps to labels placed at the end of the loop
+body (for CONTINUE) and just after the loop (for BREAK). A BREAK or
+CONTINUE outside of any loop ends the program as it does in the
+interpreter. The branches of a PARALLEL run one after another, as they
+do in the interpreter; one that leaves its branch ends the branch.
+
+The statements at the top level are divided among several functions so
+that a large program doesn't become one enormous function, which
+compilers handle badly. Nothing can jump between top level statements,
+so this is always possible.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdlib.h>
+#include "gen.h"
+
+// About this many statements go in each function.
+#define PART_SIZE 2000
+
+struct loop {
+  int id;             // Statement ID, used to name its labels.
+  int switches;       // SWITCH statements entered since the loop.
+  int break_used;     // Are its labels needed?
+  int continue_used;
+  int branch;         // A branch of a PARALLEL (id is then its case ID)?
+};
+
+struct generator {
+  FILE        *out;
+  struct loop *loops;
+  int          depth;
+  int          capacity;
+};
+
+static void indent_line(struct generator *g, int indent)
+{
+  fprintf(g->out, "%*s", 2 * indent, "");
+}
+
+
+// Write a phrase as a C string literal. Characters that could be
+// misread (including '?', because of trigraphs) are escaped.
+//
+static void write_literal(struct generator *g, vtc_string *phrase)
+{
+  const unsigned char *p = (const unsigned char *)vtc_string_getcharp(phrase);
+
+  putc('"', g->out);
+  for (; *p != '\0'; ++p) {
+    switch (*p) {
+      case '\\': fputs("\\\\", g->out); break;
+      case '"':  fputs("\\\"", g->out); break;
+      case '?':  fputs("\\?", g->out);  break;
+      case '\n': fputs("\\n", g->out);  break;
+      case '\t': fputs("\\t", g->out);  break;
+      default:
+        if (*p < ' ' || *p >= 0x7F) fprintf(g->out, "\\%03o", *p);
+        else putc(*p, g->out);
+        break;
+    }
+  }
+  putc('"', g->out);
+}
+
+
+// Write a condition. The interpreter evaluates AND and OR with short
+// circuits, as C does. At the outermost level no parentheses are needed.
+//
+static void write_expression(struct generator *g, struct expression *e, int outer)
+{
+  switch (e->op) {
+    case PASSop:
+      write_expression(g, e->first, outer);
+      break;
+
+    case NOTop:
+      putc('!', g->out);
+      write_expression(g, e->first, 0);
+      break;
+
+    case ANDop:
+    case ORop:
+      if (!outer) putc('(', g->out);
+      write_expression(g, e->first, 0);
+      fputs(e->op == ANDop ? " && " : " || ", g->out);
+      write_expression(g, e->second, 0);
+      if (!outer) putc(')', g->out);
+      break;
+
+    case PROMPTop:
+      fputs("pc_condition(", g->out);
+      write_literal(g, e->ep);
+      putc(')', g->out);
+      break;
+  }
+}
+
+
+static struct loop *enter_loop(struct generator *g, int id)
+{
+  struct loop *loop;
+
+  if (g->depth == g->capacity) {
+    g->capacity = g->capacity ? 2 * g->capacity : 16;
+    g->loops = (struct loop *)realloc(g->loops, g->capacity * sizeof(struct loop));
+  }
+  loop = &g->loops[g->depth++];
+  loop->id            = id;
+  loop->switches      = 0;
+  loop->break_used    = 0;
+  loop->continue_used = 0;
+  loop->branch        = 0;
+  return loop;
+}
+
+
+// BREAK and CONTINUE.
+static void write_jump(struct generator *g, int is_break)
+{
+  struct loop *loop = g->depth > 0 ? &g->loops[g->depth - 1] : NULL;
+
+  if (loop == NULL) {
+    fprintf(g->out, "return %s;\n", is_break ? "PC_BREAK" : "PC_CONTINUE");
+  }
+  else if (loop->branch) {
+    // Either one just ends the branch.
+    if (loop->switches > 0) {
+      fprintf(g->out, "goto branch_%d;\n", loop->id);
+      loop->break_used = 1;
+    }
+    else {
+      fputs("break;\n", g->out);
+    }
+  }
+  else if (loop->switches > 0) {
+    fprintf(g->out, "goto %s_%d;\n", is_break ? "break" : "continue", loop->id);
+    if (is_break) loop->break_used = 1;
+    else loop->continue_used = 1;
+  }
+  else {
+    fprintf(g->out, "%s;\n", is_break ? "break" : "continue");
+  }
+}
+
+
+static void write_list(struct generator *g, struct statement_list *list, int indent);
+
+// The runtime offers one menu of the CASE branches (see execute_switch())
+// and returns the number chosen, or zero for none, which selects the
+// DEFAULT.
+//
+static void write_switch(struct generator *g, struct statement *s, int indent)
+{
+  int i;
+
+  indent_line(g, indent);
+  fputs("{\n", g->out);
+  if (s->case_count > 0) {
+    indent_line(g, indent + 1);
+    fputs("static const char *const cases[] = {\n", g->out);
+    for (i = 0; i < s->case_count; ++i) {
+      indent_line(g, indent + 2);
+      write_literal(g, s->cases[i]->case_condition);
+      fputs(i + 1 < s->case_count ? ",\n" : "\n", g->out);
+    }
+    indent_line(g, indent + 1);
+    fputs("};\n", g->out);
+  }
+  indent_line(g, indent + 1);
+  fputs("switch (pc_switch(", g->out);
+  write_literal(g, s->ep);
+  fprintf(g->out, ", %d, %s)) {\n", s->case_count, s->case_count > 0 ? "cases" : "0");
+
+  if (g->depth > 0) ++g->loops[g->depth - 1].switches;
+  for (i = 0; i <= s->case_count; ++i) {
+    struct case_branch *branch = i < s->case_count ? s->cases[i] : s->default_case;
+    if (branch == NULL) break;
+    indent_line(g, indent + 2);
+    if (i < s->case_count) fprintf(g->out, "case %d:\n", i + 1);
+    else fputs("default:\n", g->out);
+    write_list(g, branch->first, indent + 3);
+    indent_line(g, indent + 3);
+    fputs("break;\n", g->out);
+  }
+  if (g->depth > 0) --g->loops[g->depth - 1].switches;
+  indent_line(g, indent + 1);
+  fputs("}\n", g->out);
+  indent_line(g, indent);
+  fputs("}\n", g->out);
+}
+
+
+// Each branch of a PARALLEL is a do ... while (0), which a BREAK or
+// CONTINUE can leave.
+static void write_parallel(struct generator *g, struct statement *s, int indent)
+{
+  int i;
+
+  for (i = 0; i < s->case_count; ++i) {
+    enter_loop(g, s->cases[i]->id)->branch = 1;
+    indent_line(g, indent);
+    fputs("do {\n", g->out);
+    write_list(g, s->cases[i]->first, indent + 1);
+    indent_line(g, indent);
+    fputs("} while (0);\n", g->out);
+    if (g->loops[g->depth - 1].break_used) {
+      indent_line(g, indent);
+      fprintf(g->out, "branch_%d: ;\n", s->cases[i]->id);
+    }
+    --g->depth;
+  }
+}
+
+
+static void write_loop_end(struct generator *g, struct statement *s, int indent)
+{
+  struct loop *loop = &g->loops[g->depth - 1];
+
+  if (loop->continue_used) {
+    indent_line(g, indent + 1);
+    fprintf(g->out, "continue_%d: ;\n", loop->id);
+  }
+  indent_line(g, indent);
+  if (s->type == REPEATtype) {
+    fputs("} while (!", g->out);
+    write_expression(g, s->conditional, 0);
+    fputs(");\n", g->out);
+  }
+  else {
+    fputs("}\n", g->out);
+  }
+  if (loop->break_used) {
+    indent_line(g, indent);
+    fprintf(g->out, "break_%d: ;\n", loop->id);
+  }
+  --g->depth;
+}
+
+
+static void write_statement(struct generator *g, struct statement *s, int indent)
+{
+  switch (s->type) {
+    case EPtype:
+      indent_line(g, indent);
+      fputs("pc_action(", g->out);
+      write_literal(g, s->ep);
+      fputs(");\n", g->out);
+      break;
+
+    case BREAKtype:
+    case CONTINUEtype:
+      indent_line(g, indent);
+      write_jump(g, s->type == BREAKtype);
+      break;
+
+    case RETURNtype:
+      indent_line(g, indent);
+      fputs("pc_return();\n", g->out);
+      break;
+
+    case IFtype:
+    case IFELSEtype:
+      indent_line(g, indent);
+      fputs("if (", g->out);
+      write_expression(g, s->conditional, 1);
+      fputs(") {\n", g->out);
+      write_list(g, s->first, indent + 1);
+      if (s->type == IFELSEtype) {
+        indent_line(g, indent);
+        fputs("}\n", g->out);
+        indent_line(g, indent);
+        fputs("else {\n", g->out);
+        write_list(g, s->second, indent + 1);
+      }
+      indent_line(g, indent);
+      fputs("}\n", g->out);
+      break;
+
+    case FORtype:
+    case WHILEtype:
+      enter_loop(g, s->id);
+      indent_line(g, indent);
+      fputs("while (", g->out);
+      write_expression(g, s->conditional, 1);
+      fputs(") {\n", g->out);
+      write_list(g, s->first, indent + 1);
+      write_loop_end(g, s, indent);
+      break;
+
+    case REPEATtype:
+      enter_loop(g, s->id);
+      indent_line(g, indent);
+      fputs("do {\n", g->out);
+      write_list(g, s->first, indent + 1);
+      write_loop_end(g, s, indent);
+      break;
+
+    case SWITCHtype:
+      write_switch(g, s, indent);
+      break;
+
+    case PARALLELtype:
+      write_parallel(g, s, indent);
+      break;
+  }
+}
+
+
+static void write_list(struct generator *g, struct statement_list *list, int indent)
+{
+  int i;
+
+  for (i = 0; i < list->count; ++i) write_statement(g, list->items[i], indent);
+}
+
+
+int generate_c(
+  struct statement_list *top, const struct tree_info *info, const char *source, FILE *out)
+{
+  struct generator g = { out, NULL, 0, 0 };
+  int parts = 0, first, last, size, i;
+
+  fprintf(out, "/* Generated by pcode from %s. Build it with pcrt.c. */\n\n", source);
+  fprintf(out, "#include \"pcrt.h\"\n");
+
+  // Each part is a run of top level statements.
+  for (first = 0; first < top->count; first = last) {
+    size = 0;
+    for (last = first; last < top->count && size < PART_SIZE; ++last) {
+      int next = last + 1 < top->count ? top->items[last + 1]->id : info->statement_count;
+      size += next - top->items[last]->id;
+    }
+    fprintf(out, "\nstatic enum pc_result part_%d(void)\n{\n", parts++);
+    for (i = first; i < last; ++i) write_statement(&g, top->items[i], 1);
+    fprintf(out, "  return PC_NORMAL;\n}\n");
+  }
+
+  fprintf(out, "\nenum pc_result pc_program(void)\n{\n");
+  fprintf(out, "  enum pc_result result;\n\n");
+  for (i = 0; i < parts; ++i) {
+    fprintf(out, "  if ((result = part_%d()) != PC_NORMAL) return result;\n", i);
+  }
+  fprintf(out, "  return PC_NORMAL;\n}\n");
+
+  free(g.loops);
+  return !ferror(out);
+}
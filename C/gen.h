@@ -0,0 +1,34 @@
+/****************************************************************************
+FILE          : gen.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the C code generator.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The generator translates a program into a C translation unit that
+defines pc_program() for the runtime in pcrt.c. Loops become while and
+do-while loops, IF statements become if statements, SWITCH statements
+become switch statements, and each phrase becomes a call into the
+runtime, which gets the answer from its answer provider. The compiled
+program behaves exactly as execute_statement_list() does with the same
+answers.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef GEN_H
+#define GEN_H
+
+#include <stdio.h>
+#include "tree.h"
+
+// Write the C version of a prepared tree. The source name is only used
+// in a comment. Returns zero if the output can't be written.
+int generate_c(
+  struct statement_list *top, const struct tree_info *info, const char *source, FILE *out);
+
+#endif
@@ -0,0 +1,163 @@
+/****************************************************************************
+FILE          : intern.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Implementation of the phrase table.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The table is an open addressing hash table keyed on a normalized form of
+each phrase. Normalization folds letters to lower case and collapses
+each run of white space (including line breaks inside long phrases) to a
+single space. White space just inside the brackets is dropped.
+
+The table is filled while the tree is prepared and only read after that.
+It is not safe to add phrases from several threads at once.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+
+struct phrase_entry {
+  char         *key;      // Normalized text.
+  char         *text;     // Text as first seen.
+  unsigned long hash;
+};
+
+static struct phrase_entry *entries  = NULL;   // Indexed by phrase ID.
+static int                  count    = 0;
+static int                  capacity = 0;
+static int                 *slots    = NULL;   // Hash slots holding ID+1.
+static int                  slot_count = 0;
+
+
+// Build the normalized key for a phrase. The caller frees the result.
+static char *normalize(const char *text, int length)
+{
+  char *key = (char *)malloc(length + 1);
+  int   in_space = 0;
+  int   i, j = 0;
+
+  for (i = 0; i < length; ++i) {
+    unsigned char ch = (unsigned char)text[i];
+    if (isspace(ch)) {
+      in_space = 1;
+      continue;
+    }
+    if (in_space && j > 0 && key[j - 1] != '[' && ch != ']') key[j++] = ' ';
+    in_space = 0;
+    key[j++] = (char)tolower(ch);
+  }
+  key[j] = '\0';
+  return key;
+}
+
+
+static unsigned long hash_key(const char *key)
+{
+  unsigned long h = 2166136261UL;
+
+  while (*key) {
+    h ^= (unsigned char)*key++;
+    h *= 16777619UL;
+  }
+  return h;
+}
+
+
+// Locate the slot for a key. Returns the slot index; the slot is either
+// empty or holds the matching phrase.
+static int find_slot(const char *key, unsigned long hash)
+{
+  int i = (int)(hash & (slot_count - 1));
+
+  while (slots[i] != 0) {
+    struct phrase_entry *e = &entries[slots[i] - 1];
+    if (e->hash == hash && strcmp(e->key, key) == 0) break;
+    i = (i + 1) & (slot_count - 1);
+  }
+  return i;
+}
+
+
+static void grow_slots(void)
+{
+  int new_count = slot_count ? 2 * slot_count : 256;
+  int id;
+
+  free(slots);
+  slots      = (int *)calloc(new_count, sizeof(int));
+  slot_count = new_count;
+  for (id = 0; id < count; ++id) {
+    slots[find_slot(entries[id].key, entries[id].hash)] = id + 1;
+  }
+}
+
+
+int intern_phrase(const char *text, int length)
+{
+  char         *key;
+  unsigned long hash;
+  int           slot;
+
+  if (2 * (count + 1) > slot_count) grow_slots();
+
+  key  = normalize(text, length);
+  hash = hash_key(key);
+  slot = find_slot(key, hash);
+  if (slots[slot] != 0) {
+    free(key);
+    return slots[slot] - 1;
+  }
+
+  if (count == capacity) {
+    capacity = capacity ? 2 * capacity : 256;
+    entries  = (struct phrase_entry *)
+      realloc(entries, capacity * sizeof(struct phrase_entry));
+  }
+  entries[count].key  = key;
+  entries[count].hash = hash;
+  entries[count].text = (char *)malloc(length + 1);
+  memcpy(entries[count].text, text, length);
+  entries[count].text[length] = '\0';
+  slots[slot] = ++count;
+  return count - 1;
+}
+
+
+int lookup_phrase(const char *text, int length)
+{
+  char *key;
+  int   slot;
+
+  if (slot_count == 0) return -1;
+  key  = normalize(text, length);
+  slot = find_slot(key, hash_key(key));
+  free(key);
+  return slots[slot] - 1;
+}
+
+
+const char *phrase_text(int id)
+{
+  return entries[id].text;
+}
+
+
+const char *phrase_key(int id)
+{
+  return entries[id].key;
+}
+
+
+int phrase_count(void)
+{
+  return count;
+}
@@ -0,0 +1,42 @@
+/****************************************************************************
+FILE          : intern.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the phrase table.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Every English phrase in the program is entered into a single table and
+given a small integer ID. Two phrases that differ only in letter case or
+in the amount of white space between words receive the same ID. This
+allows analysis passes to keep per-phrase information in simple arrays
+instead of comparing strings over and over.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef INTERN_H
+#define INTERN_H
+
+#include "vtcstr.h"
+
+// Enter a phrase into the table (if necessary) and return its ID.
+int intern_phrase(const char *text, int length);
+
+// Return the ID of an existing phrase or -1 if it is not in the table.
+int lookup_phrase(const char *text, int length);
+
+// Return the text of a phrase as it was first seen.
+const char *phrase_text(int id);
+
+// Return the normalized text of a phrase: lower case, with single spaces
+// between words and none just inside the brackets.
+const char *phrase_key(int id);
+
+// Return the number of distinct phrases in the table.
+int phrase_count(void);
+
+#endif
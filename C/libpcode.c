@@ -0,0 +1,344 @@
+/****************************************************************************
+FILE          : libpcode.c
+LAST REVISION : 2026-10-19
+SUBJECT       : The p-code library.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+This file implements the functions declared in libpcode.h. Programs are
+always parsed with the hand written scanner, so the Flex scanner's
+globals are never used. The executor here is a small one of its own: the
+interactive executor in tree.c keeps its position, budgets and answer
+memory in globals and talks to the terminal, none of which a library
+caller wants. Nor does it need phrase IDs, so trees are prepared with
+number_tree() and a parse adds nothing to the process-wide phrase table.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libpcode.h"
+#include "module.h"
+#include "parse.h"
+
+struct pcode_program {
+  struct statement_list *top;
+  struct tree_info       info;
+  char                  *name;    // As given to the parse (may be NULL).
+  const char           **files;   // The file of each statement, by statement ID.
+  const char          ***cases;   // The CASE phrases of each SWITCH, by statement ID.
+};
+
+static void set_error(
+  struct pcode_error *error, enum pcode_status status, const char *file, int line,
+  const char *message)
+{
+  if (error == NULL) return;
+  error->status = status;
+  error->line   = line;
+  snprintf(error->file, sizeof(error->file), "%s", file != NULL ? file : "");
+  snprintf(error->message, sizeof(error->message), "%s", message);
+}
+
+//-----------------------------
+//      Parsing
+//-----------------------------
+
+struct parse_errors {
+  struct pcode_error *error;
+  const char         *name;   // The program's (the parse context's file).
+  int                 count;
+};
+
+// Keeps the first error. Any later ones (such as "x.pcd has errors" from
+// each file importing a bad one) follow from it. A syntax error in an
+// imported file makes the import fail; the file and line still say where
+// the error is.
+static void report(
+  enum parse_problem problem, const char *file, int line, const char *message, void *data)
+{
+  struct parse_errors *errors = (struct parse_errors *)data;
+
+  if (errors->count++ > 0) return;
+  set_error(errors->error,
+    problem == SYNTAX_PROBLEM && file == errors->name ? PCODE_SYNTAX_ERROR : PCODE_IMPORT_ERROR,
+    file, line, message);
+}
+
+
+static struct pcode_program *parse(
+  struct scanner *scanner, const char *name, struct pcode_error *error)
+{
+  struct pcode_program *program;
+  struct parse_context  context;
+  struct parse_errors   errors = { error, name, 0 };
+  int i, j;
+
+  memset(&context, 0, sizeof(context));
+  context.scanner       = scanner;
+  context.line          = 1;
+  context.allow_declare = 1;
+  context.file          = name;
+  context.report        = report;
+  context.reporter      = &errors;
+  if (yyparse(&context) != 0) {
+    if (errors.count == 0) set_error(error, PCODE_SYNTAX_ERROR, name, context.line, "syntax error");
+    return NULL;
+  }
+
+  program = (struct pcode_program *)malloc(sizeof(struct pcode_program));
+  program->top = context.top;
+  number_tree(program->top, &program->info);
+
+  program->name  = name != NULL ? strdup(name) : NULL;
+  program->files =
+    (const char **)malloc((program->info.statement_count + 1) * sizeof(const char *));
+  program->cases =
+    (const char ***)calloc(program->info.statement_count, sizeof(const char **));
+  for (i = 0; i < program->info.statement_count; ++i) {
+    struct statement *s = program->info.statements[i];
+    program->files[i] = s->module != 0 ? module_name(s->module) : program->name;
+    if (s->type != SWITCHtype || s->case_count == 0) continue;
+    program->cases[i] = (const char **)malloc(s->case_count * sizeof(const char *));
+    for (j = 0; j < s->case_count; ++j) {
+      program->cases[i][j] = vtc_string_getcharp(s->cases[j]->case_condition);
+    }
+  }
+  set_error(error, PCODE_OK, NULL, 0, "");
+  return program;
+}
+
+
+struct pcode_program *pcode_parse_buffer(
+  const char *text, size_t length, const char *name, struct pcode_error *error)
+{
+  struct pcode_program *program;
+  struct scanner scanner;
+  char *padded;
+
+  // The scanner reads a little past the end of its text.
+  if ((padded = (char *)malloc(length + SCAN_PADDING)) == NULL) {
+    set_error(error, PCODE_UNREADABLE, name, 0, "Not enough memory for the text.");
+    return NULL;
+  }
+  memcpy(padded, text, length);
+  memset(padded + length, 0, SCAN_PADDING);
+  scanner_init(&scanner, padded, length, 1);
+  program = parse(&scanner, name, error);
+  scanner_close(&scanner);
+  free(padded);
+  return program;
+}
+
+
+struct pcode_program *pcode_parse_file(const char *path, struct pcode_error *error)
+{
+  struct pcode_program *program;
+  struct scanner scanner;
+  FILE *in;
+  int   ok;
+
+  if ((in = fopen(path, "r")) == NULL) {
+    set_error(error, PCODE_UNREADABLE, path, 0, "Unable to open the file.");
+    return NULL;
+  }
+  ok = scanner_read(&scanner, in);
+  fclose(in);
+  if (!ok) {
+    set_error(error, PCODE_UNREADABLE, path, 0, "Unable to read the file.");
+    return NULL;
+  }
+  program = parse(&scanner, path, error);
+  scanner_close(&scanner);
+  return program;
+}
+
+
+void pcode_free(struct pcode_program *program)
+{
+  int i;
+
+  if (program == NULL) return;
+  for (i = 0; i < program->info.statement_count; ++i) free(program->cases[i]);
+  free(program->cases);
+  free(program->files);
+  free(program->name);
+  free_tree(program->top, &program->info);
+  free(program);
+}
+
+//-----------------------------
+//      Running
+//-----------------------------
+
+enum outcome { GO_ON, BROKE, CONTINUED, STOPPED };
+
+struct run {
+  const struct pcode_program   *program;
+  const struct pcode_callbacks *callbacks;
+};
+
+// Returns 0 or 1, or PCODE_STOP. The expression is part of the condition
+// of statement s.
+static int evaluate(const struct run *r, struct expression *e, const struct statement *s)
+{
+  int result;
+
+  switch (e->op) {
+    case PASSop:
+      return evaluate(r, e->first, s);
+
+    case NOTop:
+      result = evaluate(r, e->first, s);
+      return result == PCODE_STOP ? result : !result;
+
+    case PROMPTop:
+      if (r->callbacks->condition == NULL) return 0;
+      result = r->callbacks->condition(r->callbacks->data, vtc_string_getcharp(e->ep),
+        r->program->files[s->id], s->line);
+      return result < 0 ? PCODE_STOP : result != 0;
+
+    case ANDop:
+    case ORop:
+      // An AND stops at the first false operand, an OR at the first true.
+      result = evaluate(r, e->first, s);
+      if (result == PCODE_STOP || result == (e->op == ORop)) return result;
+      return evaluate(r, e->second, s);
+  }
+  return 0;
+}
+
+
+static enum outcome run_list(const struct run *r, struct statement_list *list);
+
+static enum outcome run_loop(const struct run *r, struct statement *s)
+{
+  enum outcome outcome;
+  int test;
+
+  for (;;) {
+    if (s->type != REPEATtype) {
+      if ((test = evaluate(r, s->conditional, s)) == PCODE_STOP) return STOPPED;
+      if (!test) break;
+    }
+    outcome = run_list(r, s->first);
+    if (outcome == STOPPED) return STOPPED;
+    if (outcome == BROKE) break;
+    if (s->type == REPEATtype) {
+      if ((test = evaluate(r, s->conditional, s)) == PCODE_STOP) return STOPPED;
+      if (test) break;
+    }
+  }
+  return GO_ON;
+}
+
+
+static enum outcome run_switch(const struct run *r, struct statement *s)
+{
+  struct case_branch *chosen = s->default_case;
+  int choice = 0;
+
+  if (s->case_count > 0 && r->callbacks->choice != NULL) {
+    choice = r->callbacks->choice(r->callbacks->data, vtc_string_getcharp(s->ep),
+      r->program->cases[s->id], s->case_count, r->program->files[s->id], s->line);
+  }
+  if (choice < 0) return STOPPED;
+  if (choice >= 1 && choice <= s->case_count) chosen = s->cases[choice - 1];
+  return chosen != NULL ? run_list(r, chosen->first) : GO_ON;
+}
+
+
+static enum outcome run_statement(const struct run *r, struct statement *s)
+{
+  int test, i;
+
+  switch (s->type) {
+    case EPtype:
+      if (r->callbacks->action != NULL &&
+          r->callbacks->action(r->callbacks->data, vtc_string_getcharp(s->ep),
+            r->program->files[s->id], s->line) != 0) {
+        return STOPPED;
+      }
+      return GO_ON;
+
+    case BREAKtype:
+      return BROKE;
+
+    case CONTINUEtype:
+      return CONTINUED;
+
+    case RETURNtype:
+      return GO_ON;
+
+    case IFtype:
+    case IFELSEtype:
+      if ((test = evaluate(r, s->conditional, s)) == PCODE_STOP) return STOPPED;
+      if (test) return run_list(r, s->first);
+      if (s->type == IFELSEtype) return run_list(r, s->second);
+      return GO_ON;
+
+    case FORtype:
+    case WHILEtype:
+    case REPEATtype:
+      return run_loop(r, s);
+
+    case SWITCHtype:
+      return run_switch(r, s);
+
+    case PARALLELtype:
+      // One branch after another. A BREAK or CONTINUE ends its branch.
+      for (i = 0; i < s->case_count; ++i) {
+        if (run_list(r, s->cases[i]->first) == STOPPED) return STOPPED;
+      }
+      return GO_ON;
+  }
+  return GO_ON;
+}
+
+
+static enum outcome run_list(const struct run *r, struct statement_list *list)
+{
+  enum outcome outcome;
+  int i;
+
+  for (i = 0; i < list->count; ++i) {
+    if ((outcome = run_statement(r, list->items[i])) != GO_ON) return outcome;
+  }
+  return GO_ON;
+}
+
+
+enum pcode_status pcode_run(
+  const struct pcode_program *program,
+  const struct pcode_callbacks *callbacks,
+  struct pcode_error *error)
+{
+  struct run r;
+
+  r.program   = program;
+  r.callbacks = callbacks;
+  switch (run_list(&r, program->top)) {
+    case GO_ON:
+      set_error(error, PCODE_OK, NULL, 0, "");
+      return PCODE_OK;
+
+    case STOPPED:
+      set_error(error, PCODE_STOPPED, NULL, 0, "Stopped by a callback.");
+      return PCODE_STOPPED;
+
+    case BROKE:
+      set_error(error, PCODE_STRAY_JUMP, NULL, 0, "BREAK without an enclosing loop.");
+      return PCODE_STRAY_JUMP;
+
+    case CONTINUED:
+      set_error(error, PCODE_STRAY_JUMP, NULL, 0, "CONTINUE without an enclosing loop.");
+      return PCODE_STRAY_JUMP;
+  }
+  return PCODE_OK;
+}
@@ -0,0 +1,112 @@
+/****************************************************************************
+FILE          : libpcode.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Public interface to the p-code library.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The library (libpcode.a or libpcode.so, see the Makefile) lets another
+program parse and run p-code without starting the interpreter. This is
+the only header such a program needs; everything else in the library is
+hidden.
+
+A program is parsed from a buffer or a file into a handle. Running it
+calls back into the caller for each action, each phrase of a condition
+and each SWITCH, so the caller decides the answers (from a person, a
+table, a model of the system) and sees what was done. Nothing is read
+from standard input or written to standard output. Errors are returned
+in a struct pcode_error rather than printed.
+
+A parsed program isn't changed by running it, so one program may be run
+by several threads at once. Parsing may also be done on several threads.
+Files brought in by IMPORT are kept for the life of the process (see
+module.h in the sources).
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef LIBPCODE_H
+#define LIBPCODE_H
+
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define PCODE_API __attribute__((visibility("default")))
+#else
+#define PCODE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum pcode_status {
+  PCODE_OK,
+  PCODE_UNREADABLE,      // The file can't be read.
+  PCODE_SYNTAX_ERROR,
+  PCODE_IMPORT_ERROR,    // An imported file is missing, has errors or is part of a cycle.
+  PCODE_STOPPED,         // A callback stopped the run.
+  PCODE_STRAY_JUMP       // A BREAK or CONTINUE outside of any loop ended the run.
+};
+
+struct pcode_error {
+  enum pcode_status status;
+  int               line;          // Zero if the error isn't about a line.
+  char              file[256];     // File holding that line ("" if unnamed).
+  char              message[256];
+};
+
+// Return this from a condition or choice callback to stop the run.
+#define PCODE_STOP (-1)
+
+// Phrases are passed as written, brackets included. The file and line
+// are those of the statement: the file is the program's name (which may
+// be NULL) or, for a statement brought in by IMPORT, the path of the
+// imported file. A missing callback is taken to do nothing, answer
+// false, or choose no case.
+struct pcode_callbacks {
+
+  // An action. Returns nonzero to stop the run.
+  int (*action)(void *data, const char *phrase, const char *file, int line);
+
+  // A phrase of the condition of the statement at 'line'. Returns 1 for
+  // true, 0 for false or PCODE_STOP.
+  int (*condition)(void *data, const char *phrase, const char *file, int line);
+
+  // A SWITCH. Returns the number (from 1) of the case that applies, 0 if
+  // none does (the DEFAULT, if any, is run), or PCODE_STOP.
+  int (*choice)(void *data, const char *phrase, const char *const *cases, int count,
+    const char *file, int line);
+
+  void *data;   // Passed to every callback.
+};
+
+struct pcode_program;
+
+// Parse a program. The name of a buffer (which may be NULL) is used in
+// errors and to find the files it imports. Returns NULL and fills in the
+// error (if it isn't NULL) if the program can't be parsed.
+PCODE_API struct pcode_program *pcode_parse_buffer(
+  const char *text, size_t length, const char *name, struct pcode_error *error);
+
+PCODE_API struct pcode_program *pcode_parse_file(const char *path, struct pcode_error *error);
+
+// Run a program from the start. The error (if it isn't NULL) is filled in
+// when the result isn't PCODE_OK. RETURN statements are ignored, as the
+// simulator does. The branches of a PARALLEL are run one after another.
+PCODE_API enum pcode_status pcode_run(
+  const struct pcode_program *program,
+  const struct pcode_callbacks *callbacks,
+  struct pcode_error *error);
+
+PCODE_API void pcode_free(struct pcode_program *program);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
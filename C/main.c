@@ -1,6 +1,6 @@
 /****************************************************************************
 FILE          : main.c
-LAST REVISION : 2003-02-22
+LAST REVISION : 2026-10-19
 SUBJECT       : Main program of the pcode project.
 PROGRAMMER    : (C) Copyright 2003 by Peter Chapin
 
@@ -13,20 +13,182 @@ Please send comments or bug reports to
 ****************************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "adapt.h"
+#include "budget.h"
+#include "cfg.h"
+#include "checkpoint.h"
+#include "compact.h"
+#include "cost.h"
+#include "cover.h"
+#include "debug.h"
+#include "events.h"
+#include "explore.h"
+#include "fmt.h"
+#include "gen.h"
+#include "intern.h"
+#include "memo.h"
+#include "memstat.h"
+#include "opt.h"
+#include "parse.h"
+#include "scan.h"
+#include "sim.h"
 #include "tree.h"
 
-extern int   yyparse();
 extern FILE *yyin;
-extern int   current_line;
-extern struct statement_list *top_node;
 
 #define YES 1
 #define NO  0
 
+// Returns the argument of an option that takes one, either attached to
+// the option letter or as the next word on the command line.
+//
+static char *option_argument(char ***argv)
+{
+  char  option = ***argv;
+  char *argument = **argv + 1;
+
+  if (*argument == '\0') argument = *++*argv;
+  if (argument == NULL) {
+    printf("Option -%c requires an argument.\n", option);
+    exit(1);
+  }
+  return argument;
+}
+
+// Returns the argument of a long option if the word is that option, either
+// after an = or as the next word on the command line, or NULL if it isn't.
+//
+static char *long_option_argument(char ***argv, const char *name)
+{
+  size_t length = strlen(name);
+  char  *argument;
+
+  if (strncmp(**argv, name, length) != 0) return NULL;
+  argument = **argv + length;
+  if (*argument == '=') return argument + 1;
+  if (*argument != '\0') return NULL;
+  if ((argument = *++*argv) == NULL) {
+    printf("Option -%s requires an argument.\n", name);
+    exit(1);
+  }
+  return argument;
+}
+
+// Builds and analyzes the control flow graph and writes it in DOT format.
+static int write_graph(
+  struct statement_list *top, const struct tree_info *info, const char *file_name)
+{
+  struct cfg *graph;
+  struct timespec start, stop;
+  FILE *out;
+  int ok;
+
+  if ((out = fopen(file_name, "w")) == NULL) {
+    printf("Unable to open %s for output.\n", file_name);
+    return NO;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  graph = build_cfg(top, info);
+  cfg_analyze(graph);
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  ok = cfg_write_dot(graph, out);
+  if (fclose(out) != 0) ok = NO;
+  if (!ok) printf("Error writing %s.\n", file_name);
+  cfg_report(graph);
+  printf("Built and analyzed in %.3f seconds.\n",
+    (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9);
+  free_cfg(graph);
+  return ok;
+}
+
+// Translates the program into C.
+static int write_c(
+  struct statement_list *top, const struct tree_info *info, const char *source,
+  const char *file_name)
+{
+  FILE *out;
+  int ok;
+
+  if ((out = fopen(file_name, "w")) == NULL) {
+    printf("Unable to open %s for output.\n", file_name);
+    return NO;
+  }
+  ok = generate_c(top, info, source, out);
+  if (fclose(out) != 0) ok = NO;
+  if (!ok) printf("Error writing %s.\n", file_name);
+  else printf("Wrote %s. Build it with pcrt.c.\n", file_name);
+  return ok;
+}
+
+static double seconds_between(const struct timespec *start, const struct timespec *stop)
+{
+  return (stop->tv_sec - start->tv_sec) + (stop->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+// Reports the time and memory taken by the front end (--stats).
+static void report_statistics(
+  const struct tree_info *info, const struct timespec *start,
+  const struct timespec *parsed, const struct timespec *prepared)
+{
+  printf("Parsed in %.3f seconds, prepared in %.3f seconds.\n",
+    seconds_between(start, parsed), seconds_between(parsed, prepared));
+  printf("%d statements, %d expressions, %d cases, %d distinct phrases.\n",
+    info->statement_count, info->expression_count, info->case_count, phrase_count());
+  memstat_report(stdout);
+}
+
+// Makes sure coverage is saved if execution stops early (for example
+// when an answer script runs out).
+static void finish_coverage(void)
+{
+  cover_finish();
+}
+
 int main(int argc, char **argv)
 {
   char *input_filename = NULL;
   enum abort_type result;
+  struct tree_info info;
+  struct sim_options sim_options;
+  struct cover_options cover_options;
+  struct cost_options cost_options;
+  struct explore_options explore_options;
+  char *script_prefix = NULL;
+  char *coverage_file = NULL;
+  char *graph_file = NULL;
+  char *c_file = NULL;
+  char *checkpoint_file = NULL;
+  char *resume_file = NULL;
+  char *pattern_file;
+  char *argument;
+  long  checkpoint_every = 0;
+  struct budget limits = { 0, 0, 0.0, 0 };
+  struct statement_list *top_node;
+  struct scanner fast_scanner;
+  int parsed;
+  int simulation = NO;
+  int exploration = NO;
+  int costs = NO;
+  int use_compact = NO;
+  int use_fast_scanner = NO;
+  int parallel_parse = NO;
+  int format = 0;
+  int format_width = FORMAT_WIDTH;
+  int memo_scope = -1;
+  int statistics = NO;
+  int protocol = NO;
+  int breakpoints = NO;
+  const char *ignored;
+  struct timespec start, parsed_time, prepared_time;
+
+  sim_default_options(&sim_options);
+  cover_default_options(&cover_options);
+  cost_default_options(&cost_options);
+  explore_default_options(&explore_options);
 
   // Analyze the command line.
   while (*++argv != NULL) {
@@ -35,6 +197,166 @@ int main(int argc, char **argv)
     }
     else {
       switch (*++*argv) {
+        case 'a':
+          sim_options.adaptive = YES;
+          break;
+
+        case 'A':
+          script_prefix = option_argument(&argv);
+          break;
+
+        case 'b':
+          debug_add_pattern(option_argument(&argv), NO);
+          breakpoints = YES;
+          break;
+
+        case 'B':
+          pattern_file = option_argument(&argv);
+          if (!debug_read_patterns(pattern_file)) {
+            printf("Unable to read %s.\n", pattern_file);
+            return 1;
+          }
+          breakpoints = YES;
+          break;
+
+        case 'c':
+          c_file = option_argument(&argv);
+          break;
+
+        case 'C':
+          coverage_file = option_argument(&argv);
+          break;
+
+        case 'D':
+          graph_file = option_argument(&argv);
+          break;
+
+        case 'd':
+          sim_options.default_probability = atof(option_argument(&argv));
+          break;
+
+        case 'E':
+          costs = YES;
+          cost_options.regions = atoi(option_argument(&argv));
+          break;
+
+        case 'f':
+        case 'F':
+          format = **argv;
+          break;
+
+        case 'J':
+          protocol = YES;
+          break;
+
+        case 'j':
+          sim_options.threads = atoi(option_argument(&argv));
+          cover_options.threads = sim_options.threads;
+          explore_options.threads = sim_options.threads;
+          break;
+
+        case 'k':
+          checkpoint_file = option_argument(&argv);
+          break;
+
+        case 'K':
+          checkpoint_every = atol(option_argument(&argv));
+          break;
+
+        case 'L':
+          sim_options.loop_cap = atol(option_argument(&argv));
+          break;
+
+        case 'M':
+          memo_scope = memo_scope_named(option_argument(&argv));
+          if (memo_scope < 0) {
+            printf("The scope must be evaluation, iteration, statement or run.\n");
+            return 1;
+          }
+          break;
+
+        case 'm':
+          simulation = YES;
+          sim_options.runs = atol(option_argument(&argv));
+          break;
+
+        case 'p':
+          parallel_parse = YES;
+          use_fast_scanner = YES;
+          break;
+
+        case 'P':
+          sim_options.probability_file = option_argument(&argv);
+          break;
+
+        case 'q':
+          quiet_fast_forward = YES;
+          break;
+
+        case 'R':
+          resume_file = option_argument(&argv);
+          break;
+
+        case 'S':
+          sim_options.seed = strtoull(option_argument(&argv), NULL, 10);
+          cover_options.seed = sim_options.seed;
+          break;
+
+        case 's':
+          use_fast_scanner = YES;
+          break;
+
+        case 'w':
+          format_width = atoi(option_argument(&argv));
+          break;
+
+        case 'W':
+          debug_add_pattern(option_argument(&argv), YES);
+          breakpoints = YES;
+          break;
+
+        case 'X':
+          exploration = YES;
+          explore_options.schedules = atol(option_argument(&argv));
+          break;
+
+        case 'x':
+          explore_options.trips = atoi(option_argument(&argv));
+          break;
+
+        case 'z':
+          use_compact = YES;
+          break;
+
+        case '-':
+          if (strcmp(*argv, "-stats") == 0) {
+            statistics = YES;
+            memstat_start();
+            break;
+          }
+          if (strcmp(*argv, "-no-reduction") == 0) {
+            explore_options.reduce = NO;
+            break;
+          }
+          if ((argument = long_option_argument(&argv, "-max-decisions")) != NULL) {
+            limits.decisions = atol(argument);
+            break;
+          }
+          if ((argument = long_option_argument(&argv, "-max-statements")) != NULL) {
+            limits.statements = atol(argument);
+            break;
+          }
+          if ((argument = long_option_argument(&argv, "-max-seconds")) != NULL) {
+            limits.seconds = atof(argument);
+            break;
+          }
+          if ((argument = long_option_argument(&argv, "-max-output")) != NULL) {
+            limits.output = atol(argument);
+            break;
+          }
+          printf("Unrecognized option: -%s (ignored)\n", *argv);
+          break;
+
         default:
           printf("Unrecognized option: %c (ignored)\n", **argv);
           break;
@@ -51,22 +373,115 @@ int main(int argc, char **argv)
     }
   }
 
+  // The formatter writes the program on the standard output.
+  if (format == 'f') return format_tree(stdout, format_width) ? 0 : 1;
+  if (format == 'F') return format_stream(stdout, format_width) ? 0 : 1;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if (use_fast_scanner && !scanner_read(&fast_scanner, yyin != NULL ? yyin : stdin)) {
+    printf("Unable to read the input.\n");
+    return 1;
+  }
+
   // Parse the input.
-  if (yyparse() == 0) {
-    printf("Parsed successfully!\n");
-    result = execute_statement_list(top_node);
-    if (result == fromBREAK) {
+  if (parallel_parse) {
+    parsed = parse_parallel(&fast_scanner, input_filename, sim_options.threads, &top_node);
+  }
+  else {
+    parsed = parse_program(
+      use_fast_scanner ? &fast_scanner : NULL, input_filename, &top_node);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &parsed_time);
+  if (parsed) {
+    if (!protocol) printf("Parsed successfully!\n");
+    prepare_tree(top_node, &info);
+    clock_gettime(CLOCK_MONOTONIC, &prepared_time);
+    if (statistics) report_statistics(&info, &start, &parsed_time, &prepared_time);
+    if (c_file != NULL) {
+      return write_c(top_node, &info,
+        input_filename != NULL ? input_filename : "standard input", c_file) ? 0 : 1;
+    }
+    if (graph_file != NULL) {
+      return write_graph(top_node, &info, graph_file) ? 0 : 1;
+    }
+    if (simulation) {
+      if (sim_options.adaptive) optimize_expressions(&info);
+      return simulate(top_node, &info, &sim_options) ? 0 : 1;
+    }
+    if (costs) {
+      cost_options.loop_cap            = sim_options.loop_cap;
+      cost_options.default_probability = sim_options.default_probability;
+      cost_options.probability_file    = sim_options.probability_file;
+      return analyze_costs(top_node, &info, &cost_options) ? 0 : 1;
+    }
+    if (exploration) {
+      return explore(top_node, &info, &explore_options) ? 0 : 1;
+    }
+    if (script_prefix != NULL) {
+      return cover_generate(top_node, &info, &cover_options, script_prefix) ? 0 : 1;
+    }
+
+    // The compact executor only asks the questions. An option it would
+    // ignore is refused, above all a budget meant to stop an unattended run.
+    if (use_compact) {
+      ignored =
+        limits.decisions != 0 || limits.statements != 0 ||
+        limits.seconds != 0.0 || limits.output != 0 ? "a budget (--max-...)" :
+        protocol                ? "-J" :
+        checkpoint_file != NULL ? "-k" :
+        resume_file != NULL     ? "-R" :
+        breakpoints             ? "-b, -B or -W" :
+        memo_scope >= 0         ? "-M" :
+        quiet_fast_forward      ? "-q" :
+        sim_options.adaptive    ? "-a" :
+        coverage_file != NULL   ? "-C" : NULL;
+      if (ignored != NULL) {
+        printf("The compact executor (-z) can't be used with %s.\n", ignored);
+        return 1;
+      }
+    }
+
+    if (coverage_file != NULL) {
+      cover_start(&info, coverage_file);
+      atexit(finish_coverage);
+    }
+    if (use_compact) {
+      struct compact_tree *compact = build_compact_tree(top_node, &info);
+      compact_report(compact, top_node, &info);
+      result = execute_compact(compact);
+      free_compact_tree(compact);
+    }
+    else {
+      optimize_expressions(&info);
+      if (sim_options.adaptive) execution_adapter = new_adapter(&info, stdout);
+      if (memo_scope >= 0) {
+        memo_start((enum memo_scope)memo_scope);
+        atexit(memo_finish);
+      }
+      debug_start(&info);
+      if (protocol) events_start(stdout, &info);
+      if (checkpoint_file == NULL) checkpoint_file = resume_file;
+      if (checkpoint_file != NULL) {
+        checkpoint_start(&info, checkpoint_file, checkpoint_every);
+      }
+      if (resume_file != NULL && !checkpoint_resume(&info, top_node, resume_file)) {
+        return 1;
+      }
+      budget_start(&limits);
+      result = execute_statement_list(top_node);
+    }
+    if (events_on) {
+      event_end("end", result == fromBREAK ? "BREAK without an enclosing loop" :
+        result == fromCONTINUE ? "CONTINUE without an enclosing loop" : "normal");
+    }
+    else if (result == fromBREAK) {
       printf("Warning: Executed a BREAK without an enclosing loop.\n");
     }
     else if (result == fromCONTINUE) {
       printf("Warning: Executed a CONTINUE without an enclosing loop.\n");
     }
+    cover_finish();
   }
 
   return 0;
 }
-
-void yyerror(char *message)
-{
-  printf("Syntax error: [line %d] %s\n", current_line, message);
-}
@@ -0,0 +1,129 @@
+/****************************************************************************
+FILE          : memo.c
+LAST REVISION : 2026-10-19
+SUBJECT       : The answer memory.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Each execution of the chosen kind of scope opens a frame. The open frames
+form a stack and each frame gets a serial number that is never reused.
+An answer is stored with the depth and serial number of the frame that
+was on top when it was given; it is still good if the frame at that
+depth is the same one. Closing a frame therefore forgets its answers
+without touching the table, and an answer given in an outer frame stays
+visible in the frames nested inside it.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+#include "memo.h"
+
+struct memory {
+  int                 answer;
+  int                 depth;    // Frame the answer was given in.
+  unsigned long       serial;
+};
+
+static int                active = 0;
+static enum memo_scope    memo_scope;
+static struct memory     *memories;       // Indexed by phrase ID.
+static unsigned long     *frames;         // Serial numbers of open frames.
+static int                depth;
+static int                frame_capacity;
+static unsigned long      next_serial;
+static unsigned long long hits;
+static unsigned long long asked;
+
+static const char *scope_names[] = { "evaluation", "iteration", "statement", "run" };
+
+int memo_scope_named(const char *name)
+{
+  int i;
+
+  if (*name == '\0') return -1;
+  for (i = 0; i < 4; ++i) {
+    if (strncmp(name, scope_names[i], strlen(name)) == 0) return i;
+  }
+  return -1;
+}
+
+
+void memo_start(enum memo_scope scope)
+{
+  int count = phrase_count();
+  int i;
+
+  memo_scope     = scope;
+  memories       = (struct memory *)malloc((count + 1) * sizeof(struct memory));
+  frame_capacity = 16;
+  frames         = (unsigned long *)malloc(frame_capacity * sizeof(unsigned long));
+  for (i = 0; i < count; ++i) memories[i].depth = -1;
+
+  // The bottom frame lasts for the whole run.
+  frames[0]   = 0;
+  depth       = 1;
+  next_serial = 1;
+  active      = 1;
+}
+
+
+void memo_enter(enum memo_scope event)
+{
+  if (!active || event != memo_scope) return;
+  if (depth == frame_capacity) {
+    frame_capacity *= 2;
+    frames = (unsigned long *)realloc(frames, frame_capacity * sizeof(unsigned long));
+  }
+  frames[depth++] = next_serial++;
+}
+
+
+void memo_leave(enum memo_scope event)
+{
+  if (!active || event != memo_scope) return;
+  --depth;
+}
+
+
+int memo_recall(int phrase, int *answer)
+{
+  struct memory *m;
+
+  if (!active || phrase < 0) return 0;
+  m = &memories[phrase];
+  if (m->depth < 0 || m->depth >= depth || frames[m->depth] != m->serial) return 0;
+  ++hits;
+  *answer = m->answer;
+  return 1;
+}
+
+
+void memo_store(int phrase, int answer)
+{
+  struct memory *m;
+
+  if (!active || phrase < 0) return;
+  ++asked;
+  m = &memories[phrase];
+  m->answer = answer;
+  m->depth  = depth - 1;
+  m->serial = frames[depth - 1];
+}
+
+
+void memo_finish(void)
+{
+  if (!active) return;
+  printf("Answer memory (%s scope): %llu answer%s reused, %llu question%s asked.\n",
+    scope_names[memo_scope], hits, hits == 1 ? "" : "s",
+    asked, asked == 1 ? "" : "s");
+  active = 0;
+}
@@ -0,0 +1,61 @@
+/****************************************************************************
+FILE          : memo.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the answer memory.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The same phrase often appears in several conditions close together, for
+example in the condition of a loop and again in an IF inside it. With
+the answer memory turned on, the answer to a condition phrase is
+remembered and used again instead of asking, until it goes out of scope.
+The scope is one of
+
+  + evaluation: the phrase is asked again in the next condition.
+  + iteration:  answers are forgotten when the loop iteration they were
+                given in ends.
+  + statement:  answers are forgotten when the statement they were given
+                in (the innermost one, counting IF, SWITCH and loops) ends.
+  + run:        answers are never forgotten.
+
+Phrases are compared by phrase ID (see intern.h). The condition of a loop
+is always asked, whatever the scope, since otherwise a loop entered with
+its condition true could never end. Its answers are remembered for use
+elsewhere.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef MEMO_H
+#define MEMO_H
+
+#include "tree.h"
+
+enum memo_scope { MEMO_EVALUATION, MEMO_ITERATION, MEMO_STATEMENT, MEMO_RUN };
+
+// Returns the scope named (or abbreviated) by the text, or -1.
+int memo_scope_named(const char *name);
+
+// Turn on the answer memory for a prepared tree.
+void memo_start(enum memo_scope scope);
+
+// Mark the start and end of an evaluation, iteration or statement. They
+// must be properly nested. Does nothing unless the memory is on.
+void memo_enter(enum memo_scope event);
+void memo_leave(enum memo_scope event);
+
+// Look up the answer to a phrase. Returns nonzero and sets *answer if it
+// is remembered. Hits are counted.
+int memo_recall(int phrase, int *answer);
+
+// Remember the answer to a phrase.
+void memo_store(int phrase, int answer);
+
+// Print how many answers were reused, if the memory is on.
+void memo_finish(void);
+
+#endif
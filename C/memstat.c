@@ -0,0 +1,134 @@
+/****************************************************************************
+FILE          : memstat.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Allocation statistics.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The counters are updated with the GCC atomic built-ins. The peak is
+raised with a compare and exchange loop so that two threads raising it
+at once can't lose the larger value.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdlib.h>
+#include "memstat.h"
+
+struct mem_counts {
+  unsigned long allocations;
+  unsigned long reallocations;
+  unsigned long frees;
+  size_t        live;
+  size_t        peak;
+};
+
+static int               counting = 0;
+static struct mem_counts counts[MEM_CATEGORIES];
+static struct mem_counts total;      // Only live and peak are used.
+
+static const char *category_names[MEM_CATEGORIES] = {
+  "statements", "statement lists", "expressions", "case branches", "case lists",
+  "arrays", "phrases", "string buffers"
+};
+
+void memstat_start(void)
+{
+  counting = 1;
+}
+
+
+static void raise_live(struct mem_counts *c, size_t size)
+{
+  size_t live = __atomic_add_fetch(&c->live, size, __ATOMIC_RELAXED);
+  size_t peak = __atomic_load_n(&c->peak, __ATOMIC_RELAXED);
+
+  while (live > peak &&
+         !__atomic_compare_exchange_n(&c->peak, &peak, live, 1,
+           __ATOMIC_RELAXED, __ATOMIC_RELAXED)) ;
+}
+
+
+static void grow(struct mem_counts *c, size_t size)
+{
+  raise_live(c, size);
+  raise_live(&total, size);
+}
+
+
+static void shrink(struct mem_counts *c, size_t size)
+{
+  __atomic_sub_fetch(&c->live, size, __ATOMIC_RELAXED);
+  __atomic_sub_fetch(&total.live, size, __ATOMIC_RELAXED);
+}
+
+
+void *mem_alloc(enum mem_category category, size_t size)
+{
+  void *p = malloc(size);
+
+  if (counting && p != NULL) {
+    __atomic_add_fetch(&counts[category].allocations, 1, __ATOMIC_RELAXED);
+    grow(&counts[category], size);
+  }
+  return p;
+}
+
+
+void *mem_realloc(enum mem_category category, void *p, size_t old_size, size_t new_size)
+{
+  struct mem_counts *c = &counts[category];
+  void *q = realloc(p, new_size);
+
+  if (counting && q != NULL) {
+    if (p == NULL) {
+      __atomic_add_fetch(&c->allocations, 1, __ATOMIC_RELAXED);
+      old_size = 0;
+    }
+    else {
+      __atomic_add_fetch(&c->reallocations, 1, __ATOMIC_RELAXED);
+    }
+    if (new_size >= old_size) grow(c, new_size - old_size);
+    else shrink(c, old_size - new_size);
+  }
+  return q;
+}
+
+
+void mem_free(enum mem_category category, void *p, size_t size)
+{
+  if (counting && p != NULL) {
+    __atomic_add_fetch(&counts[category].frees, 1, __ATOMIC_RELAXED);
+    shrink(&counts[category], size);
+  }
+  free(p);
+}
+
+
+void memstat_report(FILE *out)
+{
+  unsigned long allocations = 0, reallocations = 0, frees = 0;
+  int i;
+
+  fprintf(out, "%-16s %11s %11s %11s %14s %14s\n",
+    "memory", "allocs", "reallocs", "frees", "live bytes", "peak bytes");
+  for (i = 0; i < MEM_CATEGORIES; ++i) {
+    struct mem_counts *c = &counts[i];
+    fprintf(out, "%-16s %11lu %11lu %11lu %14lu %14lu\n", category_names[i],
+      c->allocations, c->reallocations, c->frees,
+      (unsigned long)c->live, (unsigned long)c->peak);
+    allocations   += c->allocations;
+    reallocations += c->reallocations;
+    frees         += c->frees;
+  }
+
+  // The categories don't all peak at the same moment, so the total peak
+  // can be less than the sum of the peaks.
+  fprintf(out, "%-16s %11lu %11lu %11lu %14lu %14lu\n", "total",
+    allocations, reallocations, frees,
+    (unsigned long)total.live, (unsigned long)total.peak);
+}
@@ -0,0 +1,52 @@
+/****************************************************************************
+FILE          : memstat.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the allocation statistics.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The front end allocates through these functions so that the memory a
+program costs can be broken down by kind. For each category the number
+of allocations and reallocations, the bytes currently in use, and the
+most bytes ever in use at once are kept. Only the requested sizes are
+counted; the overhead of the C library's allocator is not.
+
+Counting is off unless memstat_start() has been called, and then it is
+safe to allocate from several threads at once (the parallel parser does).
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef MEMSTAT_H
+#define MEMSTAT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+enum mem_category {
+  MEM_STATEMENT,        // struct statement
+  MEM_STATEMENT_LIST,   // struct statement_list
+  MEM_EXPRESSION,       // struct expression
+  MEM_CASE_BRANCH,      // struct case_branch
+  MEM_CASE_LIST,        // struct case_list
+  MEM_ARRAY,            // Arrays made by prepare_tree() and the optimizer.
+  MEM_PHRASE,           // The vtc_string objects holding phrases.
+  MEM_STRING,           // Character buffers of every vtc_string.
+  MEM_CATEGORIES
+};
+
+// Start counting.
+void memstat_start(void);
+
+void *mem_alloc(enum mem_category category, size_t size);
+void *mem_realloc(enum mem_category category, void *p, size_t old_size, size_t new_size);
+void  mem_free(enum mem_category category, void *p, size_t size);
+
+// Print a table of the figures for each category.
+void memstat_report(FILE *out);
+
+#endif
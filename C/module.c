@@ -0,0 +1,319 @@
+/****************************************************************************
+FILE          : module.c
+LAST REVISION : 2026-10-19
+SUBJECT       : The module cache.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Modules are found by their canonical path, so one file reached by two
+different names is still parsed once. A module is parsed while the file
+importing it is being parsed (the parser is reentrant), always with the
+hand written scanner since the Flex scanner keeps its state in globals.
+
+One lock, which a thread may take again, is held while a module is
+looked up and parsed, so the modules being parsed at any time are the
+chain of imports of a single thread. The file given to the parser is at
+the bottom of that chain. Finding one of those again is a cycle.
+
+A quiet parse (a piece of a parallel parse) doesn't keep a module that
+fails. The serial parse that follows then parses it again and reports
+its errors.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <ctype.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memstat.h"
+#include "module.h"
+
+enum module_state { LOADING, LOADED, FAILED };
+
+struct module {
+  char                  *path;    // As found from the IMPORT (for messages).
+  char                  *key;     // Canonical path.
+  int                    number;  // Marks the nodes copied from it (see module_name()).
+  enum module_state      state;
+  struct statement_list *top;     // Never prepared; each IMPORT gets a copy.
+  struct module         *next;
+};
+
+static struct module   *modules;
+static struct module  **loading;   // The chain being parsed, the file given first.
+static int              loading_count;
+static int              loading_capacity;
+static char           **names;     // The paths of the modules by number, from 1.
+static int              name_count;
+static int              name_capacity;
+static pthread_mutex_t  lock;
+static pthread_once_t   lock_once = PTHREAD_ONCE_INIT;
+
+static void make_lock(void)
+{
+  pthread_mutexattr_t attributes;
+
+  pthread_mutexattr_init(&attributes);
+  pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&lock, &attributes);
+  pthread_mutexattr_destroy(&attributes);
+}
+
+
+// Reports a problem with the IMPORT on 'line'.
+static void complain(const struct parse_context *context, int line, const char *format, ...)
+{
+  char    message[1024];
+  va_list args;
+
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  parse_complain(context, IMPORT_PROBLEM, line, message);
+}
+
+
+// Returns the path of the file named by an IMPORT's phrase: the text
+// between the brackets without surrounding white space, taken relative
+// to the directory of the importing file.
+//
+static char *module_path(const struct parse_context *context, vtc_string *name)
+{
+  const char *text   = vtc_string_getcharp(name) + 1;
+  int         length = vtc_string_length(name) - 2;
+  const char *slash;
+  size_t      directory = 0;
+  char       *path;
+
+  while (length > 0 && isspace((unsigned char)*text)) {
+    ++text;
+    --length;
+  }
+  while (length > 0 && isspace((unsigned char)text[length - 1])) --length;
+  if (length > 0 && *text != '/' && context->file != NULL &&
+      (slash = strrchr(context->file, '/')) != NULL) {
+    directory = slash - context->file + 1;
+  }
+  path = (char *)malloc(directory + length + 1);
+  if (directory > 0) memcpy(path, context->file, directory);
+  memcpy(path + directory, text, length);
+  path[directory + length] = '\0';
+  return path;
+}
+
+
+static void push_loading(struct module *m)
+{
+  if (loading_count == loading_capacity) {
+    loading_capacity = loading_capacity ? 2 * loading_capacity : 8;
+    loading = (struct module **)realloc(loading, loading_capacity * sizeof(struct module *));
+  }
+  loading[loading_count++] = m;
+}
+
+
+// Describes the cycle that importing m again would make.
+static void complain_cycle(
+  const struct parse_context *context, int line, const struct module *m)
+{
+  vtc_string chain;
+  int i;
+
+  vtc_string_init(&chain);
+  for (i = 0; loading[i] != m; ++i) ;
+  for (; i < loading_count; ++i) vtc_string_appendf(&chain, "%s imports ", loading[i]->path);
+  vtc_string_appendcharp(&chain, m->path);
+  complain(context, line, "Import cycle: %s.", vtc_string_getcharp(&chain));
+  vtc_string_destroy(&chain);
+}
+
+
+// Parses a new module, which takes ownership of the path and key.
+static struct module *parse_module(
+  const struct parse_context *context, int line, char *path, char *key)
+{
+  struct module       *m, **link;
+  struct parse_context module_context;
+  struct scanner       scanner;
+  FILE *in;
+  int   ok;
+
+  if ((in = fopen(key, "r")) == NULL) {
+    complain(context, line, "Unable to open %s.", path);
+    free(path);
+    free(key);
+    return NULL;
+  }
+  ok = scanner_read(&scanner, in);
+  fclose(in);
+  if (!ok) {
+    complain(context, line, "Unable to read %s.", path);
+    free(path);
+    free(key);
+    return NULL;
+  }
+
+  // A module forgotten below keeps its number and name, since the
+  // number may already be in trees that are still in use.
+  if (name_count == name_capacity) {
+    name_capacity = name_capacity ? 2 * name_capacity : 8;
+    names = (char **)realloc(names, name_capacity * sizeof(char *));
+  }
+  names[name_count++] = path;
+
+  m = (struct module *)malloc(sizeof(struct module));
+  m->path   = path;
+  m->key    = key;
+  m->number = name_count;
+  m->state  = LOADING;
+  m->top   = NULL;
+  m->next  = modules;
+  modules  = m;
+  push_loading(m);
+
+  memset(&module_context, 0, sizeof(module_context));
+  module_context.scanner       = &scanner;
+  module_context.line          = 1;
+  module_context.quiet         = context->quiet;
+  module_context.allow_declare = 1;
+  module_context.file          = path;
+  module_context.report        = context->report;
+  module_context.reporter      = context->reporter;
+  ok = yyparse(&module_context) == 0;
+  scanner_close(&scanner);
+
+  --loading_count;
+  m->top   = module_context.top;
+  m->state = ok ? LOADED : FAILED;
+  if (ok || !context->quiet) return m;
+
+  // Forget it so that a parse that isn't quiet will report its errors.
+  // Modules it imported may have been added in front of it.
+  for (link = &modules; *link != m; link = &(*link)->next) ;
+  *link = m->next;
+  free(m->key);
+  free(m);
+  return NULL;
+}
+
+
+// Returns the parsed module at 'path' (which is released), or NULL after
+// reporting why it can't be imported.
+static struct module *find_module(const struct parse_context *context, int line, char *path)
+{
+  struct module *m;
+  char *key;
+  int   i;
+
+  if (*path == '\0') {
+    complain(context, line, "An IMPORT needs a file name.");
+    free(path);
+    return NULL;
+  }
+  if ((key = realpath(path, NULL)) == NULL) {
+    complain(context, line, "Unable to open %s.", path);
+    free(path);
+    return NULL;
+  }
+  for (i = 0; i < loading_count; ++i) {
+    if (loading[i]->key != NULL && strcmp(loading[i]->key, key) == 0) {
+      free(path);
+      free(key);
+      complain_cycle(context, line, loading[i]);
+      return NULL;
+    }
+  }
+  for (m = modules; m != NULL; m = m->next) {
+    if (strcmp(m->key, key) == 0) break;
+  }
+
+  // A module that fails now has just reported its own errors.
+  if (m == NULL) {
+    m = parse_module(context, line, path, key);
+    return m != NULL && m->state == LOADED ? m : NULL;
+  }
+  free(path);
+  free(key);
+  if (m->state == FAILED) {
+    complain(context, line, "%s has errors.", m->path);
+    return NULL;
+  }
+  return m;
+}
+
+
+struct statement_list *import_module(
+  struct parse_context  *context,
+  struct statement_list *before,
+  vtc_string            *name,
+  int                    line)
+{
+  struct module *m, given;
+  char *path = module_path(context, name);
+  int   outermost;
+
+  vtc_string_destroy(name);
+  mem_free(MEM_PHRASE, name, sizeof(vtc_string));
+
+  pthread_once(&lock_once, make_lock);
+  pthread_mutex_lock(&lock);
+
+  // An IMPORT in the file given to the parser. That file starts the chain.
+  if ((outermost = loading_count == 0)) {
+    memset(&given, 0, sizeof(given));
+    given.path  = (char *)(context->file != NULL ? context->file : "the program");
+    given.key   = context->file != NULL ? realpath(context->file, NULL) : NULL;
+    given.state = LOADING;
+    push_loading(&given);
+  }
+  m = find_module(context, line, path);
+  if (outermost) {
+    --loading_count;
+    free(given.key);
+  }
+  pthread_mutex_unlock(&lock);
+
+  // A parsed module's tree doesn't change, so it can be copied unlocked.
+  if (m == NULL) return NULL;
+  return copy_statement_list(m->top, before, m->number);
+}
+
+
+const char *module_name(int module)
+{
+  const char *name;
+
+  if (module <= 0) return NULL;
+  pthread_once(&lock_once, make_lock);
+  pthread_mutex_lock(&lock);
+  name = module <= name_count ? names[module - 1] : NULL;
+  pthread_mutex_unlock(&lock);
+  return name;
+}
+
+
+const char *describe_line(char *buffer, size_t size, int module, int line)
+{
+  const char *name = module_name(module);
+
+  if (name == NULL) snprintf(buffer, size, "line %d", line);
+  else snprintf(buffer, size, "line %d of %s", line, name);
+  return buffer;
+}
+
+
+const char *line_label(char *buffer, size_t size, int module, int line)
+{
+  const char *name = module_name(module);
+
+  if (name == NULL) snprintf(buffer, size, "%d", line);
+  else snprintf(buffer, size, "%s:%d", name, line);
+  return buffer;
+}
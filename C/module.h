@@ -0,0 +1,61 @@
+/****************************************************************************
+FILE          : module.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the module cache.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+A program can bring in the statements of another file with
+
+  IMPORT [common.pcd]
+
+wherever a statement may be written. The imported statements are run
+there just as if they had been written in place. A file name that isn't
+absolute is taken relative to the directory of the importing file.
+
+Every file imported is parsed once per run, no matter how many places
+(or how many programs, in the tools) import it: its tree is kept in a
+cache shared by all threads and each IMPORT gets a copy. A file that
+imports itself, directly or through others, is an error, as is a file
+that can't be read or has a syntax error. The messages name the file
+and line of the IMPORT.
+
+Each module is given a number, from 1, and the nodes copied from it are
+marked with that number (see struct statement). Their lines are lines
+of the module, so anything that prints a line names the module too.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef MODULE_H
+#define MODULE_H
+
+#include "parse.h"
+
+// Used by the parser for an IMPORT on the given line. The name is the
+// phrase of the directive, which is released. Returns a copy of the
+// module's statements continuing 'before' (see copy_statement_list()),
+// or NULL after reporting an error.
+//
+struct statement_list *import_module(
+  struct parse_context  *context,
+  struct statement_list *before,
+  vtc_string            *name,
+  int                    line);
+
+// Returns the path of a module by number as its IMPORT found it, or NULL
+// for 0 (the file being parsed, which the caller knows).
+const char *module_name(int module);
+
+// Writes "line 12", or "line 3 of common.pcd" for a line of a module,
+// into the buffer and returns it.
+const char *describe_line(char *buffer, size_t size, int module, int line);
+
+// The same for a column of line numbers: "12", or "common.pcd:3".
+const char *line_label(char *buffer, size_t size, int module, int line);
+
+#endif
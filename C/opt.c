@@ -0,0 +1,161 @@
+/****************************************************************************
+FILE          : opt.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Optimization of conditions.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Each condition is rebuilt in negation normal form. The normalizing
+functions carry a flag saying whether the subexpression is negated; an
+AND under an odd number of NOTs becomes an OR of the negated operands
+and vice versa. Nodes of the original tree are reused for the new AND
+and OR nodes and for NOT applied to a phrase where possible.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdlib.h>
+#include "memstat.h"
+#include "opt.h"
+
+static struct expression *normalize(struct expression *e, int negate);
+
+static void append_operand(struct expression *group, struct expression *e, int *capacity)
+{
+  if (group->count == *capacity) {
+    *capacity = *capacity ? 2 * *capacity : 4;
+    group->operands = (struct expression **)mem_realloc(MEM_ARRAY,
+      group->operands, group->count * sizeof(struct expression *),
+      *capacity * sizeof(struct expression *));
+  }
+  group->operands[group->count++] = e;
+}
+
+
+// Returns the node under any PASSop nodes.
+static struct expression *skip_passes(struct expression *e)
+{
+  while (e->op == PASSop) e = e->first;
+  return e;
+}
+
+
+// Adds the operands of e (negated if requested) to an AND or OR node. If
+// e is itself an AND or OR that becomes the same operation, its operands
+// are added instead.
+//
+static void gather(struct expression *group, struct expression *e, int negate, int *capacity)
+{
+  enum operation op = e->op;
+
+  if (op == PASSop || (op == NOTop && skip_passes(e->first)->op != PROMPTop)) {
+    gather(group, e->first, op == NOTop ? !negate : negate, capacity);
+    mem_free(MEM_EXPRESSION, e, sizeof(struct expression));
+  }
+  else if ((op == ANDop || op == ORop) && (op == group->op) != negate) {
+    gather(group, e->first,  negate, capacity);
+    gather(group, e->second, negate, capacity);
+    mem_free(MEM_EXPRESSION, e, sizeof(struct expression));
+  }
+  else {
+    append_operand(group, normalize(e, negate), capacity);
+  }
+}
+
+
+static struct expression *normalize(struct expression *e, int negate)
+{
+  struct expression *result = e;
+  struct expression *first, *second;
+  int capacity = 0;
+
+  switch (e->op) {
+    case PASSop:
+      result = normalize(e->first, negate);
+      mem_free(MEM_EXPRESSION, e, sizeof(struct expression));
+      break;
+
+    case NOTop:
+      if (!negate && skip_passes(e->first)->op == PROMPTop) {
+        result = normalize(e->first, 0);
+        e->first = result;
+        result = e;
+      }
+      else {
+        result = normalize(e->first, !negate);
+        mem_free(MEM_EXPRESSION, e, sizeof(struct expression));
+      }
+      break;
+
+    case ANDop:
+    case ORop:
+      first  = e->first;
+      second = e->second;
+      if (negate) e->op = (e->op == ANDop) ? ORop : ANDop;
+      e->first  = NULL;
+      e->second = NULL;
+      gather(e, first,  negate, &capacity);
+      gather(e, second, negate, &capacity);
+      e->operands = (struct expression **)mem_realloc(MEM_ARRAY, e->operands,
+        capacity * sizeof(struct expression *), e->count * sizeof(struct expression *));
+      break;
+
+    case PROMPTop:
+      if (negate) result = new_expression_node(e, NULL, NOTop, NULL);
+      break;
+  }
+  return result;
+}
+
+
+static int count_nodes(struct expression *e)
+{
+  int count = 1;
+  int i;
+
+  if (e->first != NULL) count += count_nodes(e->first);
+  for (i = 0; i < e->count; ++i) count += count_nodes(e->operands[i]);
+  return count;
+}
+
+
+static void number_expression(struct expression *e, struct tree_info *info)
+{
+  int i;
+
+  e->id = info->expression_count;
+  info->expressions[info->expression_count++] = e;
+  if (e->first != NULL) number_expression(e->first, info);
+  for (i = 0; i < e->count; ++i) number_expression(e->operands[i], info);
+}
+
+
+void optimize_expressions(struct tree_info *info)
+{
+  struct statement *s;
+  int count = 0, old_capacity = 1, capacity = 1;
+  int i;
+
+  for (i = 0; i < info->statement_count; ++i) {
+    s = info->statements[i];
+    if (s->conditional == NULL) continue;
+    s->conditional = normalize(s->conditional, 0);
+    count += count_nodes(s->conditional);
+  }
+
+  // The array's capacity is kept a power of two (see record_node() in
+  // tree.c).
+  while (old_capacity < info->expression_count) old_capacity *= 2;
+  while (capacity < count) capacity *= 2;
+  info->expressions = (struct expression **)mem_realloc(MEM_ARRAY, info->expressions,
+    old_capacity * sizeof(struct expression *), capacity * sizeof(struct expression *));
+  info->expression_count = 0;
+  for (i = 0; i < info->statement_count; ++i) {
+    s = info->statements[i];
+    if (s->conditional != NULL) number_expression(s->conditional, info);
+  }
+}
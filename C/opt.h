@@ -0,0 +1,41 @@
+/****************************************************************************
+FILE          : opt.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the expression optimizer.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The grammar wraps every operand of AND and OR in a PASSop node, so even
+a condition with a single phrase is a chain of several nodes. The
+optimizer rewrites each condition into a smaller, equivalent form:
+
+  + PASSop nodes are removed.
+  + NOT is pushed inward with De Morgan's laws until it applies only to
+    phrases, and double negations cancel.
+  + Nested ANDs (and nested ORs) are merged into one node holding an
+    array of operands, which evaluate_expression() walks in a loop.
+
+Because AND and OR short circuit, De Morgan's laws don't change which
+questions are asked or in what order, so the optimized program behaves
+exactly as the original one does.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef OPT_H
+#define OPT_H
+
+#include "tree.h"
+
+// Optimize every condition of a prepared tree in place. The nodes that
+// are no longer needed are freed and the expressions are renumbered, so
+// info->expressions is rebuilt. The formatter, the coverage tools and the
+// other analysis passes expect the tree as the parser built it; use this
+// only on a tree that is about to be executed.
+void optimize_expressions(struct tree_info *info);
+
+#endif
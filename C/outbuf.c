@@ -0,0 +1,70 @@
+/****************************************************************************
+FILE          : outbuf.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Buffered output writer.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "outbuf.h"
+
+void out_open(struct outbuf *out, FILE *file)
+{
+  out->file    = file;
+  out->data    = (char *)malloc(OUTBUF_SIZE);
+  out->used    = 0;
+  out->column  = 0;
+  out->error   = out->data == NULL;
+  out->written = 0;
+}
+
+
+void out_drain(struct outbuf *out)
+{
+  if (out->used > 0 && fwrite(out->data, 1, out->used, out->file) != out->used) {
+    out->error = 1;
+  }
+  out->written += (long)out->used;
+  out->used = 0;
+}
+
+
+int out_close(struct outbuf *out)
+{
+  out_drain(out);
+  if (fflush(out->file) != 0) out->error = 1;
+  free(out->data);
+  out->data = NULL;
+  return !out->error;
+}
+
+
+void out_write(struct outbuf *out, const char *text, size_t length)
+{
+  size_t room;
+
+  out->column += (int)length;
+  while (length > 0) {
+    if (out->used == OUTBUF_SIZE) out_drain(out);
+    room = OUTBUF_SIZE - out->used;
+    if (room > length) room = length;
+    memcpy(out->data + out->used, text, room);
+    out->used += room;
+    text      += room;
+    length    -= room;
+  }
+}
+
+
+void out_spaces(struct outbuf *out, int count)
+{
+  while (count-- > 0) out_char(out, ' ');
+}
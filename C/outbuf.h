@@ -0,0 +1,64 @@
+/****************************************************************************
+FILE          : outbuf.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the buffered output writer.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Output is collected in a large buffer that is handed to the stream with
+one fwrite() each time it fills, rather than going through stdio a
+character at a time. The writer also keeps track of the column so that
+callers can lay out text without looking back at what they wrote.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define OUTBUF_SIZE (1 << 16)
+
+struct outbuf {
+  FILE  *file;
+  char  *data;
+  size_t used;
+  int    column;    // Characters written since the last newline.
+  int    error;     // Set if a write failed.
+  long   written;   // Bytes handed to the stream so far.
+};
+
+void out_open(struct outbuf *out, FILE *file);
+
+// Hand the buffered text to the stream (used when the buffer fills).
+void out_drain(struct outbuf *out);
+
+// Write any buffered text and release the buffer. Returns zero if any
+// write failed.
+int out_close(struct outbuf *out);
+
+// Text written with these must not contain newlines.
+void out_write(struct outbuf *out, const char *text, size_t length);
+void out_spaces(struct outbuf *out, int count);
+
+static inline void out_char(struct outbuf *out, char ch)
+{
+  if (out->used == OUTBUF_SIZE) out_drain(out);
+  out->data[out->used++] = ch;
+  ++out->column;
+}
+
+static inline void out_newline(struct outbuf *out)
+{
+  if (out->used == OUTBUF_SIZE) out_drain(out);
+  out->data[out->used++] = '\n';
+  out->column = 0;
+}
+
+#endif
@@ -0,0 +1,341 @@
+/****************************************************************************
+FILE          : parse.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Drivers for the reentrant parser.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+A large input is parsed in pieces. A quick pass over the tokens (without
+building phrase values) tracks the nesting of the blocks and notes where
+each top level statement ends. The text is cut at such places into about
+four pieces per thread, each piece is parsed on its own by a worker with
+its own scanner, and the statement lists are joined in order.
+
+A piece can always be parsed alone when the input is correct, because
+statement_list is left recursive: the list of the whole program is the
+list of the first piece with the statements of the later pieces added to
+it. If any piece fails to parse the whole input is parsed again serially
+so that the error message is exactly the usual one.
+
+The Flex scanner keeps its state in globals, so only the hand written
+scanner is used by the workers.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "memstat.h"
+#include "parse.h"
+
+// The Flex scanner puts token values and locations here.
+YYSTYPE yylval;
+YYLTYPE yylloc;
+
+extern int current_line;
+extern int yylex(void);
+
+// Inputs smaller than this aren't worth splitting.
+#define PARALLEL_MINIMUM (1L << 20)
+
+// Pieces per thread. Statements vary in size so a few pieces per thread
+// keeps the threads evenly loaded.
+#define PIECES_PER_THREAD 4
+
+int pcode_lex(YYSTYPE *value, YYLTYPE *location, struct parse_context *context)
+{
+  int token;
+
+  if (context->scanner == NULL) {
+    token = yylex();
+    *value = yylval;
+    *location = yylloc;
+    context->line = current_line;
+  }
+  else {
+    token = scan_token(context->scanner, value, location);
+    context->line = context->scanner->line;
+  }
+  if (context->observe != NULL) context->observe(token, location, context->observer);
+  return token;
+}
+
+
+void parse_complain(
+  const struct parse_context *context, enum parse_problem problem, int line,
+  const char *message)
+{
+  const char *kind = problem == SYNTAX_PROBLEM ? "Syntax error" : "Import error";
+
+  if (context->quiet) return;
+  if (context->report != NULL) {
+    context->report(problem, context->file, line, message, context->reporter);
+  }
+  else if (context->file != NULL) {
+    printf("%s: [%s line %d] %s\n", kind, context->file, line, message);
+  }
+  else {
+    printf("%s: [line %d] %s\n", kind, line, message);
+  }
+}
+
+
+void yyerror(const YYLTYPE *location, struct parse_context *context, const char *message)
+{
+  (void)location;
+  parse_complain(context, SYNTAX_PROBLEM, context->line, message);
+}
+
+
+vtc_string *check_estimate(const struct parse_context *context, vtc_string *phrase, int line)
+{
+  if (read_estimate(phrase, NULL)) return phrase;
+  parse_complain(context, SYNTAX_PROBLEM, line,
+    "A COST or BOUND is one to three numbers, smallest first.");
+  vtc_string_destroy(phrase);
+  mem_free(MEM_PHRASE, phrase, sizeof(vtc_string));
+  return NULL;
+}
+
+
+int check_branch(const struct parse_context *context, const struct statement_list *branch)
+{
+  const struct statement  *last = branch->second;
+  const struct expression *tail;
+
+  if (last == NULL || last->type != REPEATtype || last->module != 0 || last->estimate != NULL) {
+    return 1;
+  }
+  tail = last->conditional;
+  tail = tail->op == ORop ? tail->second : tail->first;
+  if (tail->op != ANDop) return 1;
+  parse_complain(context, SYNTAX_PROBLEM, last->end_line,
+    "The AND after an UNTIL that ends a PARALLEL branch is read as part of its condition. "
+    "Put a statement after the UNTIL, or the condition in parentheses if no branch follows.");
+  return 0;
+}
+
+
+int parse_program(
+  struct scanner *scanner, const char *file, struct statement_list **top)
+{
+  struct parse_context context = { scanner, NULL, 1, 0, 1, NULL, NULL, file };
+
+  if (yyparse(&context) != 0) return 0;
+  *top = context.top;
+  return 1;
+}
+
+//-----------------------------
+//      Finding the pieces
+//-----------------------------
+
+struct piece {
+  const char            *start;
+  const char            *end;
+  int                    line;
+  struct parse_context   context;
+  struct statement_list *tail;    // Node holding the first statement.
+  int                    ok;
+};
+
+// Cuts the text of 'loaded' into pieces of about 'target' bytes at the
+// ends of top level statements. Returns the number of pieces, or zero if
+// the text can't be split (for example because the blocks don't nest).
+//
+static int find_pieces(
+  const struct scanner *loaded, size_t target, struct piece **pieces)
+{
+  struct scanner s;
+  YYSTYPE value;
+  YYLTYPE location;
+  int   capacity = 16, count = 1;
+  int   depth = 0;            // Nesting of blocks.
+  int   declare = 0;          // In the DECLARE block at the top?
+  int   expression = 0;       // In the condition of a top level REPEAT?
+  int   parentheses = 0;      // Open parentheses in that condition.
+  int   operand = 0;          // Did the condition's last token end an operand?
+  int   boundary = 0;         // Did the last token end a top level statement?
+  int   token;
+  const char *piece_start = loaded->position;
+
+  *pieces = (struct piece *)malloc(capacity * sizeof(struct piece));
+  (*pieces)[0].start = loaded->position;
+  (*pieces)[0].line  = loaded->line;
+
+  scanner_init(&s, loaded->position, loaded->end - loaded->position, loaded->line);
+  s.values = 0;
+  while ((token = scan_token(&s, &value, &location)) != 0) {
+
+    // A REPEAT's condition ends after an operand that isn't followed by AND
+    // or OR. It can't be found from the block structure alone.
+    if (expression) {
+      if (parentheses == 0 && operand && token != AND && token != OR) {
+        expression = 0;
+        boundary = 1;
+      }
+      else {
+        if (token == '(') ++parentheses;
+        else if (token == ')') --parentheses;
+        operand = token == EP || token == ')';
+        continue;
+      }
+    }
+
+    // A COST or BOUND and its phrase belong to the statement before them
+    // (see cost.h), so the statement only ends after the phrase.
+    if (token == COST || token == BOUND) boundary = 0;
+
+    if (boundary && (size_t)(s.token_start - piece_start) >= target) {
+      if (count == capacity) {
+        capacity *= 2;
+        *pieces = (struct piece *)realloc(*pieces, capacity * sizeof(struct piece));
+      }
+      (*pieces)[count - 1].end = s.token_start;
+      (*pieces)[count].start = s.token_start;
+      (*pieces)[count].line  = location.first_line;
+      piece_start = s.token_start;
+      ++count;
+    }
+    boundary = 0;
+
+    switch (token) {
+      case DECLARE:
+        if (depth == 0) declare = 1;
+        ++depth;
+        break;
+
+      case IF: case FOR: case FOREACH: case WHILE: case REPEAT:
+      case SWITCH: case CASE: case DEFAULT: case OF: case PARALLEL:
+        ++depth;
+        break;
+
+      case END:
+        if (--depth == 0) {
+          if (declare) declare = 0;
+          else boundary = 1;
+        }
+        break;
+
+      case UNTIL:
+        if (--depth == 0) {
+          expression  = 1;
+          parentheses = 0;
+          operand     = 0;
+        }
+        break;
+
+      case EP: case BREAK: case CONTINUE: case RETURN:
+        if (depth == 0) boundary = 1;
+        break;
+    }
+    if (depth < 0) {
+      count = 0;
+      break;
+    }
+  }
+  if (count > 0) (*pieces)[count - 1].end = loaded->end;
+  scanner_close(&s);
+  return count;
+}
+
+//-----------------------------
+//      Parsing the pieces
+//-----------------------------
+
+struct parse_worker {
+  pthread_t     thread;
+  struct piece *pieces;
+  int           first;
+  int           step;
+  int           count;
+  const char   *file;
+};
+
+static void *worker_main(void *argument)
+{
+  struct parse_worker *w = (struct parse_worker *)argument;
+  struct scanner s;
+  int i;
+
+  for (i = w->first; i < w->count; i += w->step) {
+    struct piece *p = &w->pieces[i];
+    scanner_init(&s, p->start, p->end - p->start, p->line);
+    p->context.scanner       = &s;
+    p->context.top           = NULL;
+    p->context.line          = p->line;
+    p->context.quiet         = 1;
+    p->context.allow_declare = i == 0;
+    p->context.observe       = NULL;
+    p->context.observer      = NULL;
+    p->context.file          = w->file;
+    p->ok = yyparse(&p->context) == 0;
+    scanner_close(&s);
+
+    // The list ends (at its first statement) with a node whose 'first' is
+    // NULL. The list of the pieces before this one will hang there.
+    if (p->ok) {
+      for (p->tail = p->context.top; p->tail->first != NULL; p->tail = p->tail->first)
+        ;
+    }
+  }
+  return NULL;
+}
+
+
+int parse_parallel(
+  struct scanner *scanner, const char *file, int threads, struct statement_list **top)
+{
+  struct piece        *pieces;
+  struct parse_worker *workers;
+  size_t length = scanner->end - scanner->position;
+  int    count, i, ok = 1;
+
+  if (threads < 2 || length < PARALLEL_MINIMUM) return parse_program(scanner, file, top);
+  count = find_pieces(scanner, length / (threads * PIECES_PER_THREAD), &pieces);
+  if (count < 2) {
+    free(pieces);
+    return parse_program(scanner, file, top);
+  }
+  if (threads > count) threads = count;
+
+  // Worker 0 runs on this thread.
+  workers = (struct parse_worker *)calloc(threads, sizeof(struct parse_worker));
+  for (i = 0; i < threads; ++i) {
+    workers[i].pieces = pieces;
+    workers[i].first  = i;
+    workers[i].step   = threads;
+    workers[i].count  = count;
+    workers[i].file   = file;
+  }
+  for (i = 1; i < threads; ++i) {
+    if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) {
+      printf("Unable to start parsing thread %d.\n", i);
+      exit(EXIT_FAILURE);
+    }
+  }
+  worker_main(&workers[0]);
+  for (i = 1; i < threads; ++i) pthread_join(workers[i].thread, NULL);
+
+  for (i = 0; i < count; ++i) {
+    if (!pieces[i].ok) ok = 0;
+  }
+
+  if (ok) {
+    for (i = 1; i < count; ++i) pieces[i].tail->first = pieces[i - 1].context.top;
+    *top = pieces[count - 1].context.top;
+  }
+
+  free(workers);
+  free(pieces);
+
+  // The trees of the pieces that did parse are lost here, as the parser
+  // loses a partial tree on any syntax error.
+  if (!ok) return parse_program(scanner, file, top);
+  return 1;
+}
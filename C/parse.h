@@ -0,0 +1,92 @@
+/****************************************************************************
+FILE          : parse.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the parser drivers.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The Bison parser is reentrant: all the state of one parse is in its
+parse_context. This makes it possible to cut a large input into pieces
+at the boundaries between top level statements and parse the pieces at
+the same time.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef PARSE_H
+#define PARSE_H
+
+#include "vtcstr.h"
+#include "pcode.tab.h"
+#include "scan.h"
+#include "tree.h"
+
+enum parse_problem { SYNTAX_PROBLEM, IMPORT_PROBLEM };
+
+struct parse_context {
+  struct scanner        *scanner;        // NULL to use the Flex scanner.
+  struct statement_list *top;            // The result.
+  int                    line;           // Current line (for error messages).
+  int                    quiet;          // Don't report syntax errors.
+  int                    allow_declare;  // May the text start with DECLARE?
+
+  // If set, called with each token before the parser sees it.
+  void (*observe)(int token, const YYLTYPE *location, void *data);
+  void  *observer;
+
+  // The file being parsed, for messages and to find the files it imports
+  // (see module.h). NULL for standard input.
+  const char            *file;
+
+  // If set, errors are passed here instead of being printed (a quiet
+  // parse reports nothing either way). Imported files are parsed with the
+  // same reporter.
+  void (*report)(enum parse_problem problem,
+                 const char *file, int line, const char *message, void *data);
+  void  *reporter;
+};
+
+// If set, the Flex scanner calls this with the text of each comment.
+extern void (*comment_hook)(const char *text, int line);
+
+// The Bison parser.
+int yyparse(struct parse_context *context);
+
+// Used by the parser.
+int  pcode_lex(YYSTYPE *value, YYLTYPE *location, struct parse_context *context);
+void yyerror(const YYLTYPE *location, struct parse_context *context, const char *message);
+
+// Reports an error at a line of the file being parsed, unless the parse
+// is quiet.
+void parse_complain(
+  const struct parse_context *context, enum parse_problem problem, int line,
+  const char *message);
+
+// Returns the phrase of a COST or BOUND on 'line' if it can be read (see
+// read_estimate() in tree.h). Otherwise reports it, releases it and
+// returns NULL.
+vtc_string *check_estimate(const struct parse_context *context, vtc_string *phrase, int line);
+
+// Returns zero, after reporting it, if a branch of a PARALLEL ends with
+// a REPEAT whose condition ends with an AND outside parentheses. That
+// AND may be the one that should have started the next branch.
+int check_branch(const struct parse_context *context, const struct statement_list *branch);
+
+// Parse a whole program, reporting any syntax error. With a NULL scanner
+// the Flex scanner reads yyin. The file name (which may be NULL) is used
+// in messages and to find imported files. Returns zero if there is a
+// syntax error.
+int parse_program(
+  struct scanner *scanner, const char *file, struct statement_list **top);
+
+// Like parse_program() but large inputs are cut at top level statement
+// boundaries and the pieces are parsed by several threads. The tree and
+// any error message are the same as parse_program() would give.
+int parse_parallel(
+  struct scanner *scanner, const char *file, int threads, struct statement_list **top);
+
+#endif
@@ -0,0 +1,797 @@
+/****************************************************************************
+FILE          : pcdiff.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Structural difference between two versions of a program.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Usage: pcdiff [-J] old.pcd new.pcd
+
+Both versions are parsed and their statements (and the branches of each
+SWITCH) are matched. The differences are then listed as an edit script:
+statements deleted, inserted, moved, or updated (the same statement with
+a different phrase or condition). Layout, comments, letter case and the
+spacing within phrases make no difference. With -J the script is written
+as JSON. The exit status is 0 if the versions are the same, 1 if they
+differ, and 2 if either can't be read.
+
+The matching is done in three passes, each close to linear in the size
+of the programs:
+
+1. Every subtree is hashed (its kind, its phrases and its children). A
+   subtree whose hash occurs exactly once in each version is matched
+   whole, starting from the largest.
+
+2. Working up from the leaves, a block that isn't matched yet is matched
+   to the block of the same kind holding most of the partners of its
+   children.
+
+3. Working down from the top, the unmatched children of matched nodes
+   are matched to unmatched children nearby in the other version that
+   are identical, have the same phrase, or have similar wording.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+#include "module.h"
+#include "parse.h"
+#include "scan.h"
+#include "tree.h"
+
+// Node kinds beyond the statement types.
+#define CASE_KIND (PARALLELtype + 1)
+#define ROOT_KIND (PARALLELtype + 2)
+
+// Unmatched children are looked for this far from where they would be.
+#define WINDOW 64
+
+// Wording at least this similar (shared words) counts as an update.
+#define SIMILAR 0.5
+
+// A statement or a case branch.
+struct node {
+  int       kind;
+  int       line;
+  int       module;      // File of the line (see module.h).
+  int       parent;
+  int       slot;        // 0: first list, 1: ELSE list, 2: case branches.
+  int       index;       // Position among the children of the parent.
+  int       size;        // Nodes in the subtree.
+  int       first_child; // In the children array.
+  int       child_count;
+  int       partner;     // Matched node in the other version or -1.
+  uint64_t  label;       // Hash of the kind and the normalized phrases.
+  uint64_t  hash;        // Hash of the whole subtree.
+  char     *text;        // The phrase or condition as written.
+};
+
+// One version of the program, with its nodes in preorder.
+struct version {
+  const char  *name;
+  struct node *nodes;
+  int          count;
+  int          capacity;
+  int         *children;
+};
+
+enum edit_type { DELETE, INSERT, MOVE, UPDATE };
+
+struct edit {
+  enum edit_type type;
+  int            old_node;   // -1 for an insertion.
+  int            new_node;   // -1 for a deletion.
+};
+
+struct script {
+  struct edit *edits;
+  int          count;
+  int          capacity;
+};
+
+static const char *edit_names[] = { "delete", "insert", "move", "update" };
+
+//----------------------------
+//      Building the nodes
+//----------------------------
+
+static uint64_t mix(uint64_t x)
+{
+  x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+
+static uint64_t combine(uint64_t h, uint64_t value)
+{
+  return mix(h ^ (value + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2)));
+}
+
+
+// A growing string.
+struct text {
+  char  *buffer;
+  size_t length;
+  size_t capacity;
+};
+
+static void append(struct text *t, const char *s)
+{
+  size_t length = strlen(s);
+
+  if (t->length + length + 1 > t->capacity) {
+    t->capacity = 2 * (t->length + length + 1);
+    t->buffer = (char *)realloc(t->buffer, t->capacity);
+  }
+  memcpy(t->buffer + t->length, s, length + 1);
+  t->length += length;
+}
+
+
+// Writes a condition and hashes it with the phrase IDs (which are the
+// same for both versions, since they share the phrase table).
+static uint64_t render_condition(struct text *t, struct expression *e, enum operation outer)
+{
+  uint64_t h = e->op;
+  int parenthesize;
+
+  switch (e->op) {
+    case PASSop:
+      return render_condition(t, e->first, outer);
+
+    case PROMPTop:
+      append(t, vtc_string_getcharp(e->ep));
+      return combine(h, e->phrase);
+
+    case NOTop:
+      append(t, "NOT ");
+      return combine(h, render_condition(t, e->first, NOTop));
+
+    case ANDop:
+    case ORop:
+      parenthesize = outer != PASSop && outer != e->op;
+      if (parenthesize) append(t, "(");
+      h = combine(h, render_condition(t, e->first, e->op));
+      append(t, e->op == ANDop ? " AND " : " OR ");
+      h = combine(h, render_condition(t, e->second, e->op));
+      if (parenthesize) append(t, ")");
+      return h;
+  }
+  return h;
+}
+
+
+static int new_node(struct version *v, int kind, int line, int module, int parent, int slot)
+{
+  struct node *n;
+
+  if (v->count == v->capacity) {
+    v->capacity = v->capacity ? 2 * v->capacity : 1024;
+    v->nodes = (struct node *)realloc(v->nodes, v->capacity * sizeof(struct node));
+  }
+  n = &v->nodes[v->count];
+  memset(n, 0, sizeof(*n));
+  n->kind    = kind;
+  n->line    = line;
+  n->module  = module;
+  n->parent  = parent;
+  n->slot    = slot;
+  n->partner = -1;
+  return v->count++;
+}
+
+
+static void add_list(struct version *v, struct statement_list *list, int parent, int slot);
+
+static void add_statement(struct version *v, struct statement *s, int parent, int slot)
+{
+  struct text       t = { NULL, 0, 0 };
+  struct case_list *cl;
+  uint64_t          label = s->type;
+  int               number = new_node(v, s->type, s->line, s->module, parent, slot);
+  int               i, count = 0;
+
+  append(&t, "");
+  if (s->type != EPtype) append(&t, statement_type_name(s->type));
+  if (s->ep != NULL) {
+    if (s->type != EPtype) append(&t, " ");
+    append(&t, vtc_string_getcharp(s->ep));
+    label = combine(label, s->phrase);
+  }
+  if (s->conditional != NULL) {
+    append(&t, s->type == REPEATtype ? " UNTIL " : " ");
+    label = combine(label, render_condition(&t, s->conditional, PASSop));
+  }
+  if (s->estimate != NULL) {
+    append(&t, s->type == EPtype ? " COST " : " BOUND ");
+    append(&t, vtc_string_getcharp(s->estimate));
+    label = combine(label,
+      intern_phrase(vtc_string_getcharp(s->estimate), vtc_string_length(s->estimate)));
+  }
+  v->nodes[number].text  = t.buffer;
+  v->nodes[number].label = label;
+
+  add_list(v, s->first, number, 0);
+  add_list(v, s->second, number, 1);
+
+  // The case list is left recursive: the last case written is at the
+  // head. The cases are added in source order.
+  for (cl = s->cl; cl != NULL; cl = cl->first) ++count;
+  {
+    struct case_branch **cases =
+      (struct case_branch **)malloc((count + 1) * sizeof(struct case_branch *));
+
+    for (cl = s->cl, i = count - 1; cl != NULL; cl = cl->first, --i) cases[i] = cl->second;
+    for (i = 0; i < count; ++i) {
+      struct case_branch *b = cases[i];
+      int branch = new_node(v, CASE_KIND, b->line, b->module, number, 2);
+      struct text bt = { NULL, 0, 0 };
+
+      if (b->case_condition != NULL) {
+        append(&bt, "CASE ");
+        append(&bt, vtc_string_getcharp(b->case_condition));
+      }
+      else if (s->type == PARALLELtype) {
+        append(&bt, "AND");
+      }
+      else {
+        append(&bt, "DEFAULT");
+      }
+      v->nodes[branch].text  = bt.buffer;
+      v->nodes[branch].label = combine(CASE_KIND, b->phrase);
+      add_list(v, b->first, branch, 0);
+    }
+    free(cases);
+  }
+}
+
+
+static void add_list(struct version *v, struct statement_list *list, int parent, int slot)
+{
+  int i;
+
+  if (list == NULL) return;
+  for (i = 0; i < list->count; ++i) add_statement(v, list->items[i], parent, slot);
+}
+
+
+// Fills in the children, sizes and hashes once all the nodes exist.
+static void finish_version(struct version *v)
+{
+  struct node *nodes = v->nodes;
+  int *next = (int *)calloc(v->count + 1, sizeof(int));
+  int  i, j, total = 0;
+
+  for (i = 1; i < v->count; ++i) ++nodes[nodes[i].parent].child_count;
+  for (i = 0; i < v->count; ++i) {
+    nodes[i].first_child = total;
+    next[i] = total;
+    total += nodes[i].child_count;
+  }
+  v->children = (int *)malloc((total + 1) * sizeof(int));
+
+  // In preorder the children of a node come in source order.
+  for (i = 1; i < v->count; ++i) {
+    int p = nodes[i].parent;
+    nodes[i].index = next[p] - nodes[p].first_child;
+    v->children[next[p]++] = i;
+  }
+
+  // Children come after their parents, so this works from the leaves up.
+  for (i = v->count - 1; i >= 0; --i) {
+    struct node *n = &nodes[i];
+    uint64_t h = n->label;
+
+    n->size = 1;
+    for (j = 0; j < n->child_count; ++j) {
+      struct node *c = &nodes[v->children[n->first_child + j]];
+      n->size += c->size;
+      h = combine(h, combine(c->slot, c->hash));
+    }
+    n->hash = h;
+  }
+  free(next);
+}
+
+
+static int read_version(struct version *v, const char *name)
+{
+  struct scanner         scanner;
+  struct statement_list *top;
+  struct tree_info       info;
+  FILE *in;
+  int   parsed;
+
+  memset(v, 0, sizeof(*v));
+  v->name = name;
+  if ((in = fopen(name, "r")) == NULL) {
+    printf("Unable to open %s for input.\n", name);
+    return 0;
+  }
+  parsed = scanner_read(&scanner, in);
+  fclose(in);
+  if (!parsed) {
+    printf("Unable to read %s.\n", name);
+    return 0;
+  }
+  parsed = parse_program(&scanner, name, &top);
+  scanner_close(&scanner);
+  if (!parsed) {
+    printf("%s has a syntax error.\n", name);
+    return 0;
+  }
+  prepare_tree(top, &info);
+  new_node(v, ROOT_KIND, 0, 0, -1, 0);
+  v->nodes[0].text  = strcpy((char *)malloc(1), "");
+  v->nodes[0].label = ROOT_KIND;
+  add_list(v, top, 0, 0);
+  free_tree(top, &info);
+  finish_version(v);
+  return 1;
+}
+
+//-----------------
+//      Matching
+//-----------------
+
+static void match(struct version *old, int o, struct version *new, int n)
+{
+  old->nodes[o].partner = n;
+  new->nodes[n].partner = o;
+}
+
+
+// Identical subtrees have the same nodes in the same (pre)order.
+static void match_subtree(struct version *old, int o, struct version *new, int n)
+{
+  int i;
+
+  for (i = 0; i < old->nodes[o].size; ++i) match(old, o + i, new, n + i);
+}
+
+
+struct hash_slot {
+  uint64_t hash;
+  int      old_count;
+  int      new_count;
+  int      new_node;
+};
+
+// Pass 1: subtrees that are unique in both versions.
+static void match_unique(struct version *old, struct version *new)
+{
+  size_t size = 1, mask, slot;
+  struct hash_slot *table;
+  int i;
+
+  while (size < 2 * (size_t)(old->count + new->count)) size *= 2;
+  mask  = size - 1;
+  table = (struct hash_slot *)calloc(size, sizeof(struct hash_slot));
+
+  for (i = 0; i < old->count + new->count; ++i) {
+    struct node *n = i < old->count ? &old->nodes[i] : &new->nodes[i - old->count];
+
+    for (slot = n->hash & mask; table[slot].old_count + table[slot].new_count > 0 &&
+         table[slot].hash != n->hash; slot = (slot + 1) & mask) ;
+    table[slot].hash = n->hash;
+    if (i < old->count) ++table[slot].old_count;
+    else {
+      ++table[slot].new_count;
+      table[slot].new_node = i - old->count;
+    }
+  }
+
+  // In preorder a subtree is seen before the subtrees inside it. A match
+  // skips them.
+  for (i = 1; i < old->count; ) {
+    struct node *n = &old->nodes[i];
+
+    for (slot = n->hash & mask; table[slot].hash != n->hash; slot = (slot + 1) & mask) ;
+    if (table[slot].old_count == 1 && table[slot].new_count == 1 &&
+        new->nodes[table[slot].new_node].partner < 0) {
+      match_subtree(old, i, new, table[slot].new_node);
+      i += n->size;
+    }
+    else {
+      ++i;
+    }
+  }
+  free(table);
+}
+
+
+static int compare_ints(const void *left, const void *right)
+{
+  int l = *(const int *)left, r = *(const int *)right;
+
+  return l < r ? -1 : l > r;
+}
+
+
+// Pass 2: blocks, matched to where most of their children went.
+static void match_blocks(struct version *old, struct version *new)
+{
+  int *votes = NULL;
+  int  capacity = 0, i, j;
+
+  for (i = old->count - 1; i > 0; --i) {
+    struct node *n = &old->nodes[i];
+    int count = 0, best = -1, best_votes = 0, run;
+
+    if (n->partner >= 0 || n->child_count == 0) continue;
+    if (n->child_count > capacity) {
+      capacity = 2 * n->child_count;
+      votes = (int *)realloc(votes, capacity * sizeof(int));
+    }
+    for (j = 0; j < n->child_count; ++j) {
+      int partner = old->nodes[old->children[n->first_child + j]].partner;
+      if (partner >= 0) votes[count++] = new->nodes[partner].parent;
+    }
+    qsort(votes, count, sizeof(int), compare_ints);
+    for (j = 0; j < count; j += run) {
+      for (run = 1; j + run < count && votes[j + run] == votes[j]; ++run) ;
+      if (run > best_votes) {
+        best = votes[j];
+        best_votes = run;
+      }
+    }
+    if (best > 0 && new->nodes[best].partner < 0 && new->nodes[best].kind == n->kind &&
+        2 * best_votes >= count) {
+      match(old, i, new, best);
+    }
+  }
+  free(votes);
+}
+
+
+// The share of words the two texts have in common.
+static double similarity(const char *a, const char *b)
+{
+  uint64_t words[2][WINDOW];
+  int      counts[2] = { 0, 0 };
+  int      common = 0, i, j;
+  const char *texts[2] = { a, b };
+
+  for (i = 0; i < 2; ++i) {
+    const char *p = texts[i];
+    while (*p != '\0' && counts[i] < WINDOW) {
+      uint64_t h = 0;
+      if (!isalnum((unsigned char)*p)) {
+        ++p;
+        continue;
+      }
+      for (; isalnum((unsigned char)*p); ++p) h = combine(h, tolower((unsigned char)*p));
+      words[i][counts[i]++] = h;
+    }
+  }
+  if (counts[0] + counts[1] == 0) return 1.0;
+  for (i = 0; i < counts[0]; ++i) {
+    for (j = 0; j < counts[1]; ++j) {
+      if (words[0][i] == words[1][j]) {
+        ++common;
+        break;
+      }
+    }
+  }
+  return 2.0 * common / (counts[0] + counts[1]);
+}
+
+
+// Pass 3: the children of each matched pair. For each unmatched child in
+// the new version, the unmatched children of the old one between the
+// partners of its matched neighbors are candidates.
+static void match_children(struct version *old, struct version *new)
+{
+  int n, j, k;
+
+  for (n = 0; n < new->count; ++n) {
+    struct node *np = &new->nodes[n];
+    struct node *op;
+
+    if (np->partner < 0 || np->child_count == 0) continue;
+    op = &old->nodes[np->partner];
+    if (op->child_count == 0) continue;
+
+    for (j = 0; j < np->child_count; ++j) {
+      int child = new->children[np->first_child + j];
+      struct node *c = &new->nodes[child];
+      int low = 0, high = op->child_count, best = -1;
+      double best_score = 0.0;
+
+      if (c->partner >= 0) continue;
+
+      // The window is bounded by the partners of the nearest matched
+      // siblings, if they are children of the old node.
+      for (k = j - 1; k >= 0; --k) {
+        int p = new->nodes[new->children[np->first_child + k]].partner;
+        if (p >= 0) {
+          if (old->nodes[p].parent == np->partner) low = old->nodes[p].index + 1;
+          break;
+        }
+      }
+      for (k = j + 1; k < np->child_count; ++k) {
+        int p = new->nodes[new->children[np->first_child + k]].partner;
+        if (p >= 0) {
+          if (old->nodes[p].parent == np->partner) high = old->nodes[p].index;
+          break;
+        }
+      }
+      if (high <= low) {
+        low  = 0;
+        high = op->child_count;
+      }
+      if (high - low > WINDOW) high = low + WINDOW;
+
+      for (k = low; k < high; ++k) {
+        int candidate = old->children[op->first_child + k];
+        struct node *o = &old->nodes[candidate];
+        double score;
+
+        if (o->partner >= 0 || o->kind != c->kind || o->slot != c->slot) continue;
+        if (o->hash == c->hash) score = 3.0;
+        else if (o->label == c->label) score = 2.0;
+        else score = similarity(o->text, c->text);
+        if (score > best_score) {
+          best = candidate;
+          best_score = score;
+        }
+      }
+      if (best < 0 || best_score < SIMILAR) continue;
+      if (best_score == 3.0) match_subtree(old, best, new, child);
+      else match(old, best, new, child);
+    }
+  }
+}
+
+//---------------------------
+//      The edit script
+//---------------------------
+
+static void add_edit(struct script *s, enum edit_type type, int old_node, int new_node)
+{
+  if (s->count == s->capacity) {
+    s->capacity = s->capacity ? 2 * s->capacity : 64;
+    s->edits = (struct edit *)realloc(s->edits, s->capacity * sizeof(struct edit));
+  }
+  s->edits[s->count].type     = type;
+  s->edits[s->count].old_node = old_node;
+  s->edits[s->count].new_node = new_node;
+  ++s->count;
+}
+
+
+// Marks the children of a new node that keep their order: the longest
+// increasing run of the positions of their partners. Children not in it
+// were moved.
+static void find_reordered(
+  struct version *old, struct version *new, int n, char *moved, int *positions, int *tails,
+  int *previous, int *members)
+{
+  struct node *np = &new->nodes[n];
+  int count = 0, length = 0, i, low, high, k;
+
+  for (i = 0; i < np->child_count; ++i) {
+    int child = new->children[np->first_child + i];
+    int p = new->nodes[child].partner;
+
+    if (p < 0 || old->nodes[p].parent != np->partner ||
+        old->nodes[p].slot != new->nodes[child].slot) continue;
+    members[count] = child;
+    positions[count++] = old->nodes[p].index;
+  }
+
+  // Patience method for the longest increasing subsequence.
+  for (i = 0; i < count; ++i) {
+    low = 0;
+    high = length;
+    while (low < high) {
+      int middle = (low + high) / 2;
+      if (positions[tails[middle]] < positions[i]) low = middle + 1;
+      else high = middle;
+    }
+    previous[i] = low > 0 ? tails[low - 1] : -1;
+    tails[low] = i;
+    if (low == length) ++length;
+  }
+  for (i = 0; i < count; ++i) moved[members[i]] = 1;
+  for (k = length > 0 ? tails[length - 1] : -1; k >= 0; k = previous[k]) {
+    moved[members[k]] = 0;
+  }
+}
+
+
+static void build_script(struct version *old, struct version *new, struct script *s)
+{
+  char *moved = (char *)calloc(new->count + 1, 1);
+  int  *scratch = (int *)malloc(4 * (new->count + 1) * sizeof(int));
+  int   i;
+
+  for (i = 0; i < new->count; ++i) {
+    struct node *n = &new->nodes[i];
+    if (n->partner < 0) continue;
+    if (i > 0 && (n->parent < 0 || new->nodes[n->parent].partner != old->nodes[n->partner].parent ||
+                  n->slot != old->nodes[n->partner].slot)) {
+      moved[i] = 1;
+    }
+    if (n->child_count > 0) {
+      find_reordered(old, new, i, moved, scratch, scratch + new->count + 1,
+        scratch + 2 * (new->count + 1), scratch + 3 * (new->count + 1));
+    }
+  }
+
+  // Deletions first, in the order of the old version, then the rest in
+  // the order of the new. Only the top of a deleted or inserted subtree
+  // is listed.
+  for (i = 1; i < old->count; ++i) {
+    struct node *o = &old->nodes[i];
+    if (o->partner < 0 && old->nodes[o->parent].partner >= 0) add_edit(s, DELETE, i, -1);
+  }
+  for (i = 1; i < new->count; ++i) {
+    struct node *n = &new->nodes[i];
+    if (n->partner < 0) {
+      if (new->nodes[n->parent].partner >= 0) add_edit(s, INSERT, -1, i);
+      continue;
+    }
+    if (moved[i]) add_edit(s, MOVE, n->partner, i);
+    if (n->label != old->nodes[n->partner].label) add_edit(s, UPDATE, n->partner, i);
+  }
+  free(scratch);
+  free(moved);
+}
+
+//-----------------
+//      Output
+//-----------------
+
+static const char *kind_name(int kind)
+{
+  if (kind == CASE_KIND) return "CASE";
+  return statement_type_name((enum statement_type)kind);
+}
+
+
+// The line of a node, with the file it is in if it was imported.
+static const char *where(const struct node *n, char *buffer, size_t size)
+{
+  return line_label(buffer, size, n->module, n->line);
+}
+
+
+static void write_human(struct version *old, struct version *new, const struct script *s)
+{
+  int counts[4] = { 0, 0, 0, 0 };
+  char from[300], to[300];
+  int i;
+
+  for (i = 0; i < s->count; ++i) {
+    const struct edit *e = &s->edits[i];
+    struct node *o = e->old_node >= 0 ? &old->nodes[e->old_node] : NULL;
+    struct node *n = e->new_node >= 0 ? &new->nodes[e->new_node] : NULL;
+
+    ++counts[e->type];
+    switch (e->type) {
+      case DELETE:
+        printf("- %s: %s", where(o, from, sizeof(from)), o->text);
+        if (o->size > 1) printf(" (%d statements)", o->size);
+        printf("\n");
+        break;
+
+      case INSERT:
+        printf("+ %s: %s", where(n, to, sizeof(to)), n->text);
+        if (n->size > 1) printf(" (%d statements)", n->size);
+        printf("\n");
+        break;
+
+      case MOVE:
+        printf("> %s -> %s: %s\n",
+          where(o, from, sizeof(from)), where(n, to, sizeof(to)), n->text);
+        break;
+
+      case UPDATE:
+        printf("~ %s -> %s: %s\n",
+          where(o, from, sizeof(from)), where(n, to, sizeof(to)), o->text);
+        printf("    => %s\n", n->text);
+        break;
+    }
+  }
+  printf("%d deleted, %d inserted, %d moved, %d updated.\n",
+    counts[DELETE], counts[INSERT], counts[MOVE], counts[UPDATE]);
+}
+
+
+static void write_json_string(const char *s)
+{
+  putchar('"');
+  for (; *s != '\0'; ++s) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\') printf("\\%c", c);
+    else if (c == '\n') printf("\\n");
+    else if (c == '\t') printf("\\t");
+    else if (c < ' ') printf("\\u%04x", c);
+    else putchar(c);
+  }
+  putchar('"');
+}
+
+
+static void write_json(struct version *old, struct version *new, const struct script *s)
+{
+  int i;
+
+  printf("{\"old\": ");
+  write_json_string(old->name);
+  printf(", \"new\": ");
+  write_json_string(new->name);
+  printf(", \"edits\": [");
+  for (i = 0; i < s->count; ++i) {
+    const struct edit *e = &s->edits[i];
+    struct node *o = e->old_node >= 0 ? &old->nodes[e->old_node] : NULL;
+    struct node *n = e->new_node >= 0 ? &new->nodes[e->new_node] : NULL;
+    struct node *subject = n != NULL ? n : o;
+
+    printf("%s\n  {\"op\": \"%s\", \"kind\": \"%s\"", i ? "," : "", edit_names[e->type],
+      kind_name(subject->kind));
+    if (o != NULL) printf(", \"old_line\": %d", o->line);
+    if (o != NULL && o->module != 0) {
+      printf(", \"old_module\": ");
+      write_json_string(module_name(o->module));
+    }
+    if (n != NULL) printf(", \"new_line\": %d", n->line);
+    if (n != NULL && n->module != 0) {
+      printf(", \"new_module\": ");
+      write_json_string(module_name(n->module));
+    }
+    if (e->type == UPDATE) {
+      printf(", \"old_text\": ");
+      write_json_string(o->text);
+      printf(", \"new_text\": ");
+      write_json_string(n->text);
+    }
+    else {
+      printf(", \"text\": ");
+      write_json_string(subject->text);
+      printf(", \"size\": %d", subject->size);
+    }
+    printf("}");
+  }
+  printf("%s]}\n", s->count ? "\n" : "");
+}
+
+
+int main(int argc, char **argv)
+{
+  struct version old, new;
+  struct script  script = { NULL, 0, 0 };
+  int json = 0;
+
+  if (argc > 1 && strcmp(argv[1], "-J") == 0) {
+    json = 1;
+    ++argv;
+    --argc;
+  }
+  if (argc != 3) {
+    printf("Usage: pcdiff [-J] old.pcd new.pcd\n");
+    return 2;
+  }
+  if (!read_version(&old, argv[1]) || !read_version(&new, argv[2])) return 2;
+
+  match(&old, 0, &new, 0);
+  match_unique(&old, &new);
+  match_blocks(&old, &new);
+  match_children(&old, &new);
+  build_script(&old, &new, &script);
+
+  if (json) write_json(&old, &new, &script);
+  else write_human(&old, &new, &script);
+  return script.count > 0 ? 1 : 0;
+}
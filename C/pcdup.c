@@ -0,0 +1,857 @@
+/****************************************************************************
+FILE          : pcdup.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Find near duplicate phrases and blocks in a collection of programs.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Usage: pcdup [-j threads] [-t similarity] [-b bands] [-s size] [-n count] path...
+
+Every .pcd file named on the command line or found under a named
+directory is parsed, on several threads. Each distinct phrase, and each
+block (IF, loop or SWITCH) of at least 'size' statements, is reduced to a
+MinHash signature: for each of SIGNATURE_SIZE hash functions, the
+smallest hash of any of its shingles. Phrase shingles are the three
+letter pieces of the normalized phrase; block shingles are runs of three
+words and keywords. The fraction of positions where two signatures agree
+estimates the Jaccard similarity of the shingle sets.
+
+Comparing every pair would take far too long on a large collection, so
+the signatures are cut into bands and only items that agree on a whole
+band are compared (locality sensitive hashing). Items found to be
+similar are joined into clusters, and the largest clusters are reported.
+A block is only reported if it isn't simply part of a larger duplicate.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "intern.h"
+#include "parse.h"
+#include "scan.h"
+#include "tree.h"
+
+#define SIGNATURE_SIZE 32
+
+// Only the first few members of each cluster are listed.
+#define MEMBERS_SHOWN 12
+
+// Something that might have near duplicates: a phrase or a block.
+struct item {
+  int      file;        // Where a block is, or where a phrase is first used.
+  int      line;
+  int      kind;        // Statement type of a block.
+  int      size;        // Statements in a block.
+  int      parent;      // Enclosing block or -1.
+  int      phrase;      // Phrase ID or -1.
+  long     uses;        // Of a phrase.
+  uint32_t signature[SIGNATURE_SIZE];
+};
+
+struct item_list {
+  struct item *items;
+  int          count;
+  int          capacity;
+};
+
+// One use of a phrase.
+struct use {
+  int phrase;
+  int file;
+  int line;
+};
+
+// Two items found to be similar.
+struct pair {
+  int first;
+  int second;
+};
+
+// Words and keywords of a block, as hashes, in order.
+struct tokens {
+  uint64_t *hashes;
+  int       count;
+  int       capacity;
+};
+
+struct options {
+  int    threads;
+  double similarity;
+  int    bands;
+  int    block_size;
+  int    clusters;
+};
+
+// The state shared by the threads of each phase.
+struct shared {
+  const struct options *options;
+  char           **paths;
+  int              file_count;
+  int              next_file;     // Next file to parse (taken atomically).
+  pthread_mutex_t  lock;          // The phrase table isn't thread safe.
+  struct item     *items;         // Being signed or compared.
+  int              item_count;
+  int              failed;
+};
+
+struct worker {
+  pthread_t         thread;
+  struct shared    *shared;
+  int               number;
+  struct item_list  blocks;
+  struct use       *uses;
+  long              use_count;
+  long              use_capacity;
+  struct tokens     tokens;
+  int               statements;   // Visited so far.
+  struct pair      *pairs;
+  long              pair_count;
+  long              pair_capacity;
+};
+
+static uint64_t seeds[SIGNATURE_SIZE];
+
+//-------------------
+//      Signatures
+//-------------------
+
+static uint64_t mix(uint64_t x)
+{
+  x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+
+static uint64_t hash_bytes(const char *text, int length)
+{
+  uint64_t h = 0xCBF29CE484222325ULL;
+
+  while (length-- > 0) h = (h ^ (unsigned char)*text++) * 0x100000001B3ULL;
+  return h;
+}
+
+
+static void start_signature(uint32_t *signature)
+{
+  int i;
+
+  for (i = 0; i < SIGNATURE_SIZE; ++i) signature[i] = UINT32_MAX;
+}
+
+
+static void add_shingle(uint32_t *signature, uint64_t shingle)
+{
+  int i;
+
+  for (i = 0; i < SIGNATURE_SIZE; ++i) {
+    uint32_t h = (uint32_t)(mix(shingle ^ seeds[i]) >> 32);
+    if (h < signature[i]) signature[i] = h;
+  }
+}
+
+
+// The shingles of a phrase are its three letter pieces, with a space at
+// each end so that the beginnings and ends of words count.
+static void sign_phrase(struct item *item)
+{
+  const char *key = phrase_key(item->phrase);
+  char        text[4096];
+  int         length, i;
+
+  length = snprintf(text, sizeof(text), " %s ", key + 1);
+  if (length >= (int)sizeof(text)) length = sizeof(text) - 1;
+  text[length - 2] = ' ';      // Replaces the ']'.
+  --length;
+  start_signature(item->signature);
+  if (length < 3) add_shingle(item->signature, hash_bytes(text, length));
+  for (i = 0; i + 3 <= length; ++i) add_shingle(item->signature, hash_bytes(text + i, 3));
+}
+
+
+static void add_token(struct tokens *t, const char *text, int length)
+{
+  if (t->count == t->capacity) {
+    t->capacity = t->capacity ? 2 * t->capacity : 256;
+    t->hashes = (uint64_t *)realloc(t->hashes, t->capacity * sizeof(uint64_t));
+  }
+  t->hashes[t->count++] = hash_bytes(text, length);
+}
+
+
+// Adds the words of a phrase in lower case.
+static void add_phrase_tokens(struct tokens *t, vtc_string *phrase)
+{
+  const char *p = vtc_string_getcharp(phrase);
+  char word[256];
+  int  length;
+
+  while (*p != '\0') {
+    if (!isalnum((unsigned char)*p)) {
+      ++p;
+      continue;
+    }
+    for (length = 0; isalnum((unsigned char)*p); ++p) {
+      if (length < (int)sizeof(word)) word[length++] = tolower((unsigned char)*p);
+    }
+    add_token(t, word, length);
+  }
+}
+
+
+static void add_keyword(struct tokens *t, const char *keyword)
+{
+  add_token(t, keyword, strlen(keyword));
+}
+
+
+static void add_condition_tokens(struct tokens *t, struct expression *e)
+{
+  switch (e->op) {
+    case PASSop:   add_condition_tokens(t, e->first); break;
+    case PROMPTop: add_phrase_tokens(t, e->ep); break;
+    case NOTop:
+      add_keyword(t, "NOT");
+      add_condition_tokens(t, e->first);
+      break;
+    case ANDop:
+    case ORop:
+      add_condition_tokens(t, e->first);
+      add_keyword(t, e->op == ANDop ? "AND" : "OR");
+      add_condition_tokens(t, e->second);
+      break;
+  }
+}
+
+
+static void sign_tokens(struct item *item, const struct tokens *t)
+{
+  int i;
+
+  start_signature(item->signature);
+  if (t->count < 3) {
+    add_shingle(item->signature, t->count > 0 ? t->hashes[0] : 0);
+    return;
+  }
+  for (i = 0; i + 3 <= t->count; ++i) {
+    add_shingle(item->signature,
+      mix(t->hashes[i] ^ mix(t->hashes[i + 1] ^ mix(t->hashes[i + 2]))));
+  }
+}
+
+//------------------
+//      Parsing
+//------------------
+
+static void add_use(struct worker *w, int phrase, int file, int line)
+{
+  if (phrase < 0) return;
+  if (w->use_count == w->use_capacity) {
+    w->use_capacity = w->use_capacity ? 2 * w->use_capacity : 4096;
+    w->uses = (struct use *)realloc(w->uses, w->use_capacity * sizeof(struct use));
+  }
+  w->uses[w->use_count].phrase = phrase;
+  w->uses[w->use_count].file   = file;
+  w->uses[w->use_count].line   = line;
+  ++w->use_count;
+}
+
+
+static struct item *new_item(struct item_list *list)
+{
+  struct item *item;
+
+  if (list->count == list->capacity) {
+    list->capacity = list->capacity ? 2 * list->capacity : 256;
+    list->items = (struct item *)realloc(list->items, list->capacity * sizeof(struct item));
+  }
+  item = &list->items[list->count++];
+  memset(item, 0, sizeof(*item));
+  item->parent = -1;
+  item->phrase = -1;
+  return item;
+}
+
+
+static void record_uses(struct worker *w, struct expression *e, int file, int line)
+{
+  if (e == NULL) return;
+  add_use(w, e->phrase, file, line);
+  record_uses(w, e->first,  file, line);
+  record_uses(w, e->second, file, line);
+}
+
+
+static void visit_list(struct worker *w, struct statement_list *list, int file, int parent);
+
+// Records the uses of phrases in a statement. If it is a block that is
+// large enough, an item is made for it: its tokens are the words and
+// keywords written from where the block starts.
+static void visit_statement(struct worker *w, struct statement *s, int file, int parent)
+{
+  struct tokens    *t = &w->tokens;
+  struct case_list *cl;
+  int first_token = t->count;
+  int first_statement = w->statements++;
+  int block;
+
+  add_keyword(t, statement_type_name(s->type));
+  add_use(w, s->phrase, file, s->line);
+  if (s->ep != NULL) add_phrase_tokens(t, s->ep);
+  record_uses(w, s->conditional, file, s->type == REPEATtype ? s->end_line : s->line);
+  if (s->conditional != NULL) add_condition_tokens(t, s->conditional);
+  if (s->first == NULL && s->cl == NULL) return;
+
+  // The size isn't known until the children are visited, so the item is
+  // made now and dropped later if the block is too small.
+  block = w->blocks.count;
+  new_item(&w->blocks);
+  w->blocks.items[block].file   = file;
+  w->blocks.items[block].line   = s->line;
+  w->blocks.items[block].kind   = s->type;
+  w->blocks.items[block].parent = parent;
+
+  visit_list(w, s->first, file, block);
+  if (s->second != NULL) {
+    add_keyword(t, "ELSE");
+    visit_list(w, s->second, file, block);
+  }
+  for (cl = s->cl; cl != NULL; cl = cl->first) {
+    add_keyword(t, s->type == PARALLELtype ? "AND" : "CASE");
+    add_use(w, cl->second->phrase, file, cl->second->line);
+    if (cl->second->case_condition != NULL) add_phrase_tokens(t, cl->second->case_condition);
+    visit_list(w, cl->second->first, file, block);
+  }
+  add_keyword(t, "END");
+  w->blocks.items[block].size = w->statements - first_statement;
+  {
+    struct tokens part = { t->hashes + first_token, t->count - first_token, 0 };
+    sign_tokens(&w->blocks.items[block], &part);
+  }
+}
+
+
+// Statements brought in by IMPORT belong to the imported file and are
+// left out here (see module.h).
+static void visit_list(struct worker *w, struct statement_list *list, int file, int parent)
+{
+  int i;
+
+  if (list == NULL) return;
+  for (i = 0; i < list->count; ++i) {
+    if (list->items[i]->module == 0) visit_statement(w, list->items[i], file, parent);
+  }
+}
+
+
+// Blocks smaller than the minimum are removed and the parents renumbered.
+static void keep_large_blocks(struct worker *w, int first, int minimum)
+{
+  struct item *items = w->blocks.items;
+  int *nearest = (int *)malloc((w->blocks.count - first + 1) * sizeof(int));
+  int  count = first, i, outer;
+
+  // Parents come before their children. The nearest block that is kept
+  // (itself or an ancestor) is remembered for each block.
+  for (i = first; i < w->blocks.count; ++i) {
+    outer = items[i].parent < 0 ? -1 : nearest[items[i].parent - first];
+    if (items[i].size < minimum) {
+      nearest[i - first] = outer;
+      continue;
+    }
+    nearest[i - first] = count;
+    items[count] = items[i];
+    items[count].parent = outer;
+    ++count;
+  }
+  w->blocks.count = count;
+  free(nearest);
+}
+
+
+static int parse_file(struct worker *w, int file)
+{
+  struct shared         *shared = w->shared;
+  struct scanner         scanner;
+  struct statement_list *top;
+  struct tree_info       info;
+  FILE *in;
+  int   parsed, first = w->blocks.count;
+
+  if ((in = fopen(shared->paths[file], "r")) == NULL) return 0;
+  parsed = scanner_read(&scanner, in);
+  fclose(in);
+  if (!parsed) return 0;
+  parsed = parse_program(&scanner, shared->paths[file], &top);
+  scanner_close(&scanner);
+  if (!parsed) return 0;
+
+  pthread_mutex_lock(&shared->lock);
+  prepare_tree(top, &info);
+  pthread_mutex_unlock(&shared->lock);
+  w->tokens.count = 0;
+  visit_list(w, top, file, -1);
+  keep_large_blocks(w, first, shared->options->block_size);
+  free_tree(top, &info);
+  return 1;
+}
+
+
+static void *parse_worker(void *argument)
+{
+  struct worker *w = (struct worker *)argument;
+  int file;
+
+  while ((file = __atomic_fetch_add(&w->shared->next_file, 1, __ATOMIC_RELAXED)) <
+         w->shared->file_count) {
+    if (!parse_file(w, file)) {
+      printf("%s was not examined.\n", w->shared->paths[file]);
+      __atomic_fetch_add(&w->shared->failed, 1, __ATOMIC_RELAXED);
+    }
+  }
+  return NULL;
+}
+
+
+// The phrase items are signed after all the files are read, since until
+// then the phrase table may be changing.
+static void *sign_worker(void *argument)
+{
+  struct worker *w = (struct worker *)argument;
+  struct shared *shared = w->shared;
+  int i;
+
+  for (i = w->number; i < shared->item_count; i += shared->options->threads) {
+    sign_phrase(&shared->items[i]);
+  }
+  return NULL;
+}
+
+//---------------------
+//      Clustering
+//---------------------
+
+struct bucket_entry {
+  uint64_t hash;
+  int      item;
+};
+
+static int compare_entries(const void *left, const void *right)
+{
+  const struct bucket_entry *l = (const struct bucket_entry *)left;
+  const struct bucket_entry *r = (const struct bucket_entry *)right;
+
+  if (l->hash != r->hash) return l->hash < r->hash ? -1 : 1;
+  return l->item - r->item;
+}
+
+
+static double similarity(const struct item *a, const struct item *b)
+{
+  int agree = 0, i;
+
+  for (i = 0; i < SIGNATURE_SIZE; ++i) agree += a->signature[i] == b->signature[i];
+  return (double)agree / SIGNATURE_SIZE;
+}
+
+
+// Whether one block encloses the other. A block's signature holds all
+// the tokens of the blocks nested in it, so the two often look alike.
+static int nested(const struct item *items, int first, int second)
+{
+  int p;
+
+  for (p = items[second].parent; p >= 0; p = items[p].parent) {
+    if (p == first) return 1;
+  }
+  for (p = items[first].parent; p >= 0; p = items[p].parent) {
+    if (p == second) return 1;
+  }
+  return 0;
+}
+
+
+static void add_pair(struct worker *w, int first, int second)
+{
+  if (w->pair_count == w->pair_capacity) {
+    w->pair_capacity = w->pair_capacity ? 2 * w->pair_capacity : 1024;
+    w->pairs = (struct pair *)realloc(w->pairs, w->pair_capacity * sizeof(struct pair));
+  }
+  w->pairs[w->pair_count].first  = first;
+  w->pairs[w->pair_count].second = second;
+  ++w->pair_count;
+}
+
+
+// Items that agree on a whole band are candidates. Each candidate is
+// compared with the first item of its bucket only, so a bucket holding
+// many items costs no more than its size.
+static void *band_worker(void *argument)
+{
+  struct worker  *w = (struct worker *)argument;
+  struct shared  *shared = w->shared;
+  const struct options *options = shared->options;
+  int rows = SIGNATURE_SIZE / options->bands;
+  int n = shared->item_count;
+  struct bucket_entry *entries = (struct bucket_entry *)malloc((n + 1) * sizeof(struct bucket_entry));
+  int band, i, j, head;
+
+  for (band = w->number; band < options->bands; band += options->threads) {
+    for (i = 0; i < n; ++i) {
+      entries[i].hash = hash_bytes(
+        (const char *)&shared->items[i].signature[band * rows], rows * sizeof(uint32_t));
+      entries[i].item = i;
+    }
+    qsort(entries, n, sizeof(struct bucket_entry), compare_entries);
+    for (i = 0; i < n; i = j) {
+      head = entries[i].item;
+      for (j = i + 1; j < n && entries[j].hash == entries[i].hash; ++j) {
+        if (!nested(shared->items, head, entries[j].item) &&
+            similarity(&shared->items[head], &shared->items[entries[j].item]) >=
+            options->similarity) {
+          add_pair(w, head, entries[j].item);
+        }
+      }
+    }
+  }
+  free(entries);
+  return NULL;
+}
+
+
+static int find_root(int *parent, int i)
+{
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+
+static void run_workers(struct worker *workers, int threads, void *(*function)(void *))
+{
+  int i;
+
+  for (i = 1; i < threads; ++i) {
+    if (pthread_create(&workers[i].thread, NULL, function, &workers[i]) != 0) {
+      printf("Unable to start thread %d.\n", i);
+      exit(EXIT_FAILURE);
+    }
+  }
+  function(&workers[0]);
+  for (i = 1; i < threads; ++i) pthread_join(workers[i].thread, NULL);
+}
+
+
+// Joins similar items. Returns the cluster (root item) of each item.
+static int *cluster(struct shared *shared, struct worker *workers)
+{
+  int  threads = shared->options->threads;
+  int *parent = (int *)malloc((shared->item_count + 1) * sizeof(int));
+  int  i;
+  long j;
+
+  for (i = 0; i < shared->item_count; ++i) parent[i] = i;
+  for (i = 0; i < threads; ++i) workers[i].pair_count = 0;
+  run_workers(workers, threads, band_worker);
+  for (i = 0; i < threads; ++i) {
+    for (j = 0; j < workers[i].pair_count; ++j) {
+      int a = find_root(parent, workers[i].pairs[j].first);
+      int b = find_root(parent, workers[i].pairs[j].second);
+      if (a != b) parent[a < b ? b : a] = a < b ? a : b;
+    }
+  }
+  for (i = 0; i < shared->item_count; ++i) parent[i] = find_root(parent, i);
+  return parent;
+}
+
+//------------------
+//      Reporting
+//------------------
+
+// Used while sorting.
+static const int         *sorting_root;
+static const long        *sorting_weight;
+static const struct item *sorting_items;
+
+// Members of the heaviest clusters first; within a cluster, the most
+// used phrase or the earliest block first.
+static int compare_members(const void *left, const void *right)
+{
+  int l = *(const int *)left, r = *(const int *)right;
+  int lr = sorting_root[l], rr = sorting_root[r];
+  const struct item *a = &sorting_items[l], *b = &sorting_items[r];
+
+  if (lr != rr) {
+    if (sorting_weight[lr] != sorting_weight[rr]) {
+      return sorting_weight[lr] > sorting_weight[rr] ? -1 : 1;
+    }
+    return lr - rr;
+  }
+  if (a->uses != b->uses) return a->uses > b->uses ? -1 : 1;
+  if (a->file != b->file) return a->file - b->file;
+  return a->line - b->line;
+}
+
+
+static void report(
+  const char *title, struct item *items, int count, const int *root,
+  char **paths, const struct options *options)
+{
+  long *weight  = (long *)calloc(count + 1, sizeof(long));
+  int  *members = (int *)calloc(count + 1, sizeof(int));
+  int  *outer   = (int *)malloc((count + 1) * sizeof(int));
+  int  *order   = (int *)malloc((count + 1) * sizeof(int));
+  char *encloses = (char *)calloc(count + 1, 1);
+  int   clusters = 0, shown = 0, total = 0, i, j, k, p, r;
+
+  // A block joined to its cluster only through a block nested in it is
+  // left out; the inner block stands for both.
+  for (i = 0; i < count; ++i) {
+    for (p = items[i].parent; p >= 0; p = items[p].parent) {
+      if (root[p] == root[i]) encloses[p] = 1;
+    }
+  }
+  for (i = 0; i < count; ++i) {
+    outer[i] = -2;
+    if (encloses[i]) continue;
+    ++members[root[i]];
+    weight[root[i]] += items[i].phrase >= 0 ? items[i].uses : items[i].size;
+  }
+
+  // A block cluster whose members all sit in the members of one other
+  // cluster adds nothing. The outer cluster of each is found (-1 if
+  // there isn't exactly one).
+  for (i = 0; i < count; ++i) {
+    r = root[i];
+    p = items[i].parent;
+    if (encloses[i] || outer[r] == -1) continue;
+    if (p < 0 || root[p] == r || members[root[p]] < 2) outer[r] = -1;
+    else if (outer[r] == -2) outer[r] = root[p];
+    else if (outer[r] != root[p]) outer[r] = -1;
+  }
+  for (i = 0; i < count; ++i) {
+    if (items[i].phrase < 0 && outer[root[i]] >= 0) members[root[i]] = 0;
+  }
+
+  k = 0;
+  for (i = 0; i < count; ++i) {
+    if (!encloses[i] && members[root[i]] >= 2) order[k++] = i;
+  }
+  sorting_root = root;
+  sorting_weight = weight;
+  sorting_items = items;
+  qsort(order, k, sizeof(int), compare_members);
+  for (i = 0; i < count; ++i) {
+    if (root[i] == i && members[i] >= 2) {
+      ++clusters;
+      total += members[i];
+    }
+  }
+
+  printf("\n%s: %d cluster%s of %d near duplicates.\n",
+    title, clusters, clusters == 1 ? "" : "s", total);
+  for (i = 0; i < k && shown < options->clusters; i = j) {
+    int r = root[order[i]];
+
+    ++shown;
+    if (items[order[i]].phrase >= 0) {
+      printf("\n%d phrases used %ld times:\n", members[r], weight[r]);
+    }
+    else {
+      printf("\n%d blocks of about %ld statements:\n", members[r], weight[r] / members[r]);
+    }
+    for (j = i; j < k && root[order[j]] == r; ++j) {
+      const struct item *item = &items[order[j]];
+
+      if (j - i == MEMBERS_SHOWN) printf("  (and %d more)\n", members[r] - MEMBERS_SHOWN);
+      if (j - i >= MEMBERS_SHOWN) continue;
+      if (item->phrase >= 0) {
+        printf("  %-50s %5ld  %s:%d\n", phrase_text(item->phrase), item->uses,
+          paths[item->file], item->line);
+      }
+      else {
+        printf("  %s:%d: %s (%d statements)\n", paths[item->file], item->line,
+          statement_type_name(item->kind), item->size);
+      }
+    }
+  }
+  if (shown < clusters) printf("\n(%d more clusters not shown.)\n", clusters - shown);
+
+  free(encloses);
+  free(order);
+  free(outer);
+  free(members);
+  free(weight);
+}
+
+//-----------------------
+//      Finding files
+//-----------------------
+
+static void add_path(struct shared *shared, int *capacity, const char *path)
+{
+  if (shared->file_count == *capacity) {
+    *capacity = *capacity ? 2 * *capacity : 64;
+    shared->paths = (char **)realloc(shared->paths, *capacity * sizeof(char *));
+  }
+  shared->paths[shared->file_count++] = strcpy((char *)malloc(strlen(path) + 1), path);
+}
+
+
+// Adds the .pcd files under a directory. Hidden entries are skipped.
+static void find_programs(struct shared *shared, int *capacity, const char *directory)
+{
+  DIR           *dir;
+  struct dirent *entry;
+  struct stat    status;
+  char          *path;
+  size_t         length;
+
+  if ((dir = opendir(directory)) == NULL) return;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.') continue;
+    path = (char *)malloc(strlen(directory) + strlen(entry->d_name) + 2);
+    sprintf(path, "%s/%s", directory, entry->d_name);
+    length = strlen(entry->d_name);
+    if (stat(path, &status) == 0) {
+      if (S_ISDIR(status.st_mode)) find_programs(shared, capacity, path);
+      else if (S_ISREG(status.st_mode) && length > 4 &&
+               strcmp(entry->d_name + length - 4, ".pcd") == 0) {
+        add_path(shared, capacity, path);
+      }
+    }
+    free(path);
+  }
+  closedir(dir);
+}
+
+
+static int compare_paths(const void *left, const void *right)
+{
+  return strcmp(*(char * const *)left, *(char * const *)right);
+}
+
+
+int main(int argc, char **argv)
+{
+  struct options  options;
+  struct shared   shared;
+  struct worker  *workers;
+  struct item_list phrases = { NULL, 0, 0 }, blocks = { NULL, 0, 0 };
+  struct stat     status;
+  long  cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int   capacity = 0, phrase_total, i, j;
+  int  *root;
+  long  k;
+  char  option, *value;
+
+  options.threads    = cpus > 0 ? (int)cpus : 1;
+  options.similarity = 0.6;
+  options.bands      = 8;
+  options.block_size = 4;
+  options.clusters   = 20;
+  memset(&shared, 0, sizeof(shared));
+  shared.options = &options;
+
+  while (*++argv != NULL) {
+    if (**argv != '-') {
+      if (stat(*argv, &status) != 0) printf("Unable to find %s.\n", *argv);
+      else if (S_ISDIR(status.st_mode)) find_programs(&shared, &capacity, *argv);
+      else add_path(&shared, &capacity, *argv);
+      continue;
+    }
+    option = (*argv)[1];
+    value  = (*argv)[2] != '\0' ? *argv + 2 : *++argv;
+    if (value == NULL) {
+      printf("Option -%c requires an argument.\n", option);
+      return 1;
+    }
+    switch (option) {
+      case 'j': options.threads    = atoi(value); break;
+      case 't': options.similarity = atof(value); break;
+      case 'b': options.bands      = atoi(value); break;
+      case 's': options.block_size = atoi(value); break;
+      case 'n': options.clusters   = atoi(value); break;
+      default:
+        printf("Unrecognized option: %c (ignored)\n", option);
+        break;
+    }
+  }
+  if (shared.file_count == 0) {
+    printf("Usage: pcdup [-j threads] [-t similarity] [-b bands] [-s size] [-n count] path...\n");
+    return 1;
+  }
+  if (options.threads < 1) options.threads = 1;
+  if (options.bands < 1 || options.bands > SIGNATURE_SIZE) options.bands = 8;
+  qsort(shared.paths, shared.file_count, sizeof(char *), compare_paths);
+  for (i = 0; i < SIGNATURE_SIZE; ++i) seeds[i] = mix(i + 1);
+  pthread_mutex_init(&shared.lock, NULL);
+
+  workers = (struct worker *)calloc(options.threads, sizeof(struct worker));
+  for (i = 0; i < options.threads; ++i) {
+    workers[i].shared = &shared;
+    workers[i].number = i;
+  }
+  run_workers(workers, options.threads, parse_worker);
+
+  // One item for each phrase, placed where it is first used.
+  phrase_total = phrase_count();
+  for (i = 0; i < phrase_total; ++i) {
+    struct item *item = new_item(&phrases);
+    item->phrase = i;
+    item->file   = shared.file_count;
+  }
+  for (i = 0; i < options.threads; ++i) {
+    for (k = 0; k < workers[i].use_count; ++k) {
+      const struct use *u = &workers[i].uses[k];
+      struct item *item = &phrases.items[u->phrase];
+
+      ++item->uses;
+      if (u->file < item->file || (u->file == item->file && u->line < item->line)) {
+        item->file = u->file;
+        item->line = u->line;
+      }
+    }
+  }
+  shared.items      = phrases.items;
+  shared.item_count = phrases.count;
+  run_workers(workers, options.threads, sign_worker);
+
+  // The blocks of all the workers, with their parents renumbered.
+  for (i = 0; i < options.threads; ++i) {
+    int offset = blocks.count;
+
+    for (j = 0; j < workers[i].blocks.count; ++j) {
+      struct item *item = new_item(&blocks);
+      *item = workers[i].blocks.items[j];
+      if (item->parent >= 0) item->parent += offset;
+    }
+  }
+
+  printf("Examined %d files: %d distinct phrases, %d blocks of %d or more statements.\n",
+    shared.file_count - shared.failed, phrases.count, blocks.count, options.block_size);
+  root = cluster(&shared, workers);
+  report("Phrases", phrases.items, phrases.count, root, shared.paths, &options);
+  free(root);
+
+  shared.items      = blocks.items;
+  shared.item_count = blocks.count;
+  root = cluster(&shared, workers);
+  report("Blocks", blocks.items, blocks.count, root, shared.paths, &options);
+  free(root);
+  return shared.failed ? 1 : 0;
+}
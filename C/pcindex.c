@@ -0,0 +1,704 @@
+/****************************************************************************
+FILE          : pcindex.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Index of the phrases used in a collection of programs.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Usage: pcindex [-i index] update path...
+       pcindex [-i index] query term...
+
+The update command parses every .pcd file named on the command line or
+found under a named directory and records where each phrase, and each
+word of each phrase, is used. Files that were indexed before and have
+not changed since (same size and modification time) are not parsed
+again, and files that no longer exist are dropped. The query command
+lists the places where a phrase (written in brackets) or a word is used;
+with several terms it lists the lines where all of them are used.
+
+Phrases are compared in the normalized form of the phrase table, so
+letter case and the spacing of words don't matter. The statements a
+file brings in by IMPORT aren't indexed with it: they are indexed with
+the imported file, if that is in the collection.
+
+The index is one file: a header, the table of files, the table of terms
+in sorted order, the postings (term, file, line, kind) sorted by term,
+and the text of the paths and terms. It is written in the byte order of
+the machine and loaded with a single read.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <ctype.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "intern.h"
+#include "parse.h"
+#include "scan.h"
+#include "tree.h"
+
+#define INDEX_MAGIC   "PCIX"
+#define INDEX_VERSION 3
+
+// The kind of a posting is the type of the statement using the phrase,
+// or this for a CASE.
+#define CASE_KIND (PARALLELtype + 1)
+
+struct index_header {
+  char magic[4];
+  int  version;
+  int  file_count;
+  int  term_count;
+  int  posting_count;
+  int  string_size;
+};
+
+struct index_file {
+  int       path;       // Offset in the strings.
+  int       pad;
+  long long mtime;
+  long long size;
+};
+
+struct index_term {
+  int text;             // Offset in the strings.
+  int first;            // First posting.
+  int count;
+};
+
+struct posting {
+  int term;
+  int file;
+  int line;
+  int kind;
+};
+
+// A loaded index. The pointers point into one buffer.
+struct index {
+  char                *buffer;
+  struct index_header  header;
+  struct index_file   *files;
+  struct index_term   *terms;
+  struct posting      *postings;
+  const char          *strings;
+  int                  outdated;  // Written by another version, so loaded empty.
+};
+
+// An index being built.
+struct builder {
+  char          **paths;
+  long long      *mtimes;
+  long long      *sizes;
+  int             file_count;
+  int             file_capacity;
+
+  char          **terms;          // Text of each term.
+  int            *slots;          // Hash table: term number or -1.
+  int             term_count;
+  int             slot_count;
+
+  struct posting *postings;
+  long            posting_count;
+  long            posting_capacity;
+};
+
+// A file found on the command line or in a directory.
+struct found {
+  char    **paths;
+  int       count;
+  int       capacity;
+};
+
+static const char *index_name = "pcode.idx";
+
+//-------------------------
+//      Loading an index
+//-------------------------
+
+// Returns zero if the file exists but isn't an index. A missing file, or
+// an index of another version (which is marked), gives an empty index,
+// so that an update indexes every file again.
+static int load_index(const char *name, struct index *index)
+{
+  FILE  *in;
+  long   size;
+  size_t offset;
+
+  memset(index, 0, sizeof(*index));
+  if ((in = fopen(name, "rb")) == NULL) return 1;
+  fseek(in, 0, SEEK_END);
+  size = ftell(in);
+  rewind(in);
+  index->buffer = (char *)malloc(size + 1);
+  if (size < (long)sizeof(struct index_header) ||
+      fread(index->buffer, 1, size, in) != (size_t)size) {
+    fclose(in);
+    return 0;
+  }
+  fclose(in);
+
+  memcpy(&index->header, index->buffer, sizeof(struct index_header));
+  if (memcmp(index->header.magic, INDEX_MAGIC, 4) != 0) return 0;
+  if (index->header.version != INDEX_VERSION) {
+    free(index->buffer);
+    memset(index, 0, sizeof(*index));
+    index->outdated = 1;
+    return 1;
+  }
+  offset = sizeof(struct index_header);
+  index->files = (struct index_file *)(index->buffer + offset);
+  offset += index->header.file_count * sizeof(struct index_file);
+  index->terms = (struct index_term *)(index->buffer + offset);
+  offset += index->header.term_count * sizeof(struct index_term);
+  index->postings = (struct posting *)(index->buffer + offset);
+  offset += index->header.posting_count * sizeof(struct posting);
+  index->strings = index->buffer + offset;
+  if (offset + index->header.string_size != (size_t)size) return 0;
+  return 1;
+}
+
+
+// Returns the number of a term or -1 if it isn't in the index.
+static int find_term(const struct index *index, const char *text)
+{
+  int low = 0, high = index->header.term_count - 1;
+
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    int result = strcmp(text, index->strings + index->terms[middle].text);
+
+    if (result == 0) return middle;
+    if (result < 0) high = middle - 1;
+    else low = middle + 1;
+  }
+  return -1;
+}
+
+//--------------------------
+//      Building an index
+//--------------------------
+
+static unsigned long hash_text(const char *text)
+{
+  unsigned long h = 5381;
+
+  while (*text) h = h * 33 + (unsigned char)*text++;
+  return h;
+}
+
+
+static int add_term(struct builder *b, const char *text, int length)
+{
+  unsigned long slot;
+  int i;
+
+  if (2 * (b->term_count + 1) > b->slot_count) {
+    int    old_count = b->slot_count;
+    int   *old_slots = b->slots;
+
+    b->slot_count = old_count ? 2 * old_count : 1024;
+    b->slots = (int *)malloc(b->slot_count * sizeof(int));
+    b->terms = (char **)realloc(b->terms, b->slot_count / 2 * sizeof(char *));
+    for (i = 0; i < b->slot_count; ++i) b->slots[i] = -1;
+    for (i = 0; i < old_count; ++i) {
+      if (old_slots[i] < 0) continue;
+      slot = hash_text(b->terms[old_slots[i]]) & (b->slot_count - 1);
+      while (b->slots[slot] >= 0) slot = (slot + 1) & (b->slot_count - 1);
+      b->slots[slot] = old_slots[i];
+    }
+    free(old_slots);
+  }
+
+  // The text may not be terminated where the term ends.
+  {
+    char *term = (char *)malloc(length + 1);
+
+    memcpy(term, text, length);
+    term[length] = '\0';
+    slot = hash_text(term) & (b->slot_count - 1);
+    while (b->slots[slot] >= 0) {
+      if (strcmp(b->terms[b->slots[slot]], term) == 0) {
+        free(term);
+        return b->slots[slot];
+      }
+      slot = (slot + 1) & (b->slot_count - 1);
+    }
+    b->terms[b->term_count] = term;
+    b->slots[slot] = b->term_count;
+    return b->term_count++;
+  }
+}
+
+
+static int add_file(struct builder *b, const char *path, long long mtime, long long size)
+{
+  if (b->file_count == b->file_capacity) {
+    b->file_capacity = b->file_capacity ? 2 * b->file_capacity : 64;
+    b->paths  = (char **)realloc(b->paths, b->file_capacity * sizeof(char *));
+    b->mtimes = (long long *)realloc(b->mtimes, b->file_capacity * sizeof(long long));
+    b->sizes  = (long long *)realloc(b->sizes, b->file_capacity * sizeof(long long));
+  }
+  b->paths[b->file_count]  = strcpy((char *)malloc(strlen(path) + 1), path);
+  b->mtimes[b->file_count] = mtime;
+  b->sizes[b->file_count]  = size;
+  return b->file_count++;
+}
+
+
+static void add_posting(struct builder *b, int term, int file, int line, int kind)
+{
+  struct posting *p;
+
+  if (b->posting_count == b->posting_capacity) {
+    b->posting_capacity = b->posting_capacity ? 2 * b->posting_capacity : 4096;
+    b->postings = (struct posting *)
+      realloc(b->postings, b->posting_capacity * sizeof(struct posting));
+  }
+  p = &b->postings[b->posting_count++];
+  p->term = term;
+  p->file = file;
+  p->line = line;
+  p->kind = kind;
+}
+
+
+// Records a phrase (by its phrase table ID) and each of its words.
+static void add_phrase(struct builder *b, int phrase, int file, int line, int kind)
+{
+  const char *key = phrase_key(phrase);
+  const char *p, *word;
+
+  add_posting(b, add_term(b, key, strlen(key)), file, line, kind);
+  for (p = key; *p != '\0'; ) {
+    if (!isalnum((unsigned char)*p)) {
+      ++p;
+      continue;
+    }
+    for (word = p; isalnum((unsigned char)*p); ++p) ;
+    add_posting(b, add_term(b, word, p - word), file, line, kind);
+  }
+}
+
+
+static void add_condition(struct builder *b, struct expression *e, int file, struct statement *s)
+{
+  if (e == NULL) return;
+  if (e->op == PROMPTop) add_phrase(b, e->phrase, file, s->line, s->type);
+  add_condition(b, e->first,  file, s);
+  add_condition(b, e->second, file, s);
+}
+
+
+// Parses one program and adds its postings. Returns zero if the file
+// can't be read or has a syntax error.
+static int index_program(struct builder *b, const char *path, int file)
+{
+  struct scanner         scanner;
+  struct statement_list *top;
+  struct tree_info       info;
+  FILE *in;
+  int   parsed, i;
+
+  if ((in = fopen(path, "r")) == NULL) return 0;
+  parsed = scanner_read(&scanner, in);
+  fclose(in);
+  if (!parsed) return 0;
+  parsed = parse_program(&scanner, path, &top);
+  scanner_close(&scanner);
+  if (!parsed) return 0;
+
+  prepare_tree(top, &info);
+  for (i = 0; i < info.statement_count; ++i) {
+    struct statement *s = info.statements[i];
+
+    if (s->module != 0) continue;
+    if (s->phrase >= 0) add_phrase(b, s->phrase, file, s->line, s->type);
+    add_condition(b, s->conditional, file, s);
+  }
+  for (i = 0; i < info.case_count; ++i) {
+    struct case_branch *branch = info.cases[i];
+
+    if (branch->module == 0 && branch->phrase >= 0) {
+      add_phrase(b, branch->phrase, file, branch->line, CASE_KIND);
+    }
+  }
+  free_tree(top, &info);
+  return 1;
+}
+
+
+// Copies the postings of the files that are kept from the old index.
+// The new number of each old file is in kept (or -1).
+static void copy_postings(struct builder *b, const struct index *old, const int *kept)
+{
+  int t, i;
+
+  for (t = 0; t < old->header.term_count; ++t) {
+    const struct index_term *term = &old->terms[t];
+    const char *text = old->strings + term->text;
+    int new_term = -1;
+
+    for (i = term->first; i < term->first + term->count; ++i) {
+      const struct posting *p = &old->postings[i];
+
+      if (kept[p->file] < 0) continue;
+      if (new_term < 0) new_term = add_term(b, text, strlen(text));
+      add_posting(b, new_term, kept[p->file], p->line, p->kind);
+    }
+  }
+}
+
+//-------------------------
+//      Writing an index
+//-------------------------
+
+static char **sorting_terms;
+
+static int compare_term_numbers(const void *left, const void *right)
+{
+  return strcmp(sorting_terms[*(const int *)left], sorting_terms[*(const int *)right]);
+}
+
+
+static int compare_postings(const void *left, const void *right)
+{
+  const struct posting *l = (const struct posting *)left;
+  const struct posting *r = (const struct posting *)right;
+
+  if (l->term != r->term) return l->term < r->term ? -1 : 1;
+  if (l->file != r->file) return l->file < r->file ? -1 : 1;
+  if (l->line != r->line) return l->line < r->line ? -1 : 1;
+  return l->kind - r->kind;
+}
+
+
+// Sorts the terms and postings and writes the index. The new index is
+// written beside the old one and renamed over it.
+static int write_index(struct builder *b, const char *name)
+{
+  struct index_header header;
+  struct index_file  *files = (struct index_file *)calloc(b->file_count + 1, sizeof(struct index_file));
+  struct index_term  *terms = (struct index_term *)calloc(b->term_count + 1, sizeof(struct index_term));
+  int  *order = (int *)malloc((b->term_count + 1) * sizeof(int));
+  int  *rank  = (int *)malloc((b->term_count + 1) * sizeof(int));
+  char *temporary = (char *)malloc(strlen(name) + 5);
+  long  count = 0, i;
+  int   strings = 0, t, ok;
+  FILE *out;
+
+  for (t = 0; t < b->term_count; ++t) order[t] = t;
+  sorting_terms = b->terms;
+  qsort(order, b->term_count, sizeof(int), compare_term_numbers);
+  for (t = 0; t < b->term_count; ++t) rank[order[t]] = t;
+  for (i = 0; i < b->posting_count; ++i) b->postings[i].term = rank[b->postings[i].term];
+  qsort(b->postings, b->posting_count, sizeof(struct posting), compare_postings);
+
+  // Remove duplicates (a phrase used twice on one line) and fill in the
+  // ranges of the terms.
+  for (i = 0; i < b->posting_count; ++i) {
+    if (count > 0 && compare_postings(&b->postings[count - 1], &b->postings[i]) == 0) continue;
+    b->postings[count++] = b->postings[i];
+  }
+  b->posting_count = count;
+  for (i = 0; i < count; ++i) {
+    struct index_term *term = &terms[b->postings[i].term];
+
+    if (term->count++ == 0) term->first = i;
+  }
+
+  for (i = 0; i < b->file_count; ++i) {
+    files[i].path  = strings;
+    files[i].mtime = b->mtimes[i];
+    files[i].size  = b->sizes[i];
+    strings += strlen(b->paths[i]) + 1;
+  }
+  for (t = 0; t < b->term_count; ++t) {
+    terms[t].text = strings;
+    strings += strlen(b->terms[order[t]]) + 1;
+  }
+
+  memcpy(header.magic, INDEX_MAGIC, 4);
+  header.version       = INDEX_VERSION;
+  header.file_count    = b->file_count;
+  header.term_count    = b->term_count;
+  header.posting_count = count;
+  header.string_size   = strings;
+
+  sprintf(temporary, "%s.new", name);
+  if ((out = fopen(temporary, "wb")) == NULL) {
+    printf("Unable to open %s for output.\n", temporary);
+    ok = 0;
+  }
+  else {
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(files, sizeof(struct index_file), b->file_count, out);
+    fwrite(terms, sizeof(struct index_term), b->term_count, out);
+    fwrite(b->postings, sizeof(struct posting), count, out);
+    for (i = 0; i < b->file_count; ++i) fwrite(b->paths[i], strlen(b->paths[i]) + 1, 1, out);
+    for (t = 0; t < b->term_count; ++t) {
+      fwrite(b->terms[order[t]], strlen(b->terms[order[t]]) + 1, 1, out);
+    }
+    ok = !ferror(out);
+    if (fclose(out) != 0) ok = 0;
+    if (ok && rename(temporary, name) != 0) ok = 0;
+    if (!ok) {
+      printf("Error writing %s.\n", name);
+      remove(temporary);
+    }
+  }
+
+  free(temporary);
+  free(rank);
+  free(order);
+  free(terms);
+  free(files);
+  return ok;
+}
+
+//------------------------
+//      The update command
+//------------------------
+
+static void add_found(struct found *found, const char *path)
+{
+  if (found->count == found->capacity) {
+    found->capacity = found->capacity ? 2 * found->capacity : 64;
+    found->paths = (char **)realloc(found->paths, found->capacity * sizeof(char *));
+  }
+  found->paths[found->count++] = strcpy((char *)malloc(strlen(path) + 1), path);
+}
+
+
+static int has_suffix(const char *name, const char *suffix)
+{
+  size_t length = strlen(name), suffix_length = strlen(suffix);
+
+  return length > suffix_length && strcmp(name + length - suffix_length, suffix) == 0;
+}
+
+
+// Adds the .pcd files under a directory. Hidden entries are skipped.
+static void find_programs(struct found *found, const char *directory)
+{
+  DIR           *dir;
+  struct dirent *entry;
+  struct stat    status;
+  char          *path;
+
+  if ((dir = opendir(directory)) == NULL) return;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.') continue;
+    path = (char *)malloc(strlen(directory) + strlen(entry->d_name) + 2);
+    sprintf(path, "%s/%s", directory, entry->d_name);
+    if (stat(path, &status) == 0) {
+      if (S_ISDIR(status.st_mode)) find_programs(found, path);
+      else if (S_ISREG(status.st_mode) && has_suffix(entry->d_name, ".pcd")) {
+        add_found(found, path);
+      }
+    }
+    free(path);
+  }
+  closedir(dir);
+}
+
+
+static int compare_paths(const void *left, const void *right)
+{
+  return strcmp(*(char * const *)left, *(char * const *)right);
+}
+
+
+static int update(char **arguments)
+{
+  struct index   old;
+  struct builder b;
+  struct found   found = { NULL, 0, 0 };
+  struct stat    status;
+  int *kept_as;
+  int indexed = 0, kept = 0, removed = 0, failed = 0;
+  int i, j, file, old_file;
+
+  if (!load_index(index_name, &old)) {
+    printf("%s is not an index.\n", index_name);
+    return 1;
+  }
+  memset(&b, 0, sizeof(b));
+  kept_as = (int *)malloc((old.header.file_count + 1) * sizeof(int));
+  for (i = 0; i < old.header.file_count; ++i) kept_as[i] = -1;
+
+  for (; *arguments != NULL; ++arguments) {
+    if (stat(*arguments, &status) != 0) {
+      printf("Unable to find %s.\n", *arguments);
+    }
+    else if (S_ISDIR(status.st_mode)) {
+      find_programs(&found, *arguments);
+    }
+    else {
+      add_found(&found, *arguments);
+    }
+  }
+  for (i = 0; i < old.header.file_count; ++i) {
+    add_found(&found, old.strings + old.files[i].path);
+  }
+  qsort(found.paths, found.count, sizeof(char *), compare_paths);
+
+  for (i = 0; i < found.count; ++i) {
+    const char *path = found.paths[i];
+
+    if (i > 0 && strcmp(path, found.paths[i - 1]) == 0) continue;
+    for (old_file = 0; old_file < old.header.file_count; ++old_file) {
+      if (strcmp(path, old.strings + old.files[old_file].path) == 0) break;
+    }
+    if (stat(path, &status) != 0) {
+      ++removed;
+      continue;
+    }
+    if (old_file < old.header.file_count &&
+        old.files[old_file].mtime == (long long)status.st_mtime &&
+        old.files[old_file].size  == (long long)status.st_size) {
+      kept_as[old_file] = add_file(&b, path, status.st_mtime, status.st_size);
+      ++kept;
+      continue;
+    }
+    file = add_file(&b, path, status.st_mtime, status.st_size);
+    if (index_program(&b, path, file)) {
+      ++indexed;
+    }
+    else {
+      // Leave it out so that it is tried again next time.
+      printf("%s was not indexed.\n", path);
+      free(b.paths[--b.file_count]);
+      while (b.posting_count > 0 && b.postings[b.posting_count - 1].file == file) {
+        --b.posting_count;
+      }
+      if (old_file < old.header.file_count) ++removed;
+      ++failed;
+    }
+  }
+
+  copy_postings(&b, &old, kept_as);
+  if (!write_index(&b, index_name)) return 1;
+  printf("%d files indexed, %d unchanged, %d removed. %d files, %d terms, %ld uses.\n",
+    indexed, kept, removed, b.file_count, b.term_count, b.posting_count);
+
+  for (j = 0; j < found.count; ++j) free(found.paths[j]);
+  free(found.paths);
+  free(kept_as);
+  free(old.buffer);
+  return failed ? 1 : 0;
+}
+
+//-----------------------
+//      The query command
+//-----------------------
+
+// The normalized form of a query term. A phrase is normalized the same
+// way as the phrases of the programs; a word is put into lower case.
+static char *normalize_term(const char *term)
+{
+  char *result;
+  int   i;
+
+  if (term[0] == '[') {
+    term = phrase_key(intern_phrase(term, strlen(term)));
+    return strcpy((char *)malloc(strlen(term) + 1), term);
+  }
+  result = strcpy((char *)malloc(strlen(term) + 1), term);
+  for (i = 0; result[i] != '\0'; ++i) result[i] = tolower((unsigned char)result[i]);
+  return result;
+}
+
+
+static int query(char **arguments)
+{
+  struct index index;
+  struct posting *matches = NULL;
+  int  match_count = 0, i, j, k, t;
+  int  first = 1;
+  char *term;
+
+  if (!load_index(index_name, &index)) {
+    printf("%s is not an index.\n", index_name);
+    return 1;
+  }
+  if (index.outdated) {
+    printf("%s was made by another version of pcindex. Update it first.\n", index_name);
+    return 1;
+  }
+
+  // Each term narrows the list of matching lines.
+  for (; *arguments != NULL; ++arguments) {
+    term = normalize_term(*arguments);
+    t = find_term(&index, term);
+    free(term);
+    if (t < 0) {
+      match_count = 0;
+      break;
+    }
+    if (first) {
+      matches = (struct posting *)malloc(index.terms[t].count * sizeof(struct posting));
+      memcpy(matches, &index.postings[index.terms[t].first],
+        index.terms[t].count * sizeof(struct posting));
+      match_count = index.terms[t].count;
+      first = 0;
+      continue;
+    }
+
+    // Both lists are sorted by file and line.
+    {
+      const struct posting *other = &index.postings[index.terms[t].first];
+      int other_count = index.terms[t].count;
+
+      for (i = j = k = 0; i < match_count && j < other_count; ) {
+        if (matches[i].file != other[j].file) {
+          if (matches[i].file < other[j].file) ++i; else ++j;
+        }
+        else if (matches[i].line != other[j].line) {
+          if (matches[i].line < other[j].line) ++i; else ++j;
+        }
+        else {
+          matches[k++] = matches[i++];
+        }
+      }
+      match_count = k;
+    }
+  }
+
+  for (i = 0; i < match_count; ++i) {
+    int kind = matches[i].kind;
+
+    printf("%s:%d: %s\n", index.strings + index.files[matches[i].file].path,
+      matches[i].line, kind == CASE_KIND ? "CASE" : statement_type_name(kind));
+  }
+  printf("%d use%s found.\n", match_count, match_count == 1 ? "" : "s");
+
+  free(matches);
+  free(index.buffer);
+  return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  ++argv;
+  if (*argv != NULL && strncmp(*argv, "-i", 2) == 0) {
+    index_name = (*argv)[2] != '\0' ? *argv + 2 : *++argv;
+    if (index_name != NULL) ++argv;
+  }
+  if (index_name == NULL || *argv == NULL || argv[1] == NULL) {
+    printf("Usage: pcindex [-i index] update path...\n");
+    printf("       pcindex [-i index] query term...\n");
+    return 1;
+  }
+  if (strcmp(*argv, "update") == 0) return update(argv + 1);
+  if (strcmp(*argv, "query") == 0) return query(argv + 1);
+  printf("Unknown command: %s\n", *argv);
+  return 1;
+}
@@ -17,10 +17,29 @@ Please send comments or bug reports to
 
 #include "tree.h"
 
-struct statement_list *top_node;
-
 %}
 
+/* The parser is reentrant so that pieces of one file can be parsed on
+   several threads at once (see parse.c). Everything a parse needs is in
+   its parse_context. */
+%define api.pure full
+%locations
+%parse-param { struct parse_context *context }
+%lex-param   { struct parse_context *context }
+
+%code requires {
+  struct parse_context;
+}
+
+%code {
+  #include "module.h"
+  #include "parse.h"
+
+  // Tokens come through parse.c, which chooses between the Flex scanner
+  // and the hand written one in scan.c.
+  #define yylex pcode_lex
+}
+
 %union {
   struct statement_list *statementlistp;
   struct statement      *statementp;
@@ -32,9 +51,11 @@ struct statement_list *top_node;
 
 %token AND
 %token pBEGIN
+%token BOUND
 %token BREAK
 %token CASE
 %token CONTINUE
+%token COST
 %token DECLARE
 %token DEFAULT
 %token DOMAIN
@@ -45,11 +66,13 @@ struct statement_list *top_node;
 %token FOREACH
 %token FUNCTION
 %token IF
+%token IMPORT
 %token IS
 %token LOOP
 %token NOT
 %token OF
 %token OR
+%token PARALLEL
 %token PROMISES
 %token RANGE
 %token REPEAT
@@ -74,7 +97,9 @@ struct statement_list *top_node;
 %type <statementlistp> statement_list
 %type <statementp>     statement
 %type <statementp>     switch_statement
+%type <caselistp>      branch_list
 %type <caselistp>      case_list
+%type <stringp>        bound
 %type <casebranchp>    case
 %type <exprp> conditional_expr
 %type <exprp> and_expr
@@ -82,6 +107,12 @@ struct statement_list *top_node;
 
 %start program
 
+/* A branch of a PARALLEL that ends with REPEAT ... UNTIL leaves the AND
+   before the next branch ambiguous (two conflicts, after an AND or an OR
+   operand). It's taken as part of the condition, and check_branch() then
+   rejects the branch. */
+%expect 2
+
 %%
 
 /* For now, disable the function syntax...
@@ -130,9 +161,10 @@ result:
 
 program:
      statement_list
-     { top_node = $1; }
+     { context->top = $1; }
    | declare_block statement_list
-     { top_node = $2; }
+     { if (!context->allow_declare) YYABORT;
+       context->top = $2; }
    ;
 
 declare_block:
@@ -164,36 +196,73 @@ statement_list:
      { $$ = new_statement_list_node($1, $2); }
    | statement
      { $$ = new_statement_list_node(NULL, $1); }
+   | statement_list IMPORT EP
+     { if (($$ = import_module(context, $1, $3, @2.first_line)) == NULL) YYABORT; }
+   | IMPORT EP
+     { if (($$ = import_module(context, NULL, $2, @1.first_line)) == NULL) YYABORT; }
    ;
 
 statement:
      EP
-     { $$ = new_statement_node(EPtype, NULL, NULL, NULL, $1, NULL); }
+     { $$ = new_statement_node(EPtype, NULL, NULL, NULL, $1, NULL,
+                               @1.first_line); }
+   | EP COST EP
+     { if (($3 = check_estimate(context, $3, @3.first_line)) == NULL) YYABORT;
+       $$ = new_statement_node(EPtype, NULL, NULL, NULL, $1, NULL,
+                               @1.first_line);
+       $$->estimate = $3; }
    | BREAK
-     { $$ = new_statement_node(BREAKtype, NULL, NULL, NULL, NULL, NULL); }
+     { $$ = new_statement_node(BREAKtype, NULL, NULL, NULL, NULL, NULL,
+                               @1.first_line); }
    | CONTINUE
-     { $$ = new_statement_node(CONTINUEtype, NULL, NULL, NULL, NULL, NULL); }
+     { $$ = new_statement_node(CONTINUEtype, NULL, NULL, NULL, NULL, NULL,
+                               @1.first_line); }
    | RETURN
-     { $$ = new_statement_node(RETURNtype, NULL, NULL, NULL, NULL, NULL); }
+     { $$ = new_statement_node(RETURNtype, NULL, NULL, NULL, NULL, NULL,
+                               @1.first_line); }
    | IF conditional_expr THEN statement_list END
-     { $$ = new_statement_node(IFtype, $2, $4, NULL, NULL, NULL); }
+     { $$ = new_statement_node(IFtype, $2, $4, NULL, NULL, NULL,
+                               @1.first_line);
+       $$->end_line = @5.first_line; }
    | IF conditional_expr THEN statement_list ELSE statement_list END
-     { $$ = new_statement_node(IFELSEtype, $2, $4, $6, NULL, NULL); }
-   | FOR conditional_expr LOOP statement_list END
-     { $$ = new_statement_node(FORtype, $2, $4, NULL, NULL, NULL); }
-   | FOREACH conditional_expr LOOP statement_list END
-     { $$ = new_statement_node(FORtype, $2, $4, NULL, NULL, NULL); }
-   | WHILE conditional_expr LOOP statement_list END
-     { $$ = new_statement_node(WHILEtype, $2, $4, NULL, NULL, NULL); }
-   | REPEAT statement_list UNTIL conditional_expr
-     { $$ = new_statement_node(REPEATtype, $4, $2, NULL, NULL, NULL); }
+     { $$ = new_statement_node(IFELSEtype, $2, $4, $6, NULL, NULL,
+                               @1.first_line);
+       $$->else_line = @5.first_line;
+       $$->end_line  = @7.first_line; }
+   | FOR conditional_expr bound LOOP statement_list END
+     { $$ = new_statement_node(FORtype, $2, $5, NULL, NULL, NULL,
+                               @1.first_line);
+       $$->estimate = $3;
+       $$->end_line = @6.first_line; }
+   | FOREACH conditional_expr bound LOOP statement_list END
+     { $$ = new_statement_node(FORtype, $2, $5, NULL, NULL, NULL,
+                               @1.first_line);
+       $$->estimate = $3;
+       $$->end_line = @6.first_line;
+       $$->foreach  = 1; }
+   | WHILE conditional_expr bound LOOP statement_list END
+     { $$ = new_statement_node(WHILEtype, $2, $5, NULL, NULL, NULL,
+                               @1.first_line);
+       $$->estimate = $3;
+       $$->end_line = @6.first_line; }
+   | REPEAT statement_list UNTIL conditional_expr bound
+     { $$ = new_statement_node(REPEATtype, $4, $2, NULL, NULL, NULL,
+                               @1.first_line);
+       $$->estimate = $5;
+       $$->end_line = @3.first_line; }
    | switch_statement
      { $$ = $1; }
+   | branch_list END
+     { $$ = new_statement_node(PARALLELtype, NULL, NULL, NULL, NULL, $1,
+                               @1.first_line);
+       $$->end_line = @2.first_line; }
    ;
 
 switch_statement:
      SWITCH EP case_list END
-     { $$ = new_statement_node(SWITCHtype, NULL, NULL, NULL, $2, $3); }
+     { $$ = new_statement_node(SWITCHtype, NULL, NULL, NULL, $2, $3,
+                               @1.first_line);
+       $$->end_line = @4.first_line; }
    ;
 
 case_list:
@@ -205,9 +274,34 @@ case_list:
 
 case:
      CASE EP ':' statement_list END
-     { $$ = new_case_branch_node($4, $2); }
+     { $$ = new_case_branch_node($4, $2);
+       $$->line     = @1.first_line;
+       $$->end_line = @5.first_line; }
    | DEFAULT ':' statement_list END
-     { $$ = new_case_branch_node($3, NULL); }
+     { $$ = new_case_branch_node($3, NULL);
+       $$->line     = @1.first_line;
+       $$->end_line = @4.first_line; }
+   ;
+
+/* The most trips a loop makes, for the cost analysis (see cost.h). */
+bound:
+     /* empty */
+     { $$ = NULL; }
+   | BOUND EP
+     { if (($$ = check_estimate(context, $2, @2.first_line)) == NULL) YYABORT; }
+   ;
+
+/* The branches of a PARALLEL are kept as a case list without phrases.
+   Each branch's line is that of the PARALLEL or AND it follows. */
+branch_list:
+     branch_list AND statement_list
+     { if (!check_branch(context, $3)) YYABORT;
+       $$ = new_case_list_node($1, new_case_branch_node($3, NULL));
+       $$->second->line = @2.first_line; }
+   | PARALLEL statement_list
+     { if (!check_branch(context, $2)) YYABORT;
+       $$ = new_case_list_node(NULL, new_case_branch_node($2, NULL));
+       $$->second->line = @1.first_line; }
    ;
 
 conditional_expr:
@@ -0,0 +1,218 @@
+/****************************************************************************
+FILE          : pcrt.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Runtime for p-code compiled to C.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Usage: prog [-S seed] [-d probability] [-m runs] [-q]
+
+With no options the program runs once, reading answers from the standard
+input. With -S the answers are random instead: conditions are true and
+cases match with the given probability (one half by default). The option
+-m runs the program many times and -q leaves out the questions; either
+one gives a summary with the time taken at the end.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "pcrt.h"
+#include "rng.h"
+
+static int stdin_answer(enum pc_question question, const char *phrase, int choices);
+
+int (*pc_answer)(enum pc_question question, const char *phrase, int choices) = stdin_answer;
+int pc_quiet = 0;
+
+static unsigned long long questions = 0;
+
+// The same as read_answer() and read_choice() in tree.c.
+static int stdin_answer(enum pc_question question, const char *phrase, int choices)
+{
+  int first, ch, number;
+
+  (void)phrase;
+  for (;;) {
+    first  = ch = getchar();
+    number = 0;
+    if (first == EOF) {
+      printf("\nEnd of input. Execution stopped.\n");
+      exit(EXIT_FAILURE);
+    }
+    if (question == PC_CHOICE) {
+      while (ch == ' ' || ch == '\t') ch = getchar();
+      for (; ch >= '0' && ch <= '9'; ch = getchar()) {
+        if (number < 100000000) number = 10 * number + (ch - '0');
+      }
+    }
+    while (ch != '\n' && ch != EOF) ch = getchar();
+    if (question != PC_CHOICE) return first;
+    if (number <= choices) return number;
+    if (!pc_quiet) printf("There are only %d. Which one (0 for none)? ", choices);
+  }
+}
+
+
+static struct rng    random_answers;
+static unsigned long threshold;       // Out of 1 << 20.
+
+// Each case of a menu matches with the same chance as a condition is
+// true; the first that matches is chosen.
+static int random_answer(enum pc_question question, const char *phrase, int choices)
+{
+  int i;
+
+  (void)phrase;
+  switch (question) {
+    case PC_CONDITION:
+      return rng_below(&random_answers, 1UL << 20) < threshold ? 't' : 'f';
+    case PC_CHOICE:
+      for (i = 1; i <= choices; ++i) {
+        if (rng_below(&random_answers, 1UL << 20) < threshold) return i;
+      }
+      return 0;
+    default:
+      return '\n';
+  }
+}
+
+//-----------------------------
+//      Called by the program
+//-----------------------------
+
+// The output is the same as the interpreter's (see execute_statement()).
+
+void pc_action(const char *phrase)
+{
+  ++questions;
+  if (!pc_quiet) printf("%s\n", phrase);
+  pc_answer(PC_ACTION, phrase, 0);
+}
+
+
+int pc_condition(const char *phrase)
+{
+  int ch;
+
+  ++questions;
+  if (!pc_quiet) {
+    printf("%s\n", phrase);
+    printf("True or False? ");
+  }
+  ch = pc_answer(PC_CONDITION, phrase, 0);
+  return ch == 'T' || ch == 't';
+}
+
+
+int pc_switch(const char *phrase, int count, const char *const cases[])
+{
+  int choice, i;
+
+  if (!pc_quiet) {
+    printf("Which of the following is %s?\n", phrase);
+    for (i = 0; i < count; ++i) printf("  %d. %s\n", i + 1, cases[i]);
+  }
+  if (count == 0) return 0;
+  ++questions;
+  if (!pc_quiet) printf("Which one (0 for none)? ");
+  choice = pc_answer(PC_CHOICE, phrase, count);
+  return choice <= count ? choice : 0;
+}
+
+
+void pc_return(void)
+{
+  if (!pc_quiet) printf("\nRETURN not implemented!\n");
+}
+
+//-----------------------------
+//      Main program
+//-----------------------------
+
+// Returns the argument of an option that takes one.
+static char *option_argument(char ***argv)
+{
+  char  option = ***argv;
+  char *argument = **argv + 1;
+
+  if (*argument == '\0') argument = *++*argv;
+  if (argument == NULL) {
+    printf("Option -%c requires an argument.\n", option);
+    exit(1);
+  }
+  return argument;
+}
+
+
+int main(int argc, char **argv)
+{
+  unsigned long long seed = 0;
+  double probability = 0.5;
+  long   runs = 1, run;
+  int    summary = 0;
+  struct timespec start, stop;
+  double seconds;
+  enum pc_result result;
+
+  (void)argc;
+  while (*++argv != NULL) {
+    if (**argv != '-') continue;
+    switch (*++*argv) {
+      case 'S':
+        seed = strtoull(option_argument(&argv), NULL, 10);
+        pc_answer = random_answer;
+        break;
+
+      case 'd':
+        probability = atof(option_argument(&argv));
+        break;
+
+      case 'm':
+        runs = atol(option_argument(&argv));
+        summary = 1;
+        break;
+
+      case 'q':
+        pc_quiet = 1;
+        summary = 1;
+        break;
+
+      default:
+        printf("Unrecognized option: %c (ignored)\n", **argv);
+        break;
+    }
+  }
+  rng_seed(&random_answers, &seed);
+  if (probability < 0) probability = 0;
+  if (probability > 1) probability = 1;
+  threshold = (unsigned long)(probability * (1UL << 20));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (run = 0; run < runs; ++run) {
+    result = pc_program();
+    if (pc_quiet) continue;
+    if (result == PC_BREAK) {
+      printf("Warning: Executed a BREAK without an enclosing loop.\n");
+    }
+    else if (result == PC_CONTINUE) {
+      printf("Warning: Executed a CONTINUE without an enclosing loop.\n");
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+
+  if (summary) {
+    seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%ld run%s, %llu questions answered in %.3f seconds", runs,
+      runs == 1 ? "" : "s", questions, seconds);
+    if (seconds > 0) printf(" (%.0f runs per second)", runs / seconds);
+    printf(".\n");
+  }
+  return 0;
+}
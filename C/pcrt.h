@@ -0,0 +1,55 @@
+/****************************************************************************
+FILE          : pcrt.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Runtime for p-code compiled to C.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+A program compiled with "main -c prog.c" defines pc_program() and calls
+the functions below for each phrase it meets. Build it with this runtime:
+
+    gcc -O2 -o prog prog.c pcrt.c
+
+By default the program asks its questions on the standard output and
+reads the answers from the standard input as the interpreter does, so
+the two give the same output for the same answers. Bulk answers to loop
+conditions ("t x1000") are not understood: every test is asked and only
+the first character of the answer counts. The answers can come from
+anywhere else by setting pc_answer.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef PCRT_H
+#define PCRT_H
+
+// How a statement list finished (as enum abort_type in tree.h).
+enum pc_result { PC_NORMAL, PC_BREAK, PC_CONTINUE };
+
+// The kinds of questions asked.
+enum pc_question { PC_ACTION, PC_CONDITION, PC_CHOICE };
+
+// The answer provider. For a condition it returns the first character of
+// the answer ('T' or 't' makes the condition true). For the menu of a
+// SWITCH, where the phrase is that of the SWITCH, it returns the number of
+// the chosen case from 1 to 'choices', or 0 for none. The answer to an
+// action is ignored.
+extern int (*pc_answer)(enum pc_question question, const char *phrase, int choices);
+
+// If nonzero, the questions are not printed.
+extern int pc_quiet;
+
+// Called by the compiled program.
+void pc_action(const char *phrase);
+int  pc_condition(const char *phrase);
+int  pc_switch(const char *phrase, int count, const char *const cases[]);
+void pc_return(void);
+
+// Defined by the compiled program.
+enum pc_result pc_program(void);
+
+#endif
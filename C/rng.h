@@ -0,0 +1,73 @@
+/****************************************************************************
+FILE          : rng.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Small, fast random number streams.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The generator is xoshiro256**. Each stream is seeded through splitmix64
+so that streams created from consecutive seeds are unrelated. A stream
+must only be used by one thread at a time; code that runs in parallel
+gives each thread its own stream.
+
+These functions are called in the inner loops of the simulator so they
+are defined here, in the header, where the compiler can inline them.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef RNG_H
+#define RNG_H
+
+struct rng {
+  unsigned long long state[4];
+};
+
+static inline unsigned long long splitmix64(unsigned long long *x)
+{
+  unsigned long long z = (*x += 0x9E3779B97F4A7C15ULL);
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// Seed a stream. The seed is advanced so it can be used for the next one.
+static inline void rng_seed(struct rng *r, unsigned long long *seed)
+{
+  int i;
+
+  for (i = 0; i < 4; ++i) r->state[i] = splitmix64(seed);
+}
+
+static inline unsigned long long rng_rotl(unsigned long long x, int k)
+{
+  return (x << k) | (x >> (64 - k));
+}
+
+static inline unsigned long long rng_next(struct rng *r)
+{
+  unsigned long long *s = r->state;
+  unsigned long long result = rng_rotl(s[1] * 5, 7) * 9;
+  unsigned long long t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rng_rotl(s[3], 45);
+  return result;
+}
+
+// Returns a number in the range [0, n).
+static inline unsigned long rng_below(struct rng *r, unsigned long n)
+{
+  return (unsigned long)((rng_next(r) >> 11) % n);
+}
+
+#endif
@@ -0,0 +1,331 @@
+/****************************************************************************
+FILE          : scan.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Hand written scanner for p-code.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The rules in pcode.l, restated:
+
+  + Blanks, tabs, form feeds, carriage returns and newlines are skipped.
+  + '#' starts a comment that runs to (not including) the end of line.
+  + '[' starts an English phrase that runs through the next ']' (or the
+    end of the input, in which case the ']' is supplied anyway).
+  + The longest keyword that is a prefix of the input matches. Keywords
+    need not end at a word boundary: "ENDIF" is END followed by 'I' and
+    'F'.
+  + Any other character is returned as itself.
+
+Most of the input is white space, comments and phrase text, so those are
+handled a block of 16 bytes at a time. For each block a bit mask of the
+interesting bytes is built with vector compares and the first one is
+found with a count of trailing zeros. Newlines passed over are counted
+with popcount on the newline mask.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "memstat.h"
+#include "scan.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//-----------------------------
+//      Block classification
+//-----------------------------
+
+#if defined(__SSE2__)
+
+typedef __m128i block_type;
+
+static inline block_type load_block(const char *p)
+{
+  return _mm_loadu_si128((const __m128i *)p);
+}
+
+// Bit i is set if byte i of the block equals ch.
+static inline unsigned block_equal(block_type block, char ch)
+{
+  return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(ch)));
+}
+
+// Mask of the bytes of a block that are before 'end'.
+static inline unsigned valid_bytes(const char *p, const char *end)
+{
+  ptrdiff_t left = end - p;
+  return left >= 16 ? 0xFFFFu : (1u << left) - 1;
+}
+
+
+// Find the first occurrence of ch at or after p (or end if there is none)
+// and add the number of newlines passed over to *lines.
+//
+static const char *find_byte(const char *p, const char *end, char ch, int *lines)
+{
+  while (p < end) {
+    block_type block = load_block(p);
+    unsigned valid = valid_bytes(p, end);
+    unsigned found = block_equal(block, ch) & valid;
+    unsigned newlines = block_equal(block, '\n') & valid;
+
+    if (found != 0) {
+      int offset = __builtin_ctz(found);
+      *lines += __builtin_popcount(newlines & ((1u << offset) - 1));
+      return p + offset;
+    }
+    *lines += __builtin_popcount(newlines);
+    p += 16;
+  }
+  return end;
+}
+
+
+// Skip white space, counting newlines.
+static const char *skip_space(const char *p, const char *end, int *lines)
+{
+  while (p < end) {
+    block_type block = load_block(p);
+    unsigned valid = valid_bytes(p, end);
+    unsigned newlines = block_equal(block, '\n');
+    unsigned space = (block_equal(block, ' ') | block_equal(block, '\t') |
+                      block_equal(block, '\f') | block_equal(block, '\r') |
+                      newlines) & valid;
+    unsigned other = ~space & valid;
+
+    if (other != 0) {
+      int offset = __builtin_ctz(other);
+      *lines += __builtin_popcount(newlines & ((1u << offset) - 1));
+      return p + offset;
+    }
+    *lines += __builtin_popcount(newlines & valid);
+    p += 16;
+  }
+  return end;
+}
+
+#else
+
+// Without vector instructions, one byte at a time.
+
+static const char *find_byte(const char *p, const char *end, char ch, int *lines)
+{
+  for (; p < end && *p != ch; ++p) {
+    if (*p == '\n') ++*lines;
+  }
+  return p;
+}
+
+
+static const char *skip_space(const char *p, const char *end, int *lines)
+{
+  for (; p < end; ++p) {
+    if (*p == '\n') ++*lines;
+    else if (*p != ' ' && *p != '\t' && *p != '\f' && *p != '\r') break;
+  }
+  return p;
+}
+
+#endif
+
+//-----------------------------
+//      Keywords
+//-----------------------------
+
+#define SHORTEST_KEYWORD 2
+#define LONGEST_KEYWORD  8
+#define HASH_SIZE       64
+
+// A perfect hash for the 35 keywords (the multipliers were found by a
+// search over small constants). Each keyword sits at its hash value in
+// the table below, so a lookup is one hash and one compare. If a keyword
+// is added both must be redone.
+//
+static inline unsigned keyword_hash(const char *text, int length)
+{
+  return (length + 15u * (unsigned char)text[0] + 6u * (unsigned char)text[length - 1] +
+          39u * (unsigned char)text[1]) & (HASH_SIZE - 1);
+}
+
+static const struct {
+  const char *text;
+  int         length;
+  int         token;
+} keyword_table[HASH_SIZE] = {
+  [ 0] = { "IMPORT",   6, IMPORT   },
+  [ 1] = { "ELSE",     4, ELSE     },
+  [ 4] = { "BOUND",    5, BOUND    },
+  [ 8] = { "END",      3, END      },
+  [10] = { "RETURNS",  7, RETURNS  },
+  [11] = { "REQUIRES", 8, REQUIRES },
+  [12] = { "AND",      3, AND      },
+  [13] = { "OR",       2, OR       },
+  [15] = { "REPEAT",   6, REPEAT   },
+  [18] = { "FOR",      3, FOR      },
+  [20] = { "SWITCH",   6, SWITCH   },
+  [22] = { "NOT",      3, NOT      },
+  [23] = { "IF",       2, IF       },
+  [24] = { "RANGE",    5, RANGE    },
+  [26] = { "FOREACH",  7, FOREACH  },
+  [28] = { "CONTINUE", 8, CONTINUE },
+  [29] = { "TYPE",     4, TYPE     },
+  [31] = { "DOMAIN",   6, DOMAIN   },
+  [32] = { "IS",       2, IS       },
+  [33] = { "LOOP",     4, LOOP     },
+  [35] = { "BREAK",    5, BREAK    },
+  [36] = { "DECLARE",  7, DECLARE  },
+  [39] = { "PARALLEL", 8, PARALLEL },
+  [40] = { "PROMISES", 8, PROMISES },
+  [41] = { "FUNCTION", 8, FUNCTION },
+  [42] = { "UNTIL",    5, UNTIL    },
+  [43] = { "RETURN",   6, RETURN   },
+  [47] = { "VOID",     4, VOID     },
+  [49] = { "OF",       2, OF       },
+  [50] = { "COST",     4, COST     },
+  [52] = { "WHILE",    5, WHILE    },
+  [54] = { "CASE",     4, CASE     },
+  [58] = { "BEGIN",    5, pBEGIN   },
+  [60] = { "THEN",     4, THEN     },
+  [62] = { "DEFAULT",  7, DEFAULT  },
+};
+
+
+// Returns the token of the longest keyword at the start of a run of
+// upper case letters and sets *length, or returns zero.
+static int match_keyword(const char *text, int run, int *length)
+{
+  int n;
+
+  for (n = run < LONGEST_KEYWORD ? run : LONGEST_KEYWORD; n >= SHORTEST_KEYWORD; --n) {
+    unsigned h = keyword_hash(text, n);
+    if (keyword_table[h].length == n && memcmp(keyword_table[h].text, text, n) == 0) {
+      *length = n;
+      return keyword_table[h].token;
+    }
+  }
+  return 0;
+}
+
+//-----------------------------
+//      The scanner
+//-----------------------------
+
+int scanner_read(struct scanner *s, FILE *in)
+{
+  size_t capacity = 1 << 16, length = 0, got;
+  char  *buffer = (char *)malloc(capacity + SCAN_PADDING);
+
+  if (buffer == NULL) return 0;
+  while ((got = fread(buffer + length, 1, capacity - length, in)) > 0) {
+    length += got;
+    if (length == capacity) {
+      char *bigger = (char *)realloc(buffer, 2 * capacity + SCAN_PADDING);
+      if (bigger == NULL) {
+        free(buffer);
+        return 0;
+      }
+      buffer = bigger;
+      capacity *= 2;
+    }
+  }
+  if (ferror(in)) {
+    free(buffer);
+    return 0;
+  }
+  memset(buffer + length, 0, SCAN_PADDING);
+  scanner_init(s, buffer, length, 1);
+  s->buffer = buffer;
+  return 1;
+}
+
+
+void scanner_init(struct scanner *s, const char *text, size_t length, int line)
+{
+  s->buffer       = NULL;
+  s->position     = text;
+  s->end          = text + length;
+  s->line         = line;
+  s->token_start  = text;
+  s->values       = 1;
+  s->scratch      = NULL;
+  s->scratch_size = 0;
+}
+
+
+void scanner_close(struct scanner *s)
+{
+  free(s->buffer);
+  free(s->scratch);
+  s->buffer  = NULL;
+  s->scratch = NULL;
+}
+
+
+// Build the value of a phrase token: the text from '[' up to 'close'
+// followed by ']'.
+static vtc_string *make_phrase(struct scanner *s, const char *open, const char *close)
+{
+  size_t      length = close - open;
+  vtc_string *phrase = (vtc_string *)mem_alloc(MEM_PHRASE, sizeof(vtc_string));
+
+  if (length + 2 > s->scratch_size) {
+    s->scratch_size = 2 * (length + 2);
+    s->scratch = (char *)realloc(s->scratch, s->scratch_size);
+  }
+  memcpy(s->scratch, open, length);
+  s->scratch[length]     = ']';
+  s->scratch[length + 1] = '\0';
+  vtc_string_init(phrase);
+  vtc_string_copycharp(phrase, s->scratch);
+  return phrase;
+}
+
+
+int scan_token(struct scanner *s, YYSTYPE *value, YYLTYPE *location)
+{
+  const char *p = s->position;
+  const char *end = s->end;
+  const char *close;
+  int token, length, run;
+
+  for (;;) {
+    p = skip_space(p, end, &s->line);
+    if (p == end) {
+      s->position = p;
+      return 0;
+    }
+    if (*p != '#') break;
+    p = find_byte(p, end, '\n', &s->line);
+  }
+
+  location->first_line = location->last_line = s->line;
+  s->token_start = p;
+
+  if (*p == '[') {
+    close = find_byte(p + 1, end, ']', &s->line);
+    value->stringp = s->values ? make_phrase(s, p, close) : NULL;
+    location->last_line = s->line;
+    s->position = close == end ? end : close + 1;
+    return EP;
+  }
+
+  if (*p >= 'A' && *p <= 'Z') {
+    for (run = 1; p + run < end && run < LONGEST_KEYWORD && p[run] >= 'A' && p[run] <= 'Z'; ++run)
+      ;
+    if ((token = match_keyword(p, run, &length)) != 0) {
+      s->position = p + length;
+      return token;
+    }
+  }
+
+  // Flex returns yytext[0], a plain char.
+  s->position = p + 1;
+  return (char)*p;
+}
@@ -0,0 +1,61 @@
+/****************************************************************************
+FILE          : scan.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the hand written scanner.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+This scanner produces exactly the tokens, values and line numbers that
+the Flex scanner in pcode.l produces, but it works on a buffer holding
+the whole input and examines the text 16 bytes at a time (with SSE2
+where it is available) to skip white space, comments and the bodies of
+English phrases. Keywords are recognized with a perfect hash.
+
+It is meant for checking large inputs quickly. The benchmark program
+scanbench compares it with the Flex scanner.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "vtcstr.h"
+#include "pcode.tab.h"
+
+// The scanner reads this many bytes past the end of its text (the extra
+// bytes are ignored). scanner_read() provides the padding itself.
+#define SCAN_PADDING 16
+
+struct scanner {
+  char       *buffer;       // Owned by the scanner if read with scanner_read().
+  const char *position;
+  const char *end;
+  int         line;
+  const char *token_start;  // Where the last token returned began.
+  int         values;       // If zero, phrase tokens are given no value.
+  char       *scratch;      // Used to build phrase values.
+  size_t      scratch_size;
+};
+
+// Read all of a stream into memory and prepare to scan it. Returns zero
+// if the stream can't be read.
+int scanner_read(struct scanner *s, FILE *in);
+
+// Scan text held elsewhere. The text must be followed by SCAN_PADDING
+// readable bytes. Line numbering starts at 'line'.
+void scanner_init(struct scanner *s, const char *text, size_t length, int line);
+
+void scanner_close(struct scanner *s);
+
+// Return the next token (zero at the end of the text) and fill in its
+// value and location as the Flex scanner would.
+int scan_token(struct scanner *s, YYSTYPE *value, YYLTYPE *location);
+
+#endif
@@ -0,0 +1,216 @@
+/****************************************************************************
+FILE          : scanbench.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Compare the hand written scanner with the Flex scanner.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+Usage: scanbench file [repetitions]
+
+The file is tokenized repeatedly by each scanner. The token streams
+(token, lines and phrase text) are compared, and the best time of each
+scanner is reported.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "scan.h"
+
+// The Flex scanner expects the parser to provide these.
+YYSTYPE yylval;
+YYLTYPE yylloc;
+
+extern FILE *yyin;
+extern int   current_line;
+extern int   yylex(void);
+extern void  yyrestart(FILE *input);
+
+// One token of a stream, kept for comparison.
+struct token_record {
+  int           token;
+  int           first_line;
+  int           last_line;
+  unsigned long phrase_hash;    // Of the phrase text for EP tokens.
+};
+
+struct token_stream {
+  struct token_record *records;
+  long                 count;
+  long                 capacity;
+};
+
+static unsigned long hash_text(const char *text)
+{
+  unsigned long h = 5381;
+
+  while (*text) h = h * 33 + (unsigned char)*text++;
+  return h;
+}
+
+
+static void record(struct token_stream *stream, int token, const YYSTYPE *value,
+                   const YYLTYPE *location)
+{
+  struct token_record *r;
+
+  if (stream == NULL) return;
+  if (stream->count == stream->capacity) {
+    stream->capacity = stream->capacity ? 2 * stream->capacity : 1024;
+    stream->records = (struct token_record *)
+      realloc(stream->records, stream->capacity * sizeof(struct token_record));
+  }
+  r = &stream->records[stream->count++];
+  r->token       = token;
+  r->first_line  = location->first_line;
+  r->last_line   = location->last_line;
+  r->phrase_hash = token == EP ? hash_text(vtc_string_getcharp(value->stringp)) : 0;
+}
+
+
+static void discard_value(int token, YYSTYPE *value)
+{
+  if (token == EP) {
+    vtc_string_destroy(value->stringp);
+    free(value->stringp);
+  }
+}
+
+
+static double seconds_now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+static long run_flex(const char *file_name, struct token_stream *stream)
+{
+  FILE *input = fopen(file_name, "r");
+  long  count = 0;
+  int   token;
+
+  if (input == NULL) {
+    printf("Unable to open %s for input.\n", file_name);
+    exit(1);
+  }
+  yyrestart(input);
+  current_line = 1;
+  while ((token = yylex()) != 0) {
+    record(stream, token, &yylval, &yylloc);
+    discard_value(token, &yylval);
+    ++count;
+  }
+  fclose(input);
+  return count;
+}
+
+
+static long run_fast(const struct scanner *loaded, struct token_stream *stream)
+{
+  struct scanner s;
+  YYSTYPE value;
+  YYLTYPE location;
+  long    count = 0;
+  int     token;
+
+  scanner_init(&s, loaded->position, loaded->end - loaded->position, 1);
+  while ((token = scan_token(&s, &value, &location)) != 0) {
+    record(stream, token, &value, &location);
+    discard_value(token, &value);
+    ++count;
+  }
+  scanner_close(&s);
+  return count;
+}
+
+
+// Returns the index of the first difference or -1 if the streams match.
+static long compare_streams(const struct token_stream *a, const struct token_stream *b)
+{
+  long i;
+
+  for (i = 0; i < a->count && i < b->count; ++i) {
+    const struct token_record *x = &a->records[i], *y = &b->records[i];
+    if (x->token != y->token || x->first_line != y->first_line ||
+        x->last_line != y->last_line || x->phrase_hash != y->phrase_hash) {
+      return i;
+    }
+  }
+  return a->count == b->count ? -1 : i;
+}
+
+
+int main(int argc, char **argv)
+{
+  struct scanner      loaded;
+  struct token_stream flex_stream = { NULL, 0, 0 };
+  struct token_stream fast_stream = { NULL, 0, 0 };
+  FILE  *input;
+  double flex_best = 1e9, fast_best = 1e9, start, megabytes;
+  long   difference, tokens = 0;
+  int    repetitions = 5, i;
+
+  if (argc < 2) {
+    printf("Usage: scanbench file [repetitions]\n");
+    return 1;
+  }
+  if (argc > 2) repetitions = atoi(argv[2]);
+  if (repetitions < 1) repetitions = 1;
+
+  if ((input = fopen(argv[1], "r")) == NULL || !scanner_read(&loaded, input)) {
+    printf("Unable to read %s.\n", argv[1]);
+    return 1;
+  }
+  fclose(input);
+  megabytes = (loaded.end - loaded.position) / 1e6;
+
+  // First check that the two scanners agree.
+  run_flex(argv[1], &flex_stream);
+  run_fast(&loaded, &fast_stream);
+  difference = compare_streams(&flex_stream, &fast_stream);
+  if (difference >= 0) {
+    printf("The scanners disagree at token %ld", difference);
+    if (difference < flex_stream.count) {
+      printf(" (Flex: token %d on line %d)", flex_stream.records[difference].token,
+        flex_stream.records[difference].first_line);
+    }
+    if (difference < fast_stream.count) {
+      printf(" (fast: token %d on line %d)", fast_stream.records[difference].token,
+        fast_stream.records[difference].first_line);
+    }
+    printf(".\n");
+    return 1;
+  }
+  printf("%ld tokens, %d lines: the scanners agree.\n", flex_stream.count,
+    flex_stream.count ? flex_stream.records[flex_stream.count - 1].last_line : 1);
+  free(flex_stream.records);
+  free(fast_stream.records);
+
+  for (i = 0; i < repetitions; ++i) {
+    start = seconds_now();
+    tokens = run_flex(argv[1], NULL);
+    start = seconds_now() - start;
+    if (start < flex_best) flex_best = start;
+
+    start = seconds_now();
+    tokens = run_fast(&loaded, NULL);
+    start = seconds_now() - start;
+    if (start < fast_best) fast_best = start;
+  }
+
+  printf("Flex: %8.3f ms  %8.1f MB/s\n", 1000 * flex_best, megabytes / flex_best);
+  printf("Fast: %8.3f ms  %8.1f MB/s  (%.1f times faster, %ld tokens)\n",
+    1000 * fast_best, megabytes / fast_best, flex_best / fast_best, tokens);
+  scanner_close(&loaded);
+  return 0;
+}
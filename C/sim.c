@@ -0,0 +1,603 @@
+/****************************************************************************
+FILE          : sim.c
+LAST REVISION : 2026-10-19
+SUBJECT       : Monte Carlo simulation of a p-code program.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The runs are divided evenly among a number of worker threads. Each worker
+has its own random number stream (see rng.h) and its own statistics
+arrays. Workers never touch each other's data so no locking
+or atomic operations are needed; the arrays are summed after all the
+workers have finished. Given the same seed and the same number of
+threads the results are reproducible.
+
+The simulated execution follows execute_statement() exactly except that
+every question is answered at random and that a loop is abandoned after
+a fixed number of iterations (the loop cap). Without the cap a loop
+whose condition is true with probability 1 would never end.
+
+With adaptive ordering each worker has its own adapter (see adapt.h), so
+the workers learn their operand orders independently.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "adapt.h"
+#include "intern.h"
+#include "module.h"
+#include "rng.h"
+#include "sim.h"
+
+// Path lengths are recorded in a log-linear histogram. Values below 64
+// have their own bucket. Above that each power of two is divided into 32
+// buckets, which keeps the reported percentiles within about 3%.
+//
+#define EXACT_BUCKETS   64
+#define SUB_BUCKETS     32
+#define HISTOGRAM_SIZE  (EXACT_BUCKETS + 58 * SUB_BUCKETS)
+
+// Everything the workers share. It is read only while they run.
+struct model {
+  const struct tree_info *info;
+  struct statement_list  *top;
+  long                    loop_cap;
+
+  // Decision thresholds. A decision is "yes" when the next random number
+  // is below the threshold. Indexed by expression ID and case ID.
+  unsigned long long     *condition_threshold;
+  unsigned long long     *case_threshold;
+};
+
+// Per-statement counters.
+struct node_stats {
+  unsigned long long executions;
+  unsigned long long iterations;   // Loops: total trips.
+  unsigned long long max_trips;    // Loops: most trips in one entry.
+  unsigned long long cap_hits;     // Loops: entries cut off by the cap.
+  unsigned long long true_count;   // IF: condition true. SWITCH: a match.
+};
+
+struct worker {
+  pthread_t           thread;
+  const struct model *model;
+  long                runs;
+  struct rng          random;
+  struct node_stats  *stats;
+  unsigned long long  length;       // Statements executed in this run.
+  int                 capped;       // Did this run hit the loop cap?
+  unsigned long long  capped_runs;
+  unsigned long long  min_length;
+  unsigned long long  max_length;
+  unsigned long long  total_length;
+  unsigned long long  questions;    // Conditions and menus asked about.
+  struct adapter     *adapter;      // NULL unless ordering is adaptive.
+  unsigned long long  histogram[HISTOGRAM_SIZE];
+};
+
+//-----------------------------
+//      Random decisions
+//-----------------------------
+
+// Convert a probability into a threshold for rng_next().
+static unsigned long long threshold(double p)
+{
+  if (p <= 0.0) return 0;
+  if (p >= 1.0) return ~0ULL;
+  return (unsigned long long)(p * 18446744073709551616.0);
+}
+
+
+static int chance(struct worker *w, unsigned long long limit)
+{
+  // A threshold of ~0 means "always" even for the one value it misses.
+  return limit == ~0ULL || rng_next(&w->random) < limit;
+}
+
+//-----------------------------
+//      Simulated execution
+//-----------------------------
+
+static int ask(void *context, struct expression *prompt)
+{
+  struct worker *w = (struct worker *)context;
+
+  w->questions++;
+  return chance(w, w->model->condition_threshold[prompt->id]);
+}
+
+
+static int decide(struct worker *w, struct expression *e)
+{
+  int i;
+
+  if (w->adapter != NULL) return adapt_evaluate(w->adapter, e, ask, w);
+  switch (e->op) {
+    case PASSop:   return decide(w, e->first);
+    case NOTop:    return !decide(w, e->first);
+    case PROMPTop: return ask(w, e);
+    case ANDop:
+      if (e->count == 0) return decide(w, e->first) && decide(w, e->second);
+      for (i = 0; i < e->count; ++i) if (!decide(w, e->operands[i])) return 0;
+      return 1;
+    case ORop:
+      if (e->count == 0) return decide(w, e->first) || decide(w, e->second);
+      for (i = 0; i < e->count; ++i) if (decide(w, e->operands[i])) return 1;
+      return 0;
+  }
+  return 0;
+}
+
+
+static enum abort_type run_list(struct worker *w, struct statement_list *list);
+
+// Finish the bookkeeping for one entry into a loop.
+static void count_trips(
+  struct worker *w, struct node_stats *n, unsigned long long trips, int capped)
+{
+  n->iterations += trips;
+  if (trips > n->max_trips) n->max_trips = trips;
+  if (capped) {
+    n->cap_hits++;
+    w->capped = 1;
+  }
+}
+
+
+static enum abort_type run_statement(struct worker *w, struct statement *s)
+{
+  struct node_stats  *n = &w->stats[s->id];
+  long                cap = w->model->loop_cap;
+  unsigned long long  trips = 0;
+  int                 capped = 0;
+  struct case_branch *chosen;
+  int                 i;
+  enum abort_type     result = NORMAL;
+
+  n->executions++;
+  w->length++;
+
+  switch (s->type) {
+    case BREAKtype:
+      result = fromBREAK;
+      break;
+
+    case CONTINUEtype:
+      result = fromCONTINUE;
+      break;
+
+    case EPtype:
+    case RETURNtype:
+      break;
+
+    case FORtype:
+    case WHILEtype:
+      while (decide(w, s->conditional)) {
+        if ((long)trips == cap) {
+          capped = 1;
+          break;
+        }
+        trips++;
+        if (run_list(w, s->first) == fromBREAK) break;
+      }
+      count_trips(w, n, trips, capped);
+      break;
+
+    case IFtype:
+      if (decide(w, s->conditional)) {
+        n->true_count++;
+        result = run_list(w, s->first);
+      }
+      break;
+
+    case IFELSEtype:
+      if (decide(w, s->conditional)) {
+        n->true_count++;
+        result = run_list(w, s->first);
+      }
+      else {
+        result = run_list(w, s->second);
+      }
+      break;
+
+    case REPEATtype:
+      for (;;) {
+        trips++;
+        if (run_list(w, s->first) == fromBREAK) break;
+        if (decide(w, s->conditional)) break;
+        if ((long)trips == cap) {
+          capped = 1;
+          break;
+        }
+      }
+      count_trips(w, n, trips, capped);
+      break;
+
+    case SWITCHtype:
+      // The whole menu is one question. The first case in source order
+      // that matches is chosen, and the DEFAULT if none does.
+      chosen = s->default_case;
+      if (s->case_count > 0) w->questions++;
+      for (i = 0; i < s->case_count; ++i) {
+        if (chance(w, w->model->case_threshold[s->cases[i]->id])) {
+          chosen = s->cases[i];
+          n->true_count++;
+          break;
+        }
+      }
+      if (chosen != NULL) result = run_list(w, chosen->first);
+      break;
+
+    case PARALLELtype:
+      // A run's length is the same whatever the schedule.
+      for (i = 0; i < s->case_count; ++i) run_list(w, s->cases[i]->first);
+      break;
+  }
+  return result;
+}
+
+
+static enum abort_type run_list(struct worker *w, struct statement_list *list)
+{
+  enum abort_type result = NORMAL;
+  int i;
+
+  for (i = 0; i < list->count && result == NORMAL; ++i) {
+    result = run_statement(w, list->items[i]);
+  }
+  return result;
+}
+
+
+static int bucket_of(unsigned long long value)
+{
+  int exponent = 63;
+
+  if (value < EXACT_BUCKETS) return (int)value;
+  while ((value >> exponent) == 0) --exponent;
+  return EXACT_BUCKETS + (exponent - 6) * SUB_BUCKETS +
+    (int)((value >> (exponent - 5)) & (SUB_BUCKETS - 1));
+}
+
+
+// The smallest value that falls into the given bucket.
+static unsigned long long bucket_floor(int bucket)
+{
+  int exponent;
+
+  if (bucket < EXACT_BUCKETS) return bucket;
+  bucket  -= EXACT_BUCKETS;
+  exponent = bucket / SUB_BUCKETS + 6;
+  return (1ULL << exponent) +
+    ((unsigned long long)(bucket % SUB_BUCKETS) << (exponent - 5));
+}
+
+
+static void *worker_main(void *arg)
+{
+  struct worker *w = (struct worker *)arg;
+  long run;
+
+  w->min_length = ~0ULL;
+  for (run = 0; run < w->runs; ++run) {
+    w->length = 0;
+    w->capped = 0;
+    run_list(w, w->model->top);
+    w->histogram[bucket_of(w->length)]++;
+    w->total_length += w->length;
+    if (w->length < w->min_length) w->min_length = w->length;
+    if (w->length > w->max_length) w->max_length = w->length;
+    if (w->capped) w->capped_runs++;
+  }
+  return NULL;
+}
+
+//-----------------------------
+//      Model setup
+//-----------------------------
+
+int load_probabilities(const char *file_name, double *probability)
+{
+  FILE       *in = fopen(file_name, "r");
+  vtc_string  line;
+  int         line_number = 0;
+  int         ok = 1;
+
+  if (in == NULL) {
+    printf("Unable to open %s for input.\n", file_name);
+    return 0;
+  }
+  vtc_string_init(&line);
+  while (vtc_string_readline(&line, in)) {
+    char   *text = vtc_string_getcharp(&line);
+    char   *open, *close, *end;
+    double  p;
+    int     id;
+
+    ++line_number;
+    while (*text == ' ' || *text == '\t') ++text;
+    if (*text == '\0' || *text == '#') continue;
+
+    open  = strchr(text, '[');
+    close = strrchr(text, ']');
+    if (open == NULL || close == NULL || close < open) {
+      printf("%s: [line %d] Expected a phrase in brackets.\n",
+        file_name, line_number);
+      ok = 0;
+      continue;
+    }
+    p = strtod(close + 1, &end);
+    if (end == close + 1 || p < 0.0 || p > 1.0) {
+      printf("%s: [line %d] Expected a probability between 0 and 1.\n",
+        file_name, line_number);
+      ok = 0;
+      continue;
+    }
+    id = lookup_phrase(open, (int)(close - open) + 1);
+    if (id < 0) {
+      printf("%s: [line %d] Warning: phrase does not appear in the program.\n",
+        file_name, line_number);
+      continue;
+    }
+    probability[id] = p;
+  }
+  vtc_string_destroy(&line);
+  fclose(in);
+  return ok;
+}
+
+
+static int build_model(
+  struct model             *model,
+  struct statement_list    *top,
+  const struct tree_info   *info,
+  const struct sim_options *options)
+{
+  double *probability;
+  int     count = phrase_count();
+  int     i;
+
+  probability = (double *)malloc((count + 1) * sizeof(double));
+  for (i = 0; i < count; ++i) probability[i] = -1.0;
+  if (options->probability_file != NULL &&
+      !load_probabilities(options->probability_file, probability)) {
+    free(probability);
+    return 0;
+  }
+
+  model->info     = info;
+  model->top      = top;
+  model->loop_cap = options->loop_cap;
+  model->condition_threshold = (unsigned long long *)
+    calloc(info->expression_count + 1, sizeof(unsigned long long));
+  model->case_threshold = (unsigned long long *)
+    calloc(info->case_count + 1, sizeof(unsigned long long));
+
+  for (i = 0; i < info->expression_count; ++i) {
+    int phrase = info->expressions[i]->phrase;
+    double p = options->default_probability;
+    if (phrase >= 0 && probability[phrase] >= 0.0) p = probability[phrase];
+    model->condition_threshold[i] = threshold(p);
+  }
+  for (i = 0; i < info->case_count; ++i) {
+    int phrase = info->cases[i]->phrase;
+    double p = options->default_probability;
+    if (phrase >= 0 && probability[phrase] >= 0.0) p = probability[phrase];
+    model->case_threshold[i] = threshold(p);
+  }
+  free(probability);
+  return 1;
+}
+
+//-----------------------------
+//      Reporting
+//-----------------------------
+
+// Find a phrase that identifies a statement in the report.
+static const char *describe(struct statement *s)
+{
+  struct expression *e = s->conditional;
+
+  if (s->phrase >= 0) return phrase_text(s->phrase);
+  while (e != NULL && e->op != PROMPTop) {
+    e = e->count > 0 ? e->operands[0] : e->first;
+  }
+  if (e != NULL) return phrase_text(e->phrase);
+  return "";
+}
+
+
+static unsigned long long percentile(
+  const unsigned long long *histogram, unsigned long long total, double q)
+{
+  unsigned long long needed = (unsigned long long)(q * total);
+  unsigned long long seen = 0;
+  int i;
+
+  if (needed == 0) needed = 1;
+  for (i = 0; i < HISTOGRAM_SIZE; ++i) {
+    seen += histogram[i];
+    if (seen >= needed) return bucket_floor(i);
+  }
+  return 0;
+}
+
+
+static void print_report(
+  const struct worker *w, const struct tree_info *info,
+  const struct sim_options *options, int threads)
+{
+  long runs = options->runs;
+  char where[300];
+  int  i, width = 5, n;
+
+  printf("Simulated %ld runs on %d thread%s (seed %llu, loop cap %ld)\n\n",
+    runs, threads, threads == 1 ? "" : "s", options->seed, options->loop_cap);
+
+  printf("Path length (statements executed per run):\n");
+  printf("  min %llu  mean %.2f  p50 %llu  p90 %llu  p99 %llu  max %llu\n",
+    w->min_length, (double)w->total_length / runs,
+    percentile(w->histogram, runs, 0.50),
+    percentile(w->histogram, runs, 0.90),
+    percentile(w->histogram, runs, 0.99),
+    w->max_length);
+  if (w->capped_runs != 0) {
+    printf("  %llu runs (%.2f%%) were cut short by the loop cap.\n",
+      w->capped_runs, 100.0 * w->capped_runs / runs);
+  }
+  printf("Questions per run (conditions and SWITCH menus): %.2f\n",
+    (double)w->questions / runs);
+  if (options->adaptive) {
+    printf("  Operands were reordered %ld times.\n", w->adapter->reorders);
+  }
+
+  // The line column is as wide as the longest label (imported lines name their file).
+  for (i = 0; i < info->statement_count; ++i) {
+    struct statement *s = info->statements[i];
+    n = (int)strlen(line_label(where, sizeof(where), s->module, s->line));
+    if (n > width) width = n;
+  }
+  printf("\n%*s  statement   per run  details\n", width, "line");
+  for (i = 0; i < info->statement_count; ++i) {
+    struct statement        *s = info->statements[i];
+    const struct node_stats *n = &w->stats[i];
+    char details[80] = "";
+
+    switch (s->type) {
+      case FORtype:
+      case WHILEtype:
+      case REPEATtype:
+        if (n->executions != 0) {
+          sprintf(details, "trips %.2f  max %llu",
+            (double)n->iterations / n->executions, n->max_trips);
+          if (n->cap_hits != 0) {
+            sprintf(details + strlen(details), "  capped %llu", n->cap_hits);
+          }
+        }
+        break;
+
+      case IFtype:
+      case IFELSEtype:
+        if (n->executions != 0) {
+          sprintf(details, "true %.1f%%", 100.0 * n->true_count / n->executions);
+        }
+        break;
+
+      case SWITCHtype:
+        if (n->executions != 0) {
+          sprintf(details, "matched %.1f%%",
+            100.0 * n->true_count / n->executions);
+        }
+        break;
+
+      default:
+        break;
+    }
+    printf("%*s  %-9s %9.3f  %-28s %.40s\n",
+      width, line_label(where, sizeof(where), s->module, s->line),
+      statement_type_name(s->type), (double)n->executions / runs, details,
+      describe(s));
+  }
+}
+
+//-----------------------------
+//      External Functions
+//-----------------------------
+
+void sim_default_options(struct sim_options *options)
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  options->runs                = 100000;
+  options->threads             = cpus > 0 ? (int)cpus : 1;
+  options->loop_cap            = 1000;
+  options->seed                = 1;
+  options->default_probability = 0.5;
+  options->probability_file    = NULL;
+  options->adaptive            = 0;
+}
+
+
+int simulate(
+  struct statement_list    *top,
+  const struct tree_info   *info,
+  const struct sim_options *options)
+{
+  struct model        model;
+  struct worker      *workers;
+  unsigned long long  seed = options->seed;
+  int                 threads = options->threads;
+  int                 i, j;
+
+  if (top == NULL || options->runs <= 0) return 0;
+  if (threads < 1) threads = 1;
+  if (threads > options->runs) threads = (int)options->runs;
+  if (!build_model(&model, top, info, options)) return 0;
+
+  workers = (struct worker *)calloc(threads, sizeof(struct worker));
+  for (i = 0; i < threads; ++i) {
+    struct worker *w = &workers[i];
+    w->model = &model;
+    w->runs  = options->runs / threads + (i < options->runs % threads);
+    w->stats = (struct node_stats *)
+      calloc(info->statement_count + 1, sizeof(struct node_stats));
+    rng_seed(&w->random, &seed);
+    if (options->adaptive) w->adapter = new_adapter(info, NULL);
+  }
+
+  // Worker 0 runs on this thread.
+  for (i = 1; i < threads; ++i) {
+    if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) {
+      printf("Unable to start simulation thread %d.\n", i);
+      exit(EXIT_FAILURE);
+    }
+  }
+  worker_main(&workers[0]);
+  for (i = 1; i < threads; ++i) pthread_join(workers[i].thread, NULL);
+
+  // Fold every worker's results into worker 0.
+  for (i = 1; i < threads; ++i) {
+    struct worker *w = &workers[i];
+    for (j = 0; j < info->statement_count; ++j) {
+      struct node_stats *to = &workers[0].stats[j], *from = &w->stats[j];
+      to->executions += from->executions;
+      to->iterations += from->iterations;
+      to->cap_hits   += from->cap_hits;
+      to->true_count += from->true_count;
+      if (from->max_trips > to->max_trips) to->max_trips = from->max_trips;
+    }
+    for (j = 0; j < HISTOGRAM_SIZE; ++j) {
+      workers[0].histogram[j] += w->histogram[j];
+    }
+    workers[0].total_length += w->total_length;
+    workers[0].questions    += w->questions;
+    if (options->adaptive) workers[0].adapter->reorders += w->adapter->reorders;
+    workers[0].capped_runs  += w->capped_runs;
+    if (w->min_length < workers[0].min_length) {
+      workers[0].min_length = w->min_length;
+    }
+    if (w->max_length > workers[0].max_length) {
+      workers[0].max_length = w->max_length;
+    }
+  }
+
+  print_report(&workers[0], info, options, threads);
+
+  for (i = 0; i < threads; ++i) {
+    free(workers[i].stats);
+    free_adapter(workers[i].adapter);
+  }
+  free(workers);
+  free(model.condition_threshold);
+  free(model.case_threshold);
+  return 1;
+}
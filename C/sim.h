@@ -0,0 +1,60 @@
+/****************************************************************************
+FILE          : sim.h
+LAST REVISION : 2026-10-19
+SUBJECT       : Interface to the Monte Carlo simulator.
+PROGRAMMER    : (C) Copyright 2026 by Peter Chapin
+
+The simulator executes the program many times with every decision made
+at random. Each condition phrase is true with some probability and each
+CASE phrase matches with some probability. Probabilities come from a
+side file or from a default. The result is a statistical picture of the
+program: how often each statement runs, how many times each loop goes
+around, and how long complete executions are.
+
+Please send comments or bug reports to
+
+     Peter Chapin
+     Vermont Technical College
+     Randolph Center, VT 05061
+     pchapin@ecet.vtc.edu
+****************************************************************************/
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "tree.h"
+
+struct sim_options {
+  long               runs;                 // Number of executions.
+  int                threads;              // Worker threads to use.
+  long               loop_cap;             // Iterations allowed per loop entry.
+  unsigned long long seed;                 // Seed for the random streams.
+  double             default_probability;  // For phrases not in the file.
+  const char        *probability_file;     // NULL if there is none.
+  int                adaptive;             // Reorder AND and OR operands?
+};
+
+// Fill in default options.
+void sim_default_options(struct sim_options *options);
+
+// Run the simulation and print the report to stdout. Returns zero on
+// failure. The tree must have been through prepare_tree(), and also
+// through optimize_expressions() if the ordering is adaptive.
+//
+// The probability file, if any, has one phrase in brackets per line
+// followed by a number between 0 and 1. For a condition phrase this is
+// the chance it is true. For a CASE phrase it is the chance the case is
+// accepted when offered. Lines starting with '#' are ignored.
+//
+int simulate(
+  struct statement_list    *top,
+  const struct tree_info   *info,
+  const struct sim_options *options);
+
+// Reads a probability file into an array indexed by phrase ID (see
+// intern.h), which must have room for every phrase. Entries not mentioned
+// in the file are left as they are. Returns zero (after printing why) if
+// the file can't be read or has errors.
+int load_probabilities(const char *file_name, double *probability);
+
+#endif
@@ -1,15 +1,11 @@
 /****************************************************************************
 FILE          : tree.c
-LAST REVISION : 2003-03-22
+LAST REVISION : 2026-10-19
 SUBJECT       : Helper functions for parse tree building.
 PROGRAMMER    : (C) Copyright 2003 by Peter Chapin
 
 This file implements the functions declared in tree.h
 
-To Do:
-
-+ Fix execute_case_list so that the default case is properly handled.
-
 Please send comments or bug reports to
 
      Peter Chapin
@@ -18,8 +14,21 @@ Please send comments or bug reports to
      pchapin@ecet.vtc.edu
 ****************************************************************************/
 
+#include <ctype.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "adapt.h"
+#include "budget.h"
+#include "checkpoint.h"
+#include "cover.h"
+#include "debug.h"
+#include "events.h"
+#include "intern.h"
+#include "memo.h"
+#include "memstat.h"
+#include "module.h"
 #include "tree.h"
 
 struct case_branch *new_case_branch_node(
@@ -28,7 +37,7 @@ struct case_branch *new_case_branch_node(
 {
   // Allocate space for the structure.
   struct case_branch *p =
-    (struct case_branch *)malloc(sizeof(struct case_branch));
+    (struct case_branch *)mem_alloc(MEM_CASE_BRANCH, sizeof(struct case_branch));
   if (p == NULL) {
     // COMPLAIN!
   }
@@ -36,6 +45,11 @@ struct case_branch *new_case_branch_node(
   // Fill it in.
   p->first          = first;
   p->case_condition = case_condition;
+  p->line           = 0;
+  p->end_line       = 0;
+  p->module         = 0;
+  p->id             = -1;
+  p->phrase         = -1;
 
   return p;
 } 
@@ -47,7 +61,7 @@ struct case_list *new_case_list_node(
 {
   // Allocate space for the structure.
   struct case_list *p =
-    (struct case_list *)malloc(sizeof(struct case_list));
+    (struct case_list *)mem_alloc(MEM_CASE_LIST, sizeof(struct case_list));
   if (p == NULL) {
     // COMPLAIN!
   }
@@ -68,7 +82,7 @@ struct expression *new_expression_node(
 {
   // Allocate space for the structure.
   struct expression *p =
-    (struct expression *)malloc(sizeof(struct expression));
+    (struct expression *)mem_alloc(MEM_EXPRESSION, sizeof(struct expression));
   if (p == NULL) {
     // COMPLAIN!
   }
@@ -78,6 +92,10 @@ struct expression *new_expression_node(
   p->second = second;
   p->op     = op;
   p->ep     = ep;
+  p->id     = -1;
+  p->phrase = -1;
+  p->operands = NULL;
+  p->count    = 0;
 
   return p;
 } 
@@ -89,11 +107,12 @@ struct statement *new_statement_node(
   struct statement_list *first,
   struct statement_list *second,
   vtc_string            *ep,
-  struct case_list      *cl)
+  struct case_list      *cl,
+  int                    line)
 {
   // Allocate space for the structure.
   struct statement *p =
-    (struct statement *)malloc(sizeof(struct statement));
+    (struct statement *)mem_alloc(MEM_STATEMENT, sizeof(struct statement));
   if (p == NULL) {
     // COMPLAIN!
   }
@@ -105,6 +124,17 @@ struct statement *new_statement_node(
   p->second      = second;
   p->ep          = ep;
   p->cl          = cl;
+  p->estimate    = NULL;
+  p->cases       = NULL;
+  p->case_count  = 0;
+  p->default_case = NULL;
+  p->line        = line;
+  p->else_line   = 0;
+  p->end_line    = 0;
+  p->foreach     = 0;
+  p->module      = 0;
+  p->id          = -1;
+  p->phrase      = -1;
 
   return p;
 }
@@ -116,7 +146,7 @@ struct statement_list *new_statement_list_node(
 {
   // Allocate space for the structure.
   struct statement_list *p =
-    (struct statement_list *)malloc(sizeof(struct statement_list));
+    (struct statement_list *)mem_alloc(MEM_STATEMENT_LIST, sizeof(struct statement_list));
   if (p == NULL) {
     // COMPLAIN!
   }
@@ -124,25 +154,692 @@ struct statement_list *new_statement_list_node(
   // Fill it in.
   p->first  = first;
   p->second = second;
+  p->items  = NULL;
+  p->count  = 0;
+
+  return p;
+}
+
+// -------------------
+// Copying.
+// -------------------
+
+static vtc_string *copy_phrase(vtc_string *phrase)
+{
+  vtc_string *copy;
+
+  if (phrase == NULL) return NULL;
+  copy = (vtc_string *)mem_alloc(MEM_PHRASE, sizeof(vtc_string));
+  vtc_string_init(copy);
+  vtc_string_copy(copy, phrase);
+  return copy;
+}
+
+
+static struct expression *copy_expression(const struct expression *e)
+{
+  if (e == NULL) return NULL;
+  return new_expression_node(
+    copy_expression(e->first), copy_expression(e->second), e->op, copy_phrase(e->ep));
+}
+
+
+static struct case_list *copy_cases(const struct case_list *cl, int module)
+{
+  struct case_branch *b;
+
+  if (cl == NULL) return NULL;
+  b = new_case_branch_node(copy_statement_list(cl->second->first, NULL, module),
+    copy_phrase(cl->second->case_condition));
+  b->line     = cl->second->line;
+  b->end_line = cl->second->end_line;
+  b->module   = cl->second->module != 0 ? cl->second->module : module;
+  return new_case_list_node(copy_cases(cl->first, module), b);
+}
+
+
+static struct statement *copy_statement(const struct statement *s, int module)
+{
+  struct statement *copy = new_statement_node(s->type,
+    copy_expression(s->conditional),
+    copy_statement_list(s->first, NULL, module),
+    copy_statement_list(s->second, NULL, module),
+    copy_phrase(s->ep),
+    copy_cases(s->cl, module),
+    s->line);
+
+  copy->else_line = s->else_line;
+  copy->end_line  = s->end_line;
+  copy->foreach   = s->foreach;
+  copy->module    = s->module != 0 ? s->module : module;
+  copy->estimate  = copy_phrase(s->estimate);
+  return copy;
+}
+
+
+struct statement_list *copy_statement_list(
+  const struct statement_list *list, struct statement_list *before, int module)
+{
+  struct statement_list *head = NULL, **link = &head;
+
+  for (; list != NULL; list = list->first) {
+    *link = new_statement_list_node(NULL, copy_statement(list->second, module));
+    link  = &(*link)->first;
+  }
+  *link = before;
+  return head;
+}
+
+// -------------------
+// Tree preparation.
+// -------------------
+
+// Append a pointer to one of the ID indexed arrays in a tree_info.
+static void record_node(void ***array, int *count, void *node)
+{
+  if ((*count & (*count - 1)) == 0) {
+    *array = (void **)mem_realloc(MEM_ARRAY, *array,
+      *count * sizeof(void *), (*count ? 2 * *count : 1) * sizeof(void *));
+  }
+  (*array)[(*count)++] = node;
+}
+
+
+static int intern_ep(vtc_string *ep, const struct tree_info *info)
+{
+  if (!info->interned) return -1;
+  return intern_phrase(vtc_string_getcharp(ep), vtc_string_length(ep));
+}
+
+
+static void prepare_expression(struct expression *e, struct tree_info *info)
+{
+  if (e == NULL) return;
+  e->id = info->expression_count;
+  record_node((void ***)&info->expressions, &info->expression_count, e);
+  if (e->ep != NULL) e->phrase = intern_ep(e->ep, info);
+  prepare_expression(e->first, info);
+  prepare_expression(e->second, info);
+}
+
+
+static void prepare_list(struct statement_list *list, struct tree_info *info);
+
+static void prepare_cases(struct case_list *cl, struct tree_info *info)
+{
+  // Case lists are left recursive; the first case written is deepest.
+  if (cl == NULL) return;
+  prepare_cases(cl->first, info);
+  cl->second->id = info->case_count;
+  record_node((void ***)&info->cases, &info->case_count, cl->second);
+  if (cl->second->case_condition != NULL) {
+    cl->second->phrase = intern_ep(cl->second->case_condition, info);
+  }
+  prepare_list(cl->second->first, info);
+}
+
+
+// Lists the CASE branches of a SWITCH in source order and finds its
+// DEFAULT. A DEFAULT after the first can never run. Every branch of a
+// PARALLEL is listed.
+static void flatten_cases(struct statement *s)
+{
+  struct case_list *cl;
+  int parallel = s->type == PARALLELtype;
+  int count = 0;
+
+  for (cl = s->cl; cl != NULL; cl = cl->first) {
+    if (cl->second->case_condition != NULL || parallel) ++count;
+    else s->default_case = cl->second;
+  }
+  if (count == 0) return;
+  s->cases =
+    (struct case_branch **)mem_alloc(MEM_ARRAY, count * sizeof(struct case_branch *));
+  s->case_count = count;
+  for (cl = s->cl; cl != NULL; cl = cl->first) {
+    if (cl->second->case_condition != NULL || parallel) s->cases[--count] = cl->second;
+  }
+}
+
+
+static void prepare_statement(struct statement *s, struct tree_info *info)
+{
+  s->id = info->statement_count;
+  record_node((void ***)&info->statements, &info->statement_count, s);
+  if (s->ep != NULL) s->phrase = intern_ep(s->ep, info);
+  prepare_expression(s->conditional, info);
+  prepare_list(s->first, info);
+  prepare_list(s->second, info);
+  prepare_cases(s->cl, info);
+  flatten_cases(s);
+}
+
+
+// Statement lists are left recursive so the last statement is at the
+// head. Walking them recursively would need stack space proportional to
+// the length of the list; instead the list is copied into an array.
+//
+static void prepare_list(struct statement_list *list, struct tree_info *info)
+{
+  struct statement_list *p;
+  int count = 0;
+  int i;
+
+  if (list == NULL) return;
+  for (p = list; p != NULL; p = p->first) ++count;
+  list->items =
+    (struct statement **)mem_alloc(MEM_ARRAY, count * sizeof(struct statement *));
+  list->count = count;
+  for (p = list, i = count - 1; p != NULL; p = p->first, --i) {
+    list->items[i] = p->second;
+  }
+  for (i = 0; i < count; ++i) prepare_statement(list->items[i], info);
+}
+
+
+static void start_tree(struct statement_list *top, struct tree_info *info, int interned)
+{
+  info->statement_count  = 0;
+  info->expression_count = 0;
+  info->case_count       = 0;
+  info->statements       = NULL;
+  info->expressions      = NULL;
+  info->cases            = NULL;
+  info->interned         = interned;
+  prepare_list(top, info);
+}
+
+
+void prepare_tree(struct statement_list *top, struct tree_info *info)
+{
+  start_tree(top, info, 1);
+}
+
+
+void number_tree(struct statement_list *top, struct tree_info *info)
+{
+  start_tree(top, info, 0);
+}
+
+
+// The size of an array filled by record_node().
+static size_t recorded_size(int count)
+{
+  size_t capacity = 1;
+
+  while (capacity < (size_t)count) capacity *= 2;
+  return capacity * sizeof(void *);
+}
+
+
+static void free_phrase(vtc_string *phrase)
+{
+  if (phrase == NULL) return;
+  vtc_string_destroy(phrase);
+  mem_free(MEM_PHRASE, phrase, sizeof(vtc_string));
+}
+
+
+static void free_list(struct statement_list *list)
+{
+  struct statement_list *next;
+
+  if (list == NULL) return;
+  mem_free(MEM_ARRAY, list->items, list->count * sizeof(struct statement *));
+  for (; list != NULL; list = next) {
+    next = list->first;
+    mem_free(MEM_STATEMENT_LIST, list, sizeof(struct statement_list));
+  }
+}
+
+
+void free_tree(struct statement_list *top, struct tree_info *info)
+{
+  struct case_list *cl, *next;
+  int i;
+
+  for (i = 0; i < info->statement_count; ++i) {
+    struct statement *s = info->statements[i];
+    free_phrase(s->ep);
+    free_phrase(s->estimate);
+    free_list(s->first);
+    free_list(s->second);
+    mem_free(MEM_ARRAY, s->cases, s->case_count * sizeof(struct case_branch *));
+    for (cl = s->cl; cl != NULL; cl = next) {
+      next = cl->first;
+      mem_free(MEM_CASE_LIST, cl, sizeof(struct case_list));
+    }
+    mem_free(MEM_STATEMENT, s, sizeof(struct statement));
+  }
+  for (i = 0; i < info->expression_count; ++i) {
+    struct expression *e = info->expressions[i];
+    free_phrase(e->ep);
+    mem_free(MEM_ARRAY, e->operands, e->count * sizeof(struct expression *));
+    mem_free(MEM_EXPRESSION, e, sizeof(struct expression));
+  }
+  for (i = 0; i < info->case_count; ++i) {
+    struct case_branch *b = info->cases[i];
+    free_phrase(b->case_condition);
+    free_list(b->first);
+    mem_free(MEM_CASE_BRANCH, b, sizeof(struct case_branch));
+  }
+  free_list(top);
+  mem_free(MEM_ARRAY, info->statements, recorded_size(info->statement_count));
+  mem_free(MEM_ARRAY, info->expressions, recorded_size(info->expression_count));
+  mem_free(MEM_ARRAY, info->cases, recorded_size(info->case_count));
+}
+
+
+int read_estimate(vtc_string *phrase, struct estimate *estimate)
+{
+  const char *p = vtc_string_getcharp(phrase) + 1;   // Past the '['.
+  double value[3];
+  char  *end;
+  int    count = 0;
+
+  for (;;) {
+    while (isspace((unsigned char)*p) || *p == ',') ++p;
+    if (*p == ']') break;
+    if (count == 3 || (!isdigit((unsigned char)*p) && *p != '.')) return 0;
+    value[count] = strtod(p, &end);
+    if (end == p || value[count] > 1e15) return 0;
+    if (count > 0 && value[count] < value[count - 1]) return 0;
+    ++count;
+    p = end;
+  }
+  if (count == 0) return 0;
+  if (estimate != NULL) {
+    estimate->count    = count;
+    estimate->low      = value[0];
+    estimate->high     = value[count - 1];
+    estimate->expected = count == 3 ? value[1] : (value[0] + value[count - 1]) / 2;
+  }
+  return 1;
+}
+
+
+const char *statement_type_name(enum statement_type type)
+{
+  switch (type) {
+    case BREAKtype:    return "BREAK";
+    case CONTINUEtype: return "CONTINUE";
+    case EPtype:       return "action";
+    case FORtype:      return "FOR";
+    case IFtype:       return "IF";
+    case IFELSEtype:   return "IF/ELSE";
+    case REPEATtype:   return "REPEAT";
+    case RETURNtype:   return "RETURN";
+    case SWITCHtype:   return "SWITCH";
+    case WHILEtype:    return "WHILE";
+    case PARALLELtype: return "PARALLEL";
+  }
+  return "?";
+}
+
+// ---------------
+// The executor.
+// ---------------
+
+// Writes prose for the user, counting it against the output budget.
+static void say(const char *format, ...)
+{
+  va_list args;
+  int length;
+
+  va_start(args, format);
+  length = vprintf(format, args);
+  va_end(args);
+  if (length > 0) budget_output(length);
+}
+
+
+// Reads one line of input for a question. Running out of input stops the
+// program. Otherwise a script that is too short (or p-code typed at
+// standard input) would leave the executor reading EOF forever. A line
+// starting with ! is a command for the checkpoint (see checkpoint.h),
+// after which the answer is read again.
+//
+static void read_line(char *line, int size)
+{
+  int ch;
+
+  checkpoint_question();
+  for (;;) {
+    events_flush();
+    if (fgets(line, size, stdin) == NULL) {
+      if (events_on) event_end("stop", "end of input");
+      else printf("\nEnd of input. Execution stopped.\n");
+      exit(EXIT_FAILURE);
+    }
+    if (strchr(line, '\n') == NULL) {
+      while ((ch = getchar()) != '\n' && ch != EOF) ;
+    }
+    if (events_on) event_translate_answer(line, size);
+    if (line[0] != '!') return;
+    checkpoint_command(line + 1);
+  }
+}
+
+
+int read_answer(void)
+{
+  char line[128];
 
+  read_line(line, sizeof(line));
+  return (unsigned char)line[0];
+}
+
+
+int read_choice(void)
+{
+  char line[128];
+  const char *p = line;
+  int number = 0;
+
+  read_line(line, sizeof(line));
+  while (*p == ' ' || *p == '\t') ++p;
+  for (; *p >= '0' && *p <= '9'; ++p) {
+    if (number < 100000000) number = 10 * number + (*p - '0');
+  }
+  return number;
+}
+
+
+// A loop condition may be answered in bulk, as in "true x1000 then false".
+// ask_condition() leaves such an answer here and the loop picks it up (see
+// loop_test()). The count may also be written *1000, just 1000, or with
+// the multiplication sign.
+static long bulk_count  = 0;   // Tests covered by the answer (0 if plain).
+static int  bulk_answer = 0;   // The answer given.
+static int  bulk_then   = -1;  // The answer after "then" or -1.
+
+static const char *skip_blanks(const char *p)
+{
+  while (*p == ' ' || *p == '\t') ++p;
   return p;
 }
 
+static int is_answer(int ch)
+{
+  return ch == 'T' || ch == 't' || ch == 'F' || ch == 'f';
+}
+
+// Like read_answer() but also looks for a bulk answer.
+static int read_loop_answer(void)
+{
+  char line[128];
+  const char *p;
+  char *end;
+  long count;
+
+  read_line(line, sizeof(line));
+  if (!is_answer(line[0])) return (unsigned char)line[0];
+
+  // Skip the rest of the word, then the multiplication sign if any.
+  for (p = line; isalpha((unsigned char)*p); ++p) ;
+  p = skip_blanks(p);
+  if (*p == 'x' || *p == 'X' || *p == '*') ++p;
+  else if ((unsigned char)p[0] == 0xC3 && (unsigned char)p[1] == 0x97) p += 2;
+  p = skip_blanks(p);
+  if (!isdigit((unsigned char)*p)) return line[0];
+  count = strtol(p, &end, 10);
+  if (count < 1) return line[0];
+
+  bulk_count  = count;
+  bulk_answer = line[0] == 'T' || line[0] == 't';
+  bulk_then   = -1;
+  p = skip_blanks(end);
+  if (strncmp(p, "then", 4) == 0 || strncmp(p, "THEN", 4) == 0) {
+    p = skip_blanks(p + 4);
+    if (is_answer(*p)) bulk_then = *p == 'T' || *p == 't';
+  }
+  return line[0];
+}
+
+
+// Set while the condition of a loop is evaluated. Its questions are
+// always asked (see memo.h).
+static int fresh_answers = 0;
+
+int quiet_fast_forward = 0;
+
+// Nonzero while the body of a loop runs on a bulk answer. Actions are then
+// shown (unless quiet_fast_forward is set) but not waited for.
+static int  fast_forward_depth = 0;
+static long hidden_actions = 0;
+
+// What a loop does with a bulk answer to its condition.
+struct fast_forward {
+  long remaining;   // Tests that come out like the one answered in bulk.
+  int  outcome;     // How they come out.
+  int  flip;        // Does the test after them come out the other way?
+  int  active;      // Does the next iteration run without asking?
+  long iterations;  // Iterations run that way (for the summary).
+  long hidden;      // hidden_actions when the loop started.
+};
+
+// The frames of the current position (see tree.h). The loop state lives in
+// execute_statement(), so a frame only points at it.
+struct frame {
+  struct statement    *statement;
+  int                  index;
+  int                  part;
+  int                 *trips;
+  struct fast_forward *ff;
+};
+
+static struct frame *frames;
+static int           depth;
+static int           frame_capacity;
+
+// The position to resume at and how much of it has been reached.
+static struct position *resume_frames;
+static int              resume_depth;
+static int              resume_level;
+
+
+int execution_position(struct position *out, int capacity)
+{
+  const struct frame *f;
+  int i;
+
+  for (i = 0; i < depth && i < capacity; ++i) {
+    f = &frames[i];
+    memset(&out[i], 0, sizeof(struct position));
+    out[i].statement = f->statement->id;
+    out[i].index     = f->index;
+    out[i].part      = f->part;
+    if (f->trips != NULL) out[i].trips = *f->trips;
+    if (f->ff != NULL) {
+      out[i].remaining  = f->ff->remaining;
+      out[i].outcome    = f->ff->outcome;
+      out[i].flip       = f->ff->flip;
+      out[i].active     = f->ff->active;
+      out[i].iterations = f->ff->iterations;
+    }
+  }
+  return depth;
+}
+
+
+void write_position(FILE *out)
+{
+  const struct statement *s;
+  char where[300];
+  int i;
+
+  for (i = 0; i < depth; ++i) {
+    s = frames[i].statement;
+    fprintf(out, "  %s: %s",
+      describe_line(where, sizeof(where), s->module, s->line), statement_type_name(s->type));
+    if (s->phrase >= 0) fprintf(out, " %s", phrase_text(s->phrase));
+    if (frames[i].trips != NULL && *frames[i].trips > 0) {
+      fprintf(out, " (iteration %d)", *frames[i].trips);
+    }
+    fprintf(out, "\n");
+  }
+}
+
+
+void resume_execution(const struct position *positions, int count)
+{
+  free(resume_frames);
+  resume_frames = (struct position *)malloc((count + 1) * sizeof(struct position));
+  memcpy(resume_frames, positions, count * sizeof(struct position));
+  resume_depth = count;
+  resume_level = 0;
+}
+
+
+// If the statement about to run is on the way to the resume position,
+// restores its loop state and returns the part to continue with.
+// Otherwise returns -2 (run the statement from the start).
+static int resume_statement(int *trips, struct fast_forward *ff)
+{
+  const struct position *r;
+
+  if (resume_level >= resume_depth) return -2;
+  r = &resume_frames[resume_level++];
+  *trips         = r->trips;
+  ff->remaining  = r->remaining;
+  ff->outcome    = r->outcome;
+  ff->flip       = r->flip;
+  ff->active     = r->active;
+  ff->iterations = r->iterations;
+  return r->part;
+}
+
+
+static void set_part(int level, int part)
+{
+  frames[level].part = part;
+}
+
 
 enum abort_type execute_statement_list(struct statement_list *list)
 {
   enum abort_type result = NORMAL;
+  int i = 0;
+
+  if (resume_level < resume_depth) i = resume_frames[resume_level].index;
+  for (; i < list->count && result == NORMAL; ++i) {
+    if (depth == frame_capacity) {
+      frame_capacity = frame_capacity == 0 ? 16 : 2 * frame_capacity;
+      frames = (struct frame *)realloc(frames, frame_capacity * sizeof(struct frame));
+    }
+    frames[depth].statement = list->items[i];
+    frames[depth].index     = i;
+    frames[depth].part      = AT_QUESTION;
+    frames[depth].trips     = NULL;
+    frames[depth].ff        = NULL;
+    ++depth;
+    result = execute_statement(list->items[i]);
+    --depth;
+  }
+  return result;
+}
+
+
+static int test(struct expression *condition, int fresh)
+{
+  int result;
+
+  memo_enter(MEMO_EVALUATION);
+  fresh_answers = fresh;
+  result = evaluate_expression(condition);
+  fresh_answers = 0;
+  memo_leave(MEMO_EVALUATION);
+  return result;
+}
 
-  if (list->first) result = execute_statement_list(list->first);
-  if (result == NORMAL) result = execute_statement(list->second);
+
+// Tests the condition of a loop unless a bulk answer already covers it.
+static int loop_test(struct statement *loop, struct fast_forward *ff)
+{
+  int result;
+
+  ff->active = 0;
+  if (ff->remaining > 0) {
+    --ff->remaining;
+    ff->active = 1;
+    return ff->outcome;
+  }
+  if (ff->flip) {
+    ff->flip = 0;
+    return !ff->outcome;
+  }
+
+  bulk_count = 0;
+  result = test(loop->conditional, 1);
+  if (bulk_count > 0) {
+    // A "then" answer that agrees with the first is one more of the same.
+    ff->outcome   = result;
+    ff->remaining = bulk_count - 1 + (bulk_then == bulk_answer);
+    ff->flip      = bulk_then >= 0 && bulk_then != bulk_answer;
+    ff->active    = 1;
+    bulk_count    = 0;
+  }
+  return result;
+}
+
+
+static enum abort_type run_iteration(struct statement_list *body, struct fast_forward *ff)
+{
+  enum abort_type result;
+
+  if (!ff->active) return execute_statement_list(body);
+  ++fast_forward_depth;
+  result = execute_statement_list(body);
+  --fast_forward_depth;
   return result;
 }
 
 
+// Says how many iterations of a loop ran on a bulk answer.
+static void report_fast_forward(struct statement *loop, const struct fast_forward *ff)
+{
+  char where[300];
+
+  if (events_on || ff->iterations == 0) return;
+  if (quiet_fast_forward && fast_forward_depth > 0) return;
+  say("(%ld iteration%s of the loop on %s ran without asking",
+    ff->iterations, ff->iterations == 1 ? "" : "s",
+    describe_line(where, sizeof(where), loop->module, loop->line));
+  if (hidden_actions > ff->hidden) {
+    say("; %ld action%s not shown", hidden_actions - ff->hidden,
+      hidden_actions - ff->hidden == 1 ? "" : "s");
+  }
+  say(")\n");
+}
+
+
+static enum abort_type execute_switch(struct statement *s, int level, int part);
+static void execute_parallel(struct statement *s, int level, int part);
+
+
+// The part of a statement to run first when resuming is given by
+// resume_statement(). A resumed IF or SWITCH goes straight into the list
+// it was in and a resumed loop carries on with the iteration it was in.
+// Branch coverage for a decision made before the checkpoint is not
+// recorded again.
+//
 enum abort_type execute_statement(struct statement *statement)
 {
   enum abort_type result = NORMAL;
+  struct fast_forward ff = { 0, 0, 0, 0, 0, 0 };
+  int level = depth - 1;
+  int trips = 0;
+  int part;
+  int done;
 
+  frames[level].trips = &trips;
+  frames[level].ff    = &ff;
+  part = resume_statement(&trips, &ff);
+  if (part < 0) {
+    budget_statement();
+    debug_statement(statement);
+  }
+  memo_enter(MEMO_STATEMENT);
   switch (statement->type) {
     case BREAKtype:
       result = fromBREAK;
@@ -153,84 +850,199 @@ enum abort_type execute_statement(struct statement *statement)
       break;
 
     case EPtype:
-      printf("%s\n", vtc_string_getcharp(statement->ep));
-      while (getchar() != '\n') ;
+      if (fast_forward_depth > 0 && quiet_fast_forward) {
+        ++hidden_actions;
+      }
+      else if (events_on) {
+        event_action(statement);
+      }
+      else {
+        say("%s\n", vtc_string_getcharp(statement->ep));
+        if (fast_forward_depth == 0) read_answer();
+      }
       break;
 
     case FORtype:
     case WHILEtype:
-      while (evaluate_expression(statement->conditional)) {
-        result = execute_statement_list(statement->first);
+      ff.hidden = hidden_actions;
+      if (events_on && part == -2) event_loop(statement);
+      for (;;) {
+        memo_enter(MEMO_ITERATION);
+        if (part != 0) {
+          if (!loop_test(statement, &ff)) {
+            memo_leave(MEMO_ITERATION);
+            break;
+          }
+          trips++;
+          if (ff.active) ++ff.iterations;
+        }
+        set_part(level, 0);
+        result = run_iteration(statement->first, &ff);
+        set_part(level, AT_QUESTION);
+        part = -2;
+        memo_leave(MEMO_ITERATION);
         if (result == fromBREAK) break;
-        if (result == fromCONTINUE) continue;
       }
+      report_fast_forward(statement, &ff);
+      if (events_on) event_exit(statement, trips, ff.iterations);
+      cover_branch(statement, trips == 0 ? 0 : 1);
       result = NORMAL;
       break;
 
     case IFtype:
-      if (evaluate_expression(statement->conditional)) {
-        result = execute_statement_list(statement->first);
-      }
-      break;
-
     case IFELSEtype:
-      if (evaluate_expression(statement->conditional)) {
+      if (part < 0) {
+        part = test(statement->conditional, 0) ? 0 : 1;
+        cover_branch(statement, part);
+      }
+      set_part(level, part);
+      if (part == 0) {
         result = execute_statement_list(statement->first);
       }
-      else {
+      else if (statement->type == IFELSEtype) {
         result = execute_statement_list(statement->second);
       }
       break;
 
     case REPEATtype:
-      do {
-        result = execute_statement_list(statement->first);
-        if (result == fromBREAK) break;
-        if (result == fromCONTINUE) continue;
-      } while (!evaluate_expression(statement->conditional));
+      ff.hidden = hidden_actions;
+      if (events_on && part == -2) event_loop(statement);
+      for (;;) {
+        memo_enter(MEMO_ITERATION);
+        result = NORMAL;
+        if (part != AT_QUESTION) {
+          if (part != 0) {
+            trips++;
+            ff.active = ff.remaining > 0 || ff.flip;
+            if (ff.active) ++ff.iterations;
+          }
+          set_part(level, 0);
+          result = run_iteration(statement->first, &ff);
+          set_part(level, AT_QUESTION);
+        }
+        part = -2;
+        done = result == fromBREAK || loop_test(statement, &ff);
+        memo_leave(MEMO_ITERATION);
+        if (done) break;
+      }
+      report_fast_forward(statement, &ff);
+      if (events_on) event_exit(statement, trips, ff.iterations);
+      cover_branch(statement, trips == 1 ? 0 : 1);
       result = NORMAL;
       break;
 
     case RETURNtype:
-      printf("\nRETURN not implemented!\n");
+      if (events_on) event_return(statement);
+      else say("\nRETURN not implemented!\n");
       break;
 
     case SWITCHtype:
-      printf("Which of the following is %s?\n",
-        vtc_string_getcharp(statement->ep));
-      result = execute_case_list(statement->cl);
+      result = execute_switch(statement, level, part);
+      break;
+
+    case PARALLELtype:
+      execute_parallel(statement, level, part);
       break;
   }
 
+  memo_leave(MEMO_STATEMENT);
   return result;
 }
 
 
-enum abort_type execute_case_list(struct case_list *cl)
+// Offers one numbered menu of the CASE branches and runs the chosen one,
+// or the DEFAULT if none is chosen. A resumed SWITCH (part >= 0) goes
+// straight to the case it was in.
+static enum abort_type execute_switch(struct statement *s, int level, int part)
 {
-  enum abort_type result = NORMAL;
-  int ch;
+  struct case_branch *chosen = s->default_case;
+  int choice = 0, i;
 
-  // The NULL ep is the default case. I don't handle that right.
-  if (cl->second->case_condition == NULL) return result;
+  if (part >= 0) {
+    chosen = part < s->case_count ? s->cases[part] : s->default_case;
+    set_part(level, part);
+    return execute_statement_list(chosen->first);
+  }
 
-  printf("%s Match? [y/n] ", vtc_string_getcharp(cl->second->case_condition));
-  ch = getchar();
-  while (getchar() != '\n') ;
-  if (ch == 'Y' || ch == 'y') {
-    result = execute_statement_list(cl->second->first);
+  if (events_on) {
+    event_menu(s);
   }
-  else if (cl->first != NULL) {
-    result = execute_case_list(cl->first);
+  else {
+    say("Which of the following is %s?\n", vtc_string_getcharp(s->ep));
+    for (i = 0; i < s->case_count; ++i) {
+      say("  %d. %s\n", i + 1, vtc_string_getcharp(s->cases[i]->case_condition));
+    }
+    if (s->case_count > 0) say("Which one (0 for none)? ");
   }
-  return result;
+  if (s->case_count > 0) {
+    budget_decision();
+    // A number past the last case is a slip, not a choice of none.
+    while ((choice = read_choice()) > s->case_count) {
+      if (events_on) event_menu(s);
+      else say("There are only %d. Which one (0 for none)? ", s->case_count);
+    }
+  }
+  if (choice >= 1 && choice <= s->case_count) chosen = s->cases[choice - 1];
+  if (events_on) event_switch(s, chosen == s->default_case ? 0 : choice, chosen);
+  if (chosen == NULL) return NORMAL;
+  cover_case(chosen);
+  set_part(level, choice >= 1 && choice <= s->case_count ? choice - 1 : s->case_count);
+  return execute_statement_list(chosen->first);
+}
+
+
+// Runs the branches of a PARALLEL as logical threads that each run to
+// the end before the next starts: one of the schedules the explorer (see
+// explore.h) looks at. A BREAK or CONTINUE that isn't inside a loop of
+// its branch ends that branch. A resumed PARALLEL carries on with the
+// branch it was in.
+static void execute_parallel(struct statement *s, int level, int part)
+{
+  int i;
+
+  for (i = part >= 0 ? part : 0; i < s->case_count; ++i) {
+    if (events_on) event_branch(s, i);
+    set_part(level, i);
+    execute_statement_list(s->cases[i]->first);
+  }
+}
+
+
+// Asks about one phrase of a condition.
+static int ask_condition(void *context, struct expression *prompt)
+{
+  int ch, answer;
+
+  (void)context;
+  if (events_on) {
+    event_question(frames[depth - 1].statement, prompt);
+  }
+  else {
+    say("%s\n", vtc_string_getcharp(prompt->ep));
+    say("True or False? ");
+  }
+  if (!fresh_answers && memo_recall(prompt->phrase, &answer)) {
+    if (events_on) event_answer(frames[depth - 1].statement, prompt, answer, 1);
+    else say("%s (as before)\n", answer ? "True" : "False");
+    return answer;
+  }
+  budget_decision();
+  ch = fresh_answers ? read_loop_answer() : read_answer();
+  answer = ch == 'T' || ch == 't';
+  memo_store(prompt->phrase, answer);
+  if (events_on) event_answer(frames[depth - 1].statement, prompt, answer, 0);
+  return answer;
 }
 
 
 int evaluate_expression(struct expression *sub)
 {
   int result = 0;
-  int ch;
+  int i;
+
+  if (execution_adapter != NULL) {
+    return adapt_evaluate(execution_adapter, sub, ask_condition, NULL);
+  }
 
   switch (sub->op) {
     case PASSop:
@@ -242,21 +1054,33 @@ int evaluate_expression(struct expression *sub)
       break;
 
     case ANDop:
-      result = evaluate_expression(sub->first) &&
-               evaluate_expression(sub->second);
+      if (sub->count == 0) {
+        result = evaluate_expression(sub->first) &&
+                 evaluate_expression(sub->second);
+        break;
+      }
+      // Optimized: stop at the first false operand.
+      result = 1;
+      for (i = 0; i < sub->count && result; ++i) {
+        result = evaluate_expression(sub->operands[i]);
+      }
       break;
 
     case ORop:
-      result = evaluate_expression(sub->first) ||
-               evaluate_expression(sub->second);
+      if (sub->count == 0) {
+        result = evaluate_expression(sub->first) ||
+                 evaluate_expression(sub->second);
+        break;
+      }
+      // Optimized: stop at the first true operand.
+      result = 0;
+      for (i = 0; i < sub->count && !result; ++i) {
+        result = evaluate_expression(sub->operands[i]);
+      }
       break;
 
     case PROMPTop:
-      printf("%s\n", vtc_string_getcharp(sub->ep));
-      printf("True or False? ");
-      ch = getchar();
-      while (getchar() != '\n') ;
-      if (ch == 'T' || ch == 't') result = 1;
+      result = ask_condition(NULL, sub);
       break;
   }
 
@@ -1,6 +1,6 @@
 /****************************************************************************
 FILE          : tree.h
-LAST REVISION : 2003-03-22
+LAST REVISION : 2026-10-19
 SUBJECT       : Declarations of tree handling functions.
 PROGRAMMER    : (C) Copyright 2003 by Peter Chapin
 
@@ -17,16 +17,19 @@ Please send comments or bug reports to
 #ifndef TREE_H
 #define TREE_H
 
+#include <stdio.h>
 #include "vtcstr.h"
 
 // Used to indicate the different statement types.
 enum statement_type
   { BREAKtype,  CONTINUEtype, EPtype,     FORtype,    IFtype,
-    IFELSEtype, REPEATtype,   RETURNtype, SWITCHtype, WHILEtype };
+    IFELSEtype, REPEATtype,   RETURNtype, SWITCHtype, WHILEtype,
+    PARALLELtype };
 
 // Used with the different expressions. PASSop means send the left
 // parameter as the value of this expression. PROMPTop means ask the
-// user.
+// user. After optimize_expressions() (see opt.h) ANDop and ORop nodes
+// take any number of operands.
 //
 enum operation { ORop, ANDop, NOTop, PASSop, PROMPTop };
 
@@ -41,10 +44,16 @@ struct expression;
 struct statement;
 struct statement_list;
 
-// Used to represent one branch of a case statement.
+// Used to represent one branch of a case statement. The branches of a
+// PARALLEL are kept the same way, without a case_condition.
 struct case_branch {
   struct statement_list *first;
   vtc_string            *case_condition;
+  int                    line;      // Line of CASE or DEFAULT (for the formatter).
+  int                    end_line;  // Line of the END (likewise).
+  int                    module;    // File the lines are in (see module_name()).
+  int                    id;      // Assigned by prepare_tree().
+  int                    phrase;  // Phrase ID of case_condition or -1.
 };
 
 // Used to represent a list of case branches.
@@ -59,6 +68,13 @@ struct expression {
   struct expression     *second;
   enum   operation       op;
   vtc_string            *ep;
+  int                    id;      // Assigned by prepare_tree().
+  int                    phrase;  // Phrase ID of ep or -1.
+
+  // The operands of an optimized AND or OR (first and second are then
+  // NULL). The count is zero in a tree fresh from the parser.
+  struct expression    **operands;
+  int                    count;
 };
 
 // Used to represent the various statement types.
@@ -69,12 +85,56 @@ struct statement {
   struct statement_list *second;
   vtc_string            *ep;
   struct case_list      *cl;
+  vtc_string            *estimate;  // COST of an action or BOUND of a loop, or NULL.
+
+  // The CASE branches of a SWITCH in source order and its DEFAULT (the
+  // first one, if there are several), or the branches of a PARALLEL.
+  // Filled in by prepare_tree().
+  struct case_branch   **cases;
+  int                    case_count;
+  struct case_branch    *default_case;
+
+  int                    line;    // Source line where the statement starts.
+  int                    else_line;  // Line of ELSE (for the formatter).
+  int                    end_line;   // Line of END or UNTIL (likewise).
+  int                    foreach;    // Written as FOREACH rather than FOR?
+  int                    module;     // File the lines are in (see module_name()).
+  int                    id;      // Assigned by prepare_tree().
+  int                    phrase;  // Phrase ID of ep or -1.
 };
 
 // Used to represent statement lists.
 struct statement_list {
   struct statement_list *first;
   struct statement      *second;
+
+  // The statements of the whole list in source order. Only the node at
+  // the head of a list (the one the parent statement points at) has
+  // these filled in; prepare_tree() does that.
+  struct statement     **items;
+  int                    count;
+};
+
+// The numbers of a COST or BOUND phrase, smallest first. One number is
+// the value (for a BOUND, the most trips), two are the least and the
+// most, and three are the least, the expected and the most.
+struct estimate {
+  double low;
+  double expected;
+  double high;
+  int    count;
+};
+
+// Summary information about a prepared tree. The arrays are indexed by
+// the IDs that prepare_tree() assigns. IDs are given out in source order.
+struct tree_info {
+  int                    statement_count;
+  int                    expression_count;
+  int                    case_count;
+  struct statement     **statements;
+  struct expression    **expressions;
+  struct case_branch   **cases;
+  int                    interned;  // Are the phrases in the phrase table?
 };
 
 // --------------
@@ -101,25 +161,101 @@ struct statement *new_statement_node(
   struct statement_list *first,
   struct statement_list *second,
   vtc_string            *ep,
-  struct case_list      *cl);
+  struct case_list      *cl,
+  int                    line);
 
 struct statement_list *new_statement_list_node(
   struct statement_list *first,
   struct statement      *second);
 
+// Copies a list fresh from the parser with everything in it. The copy
+// continues with 'before', as if its statements had been written after
+// those of 'before' (which may be NULL). Nodes of the list's own file
+// (module 0) are marked as coming from 'module' in the copy; nodes it
+// imported keep the module they came from.
+struct statement_list *copy_statement_list(
+  const struct statement_list *list,
+  struct statement_list       *before,
+  int                          module);
+
+// Number the nodes, intern the phrases and flatten the statement lists
+// of a freshly parsed tree. Every analysis pass expects this to be done.
+void prepare_tree(struct statement_list *top, struct tree_info *info);
+
+// The same, but the phrases are left out of the phrase table (which only
+// grows) and every phrase ID is -1. For a walker that goes by the text
+// of the phrases, such as the library's executor, in a process that
+// parses many programs.
+void number_tree(struct statement_list *top, struct tree_info *info);
+
+// Release a prepared tree and the arrays of its tree_info.
+void free_tree(struct statement_list *top, struct tree_info *info);
+
+// Reads a COST or BOUND phrase into *estimate (if it isn't NULL). Returns
+// zero if the phrase isn't one to three numbers in order.
+int read_estimate(vtc_string *phrase, struct estimate *estimate);
+
+// Returns the keyword used for a statement type (for reports).
+const char *statement_type_name(enum statement_type type);
 
 enum abort_type { NORMAL, fromBREAK, fromCONTINUE };
 
+// A loop condition can be answered for many tests at once, for example
+// "true x1000 then false". The iterations that follow run without asking:
+// their actions are shown but not waited for. If quiet_fast_forward is set
+// they are not shown either, and only a count is printed.
+extern int quiet_fast_forward;
+
+// The position of the executor is kept as a stack of frames, one for each
+// statement it is inside, outermost first. A frame is either at the
+// question of its statement (the condition, menu or action) or running
+// one of its statement lists: part is 0 for the body of a loop or IF, 1
+// for an ELSE, for a SWITCH the number of the chosen case in cases[]
+// (case_count for the DEFAULT), and for a PARALLEL the number of the
+// branch running. See checkpoint.h.
+#define AT_QUESTION (-1)
+
+struct position {
+  int  statement;   // ID of the statement.
+  int  index;       // Its place in the enclosing statement list.
+  int  part;        // AT_QUESTION or the list being run.
+  int  trips;       // Iterations begun so far (loops only).
+  long remaining;   // The state of a bulk answer (loops only).
+  int  outcome;
+  int  flip;
+  int  active;
+  long iterations;
+};
+
+// Returns the depth of the current position and copies up to capacity
+// frames of it.
+int execution_position(struct position *frames, int capacity);
+
+// Lists the statements of the current position, outermost first, one per
+// line.
+void write_position(FILE *out);
+
+// Makes the next execute_statement_list() of the top level list continue
+// from the given position rather than start at the beginning. The frames
+// must describe a real position of the tree (checkpoint.c checks this).
+void resume_execution(const struct position *frames, int depth);
+
 // This function performs the actions of the statment list.
 enum abort_type execute_statement_list(struct statement_list *sub);
 
 // This function performs the action of the indicated statement.
 enum abort_type execute_statement(struct statement *sub);
 
-// This function executes a case list in a switch statement.
-enum abort_type execute_case_list(struct case_list *cl);
-
 // This function returns TRUE or FALSE.
 int evaluate_expression(struct expression *sub);
 
+// Reads one answer line and returns its first character. Stops the
+// program at end of input.
+int read_answer(void);
+
+// Reads one answer line and returns the number it starts with (after any
+// blanks), or zero if it doesn't start with one. Stops the program at end
+// of input.
+int read_choice(void);
+
 #endif
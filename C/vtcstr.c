@@ -79,6 +79,7 @@ Please send comments or bug reports to
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
+#include "memstat.h"
 #include "vtcstr.h"
 
 // Small enough to be easy on memory. Large enough to be useful.
@@ -112,7 +113,7 @@ int vtc_string_init(vtc_string *object)
 
   object->start = NULL;
 
-  temp = malloc(INITIAL_CAPACITY);
+  temp = mem_alloc(MEM_STRING, INITIAL_CAPACITY);
   if (temp == NULL) return 0;
 
   object->start    = temp;
@@ -124,13 +125,14 @@ int vtc_string_init(vtc_string *object)
 
 void vtc_string_destroy(vtc_string *object)
 {
-  free(object->start);
+  mem_free(MEM_STRING, object->start, object->capacity);
 }
 
 
 int vtc_string_erase(vtc_string *object)
 {
-  char *temp = realloc(object->start, INITIAL_CAPACITY);
+  char *temp =
+    mem_realloc(MEM_STRING, object->start, object->capacity, INITIAL_CAPACITY);
   if (temp == NULL) return 0;
 
   object->start    = temp;
@@ -157,7 +159,7 @@ int vtc_string_copy(vtc_string *object, const vtc_string *other)
   // Otherwise, reallocate myself.
   else {
     new_capacity = round_up(other->size);
-    temp = realloc(object->start, new_capacity);
+    temp = mem_realloc(MEM_STRING, object->start, object->capacity, new_capacity);
     if (temp == NULL) return 0;
     object->start = temp;
     memcpy(object->start, other->start, other->size);
@@ -186,7 +188,7 @@ int vtc_string_copycharp(vtc_string *object, const char *other)
   // Otherwise, reallocate myself.
   else {
     new_capacity = round_up(other_size);
-    temp = realloc(object->start, new_capacity);
+    temp = mem_realloc(MEM_STRING, object->start, object->capacity, new_capacity);
     if (temp == NULL) return 0;
     object->start = temp;
     memcpy(object->start, other, other_size);
@@ -242,7 +244,7 @@ int vtc_string_append(vtc_string *object, const vtc_string *other)
   // Otherwise, reallocate myself.
   else {
     new_capacity = round_up(object->size + other->size);
-    temp = realloc(object->start, new_capacity);
+    temp = mem_realloc(MEM_STRING, object->start, object->capacity, new_capacity);
     if (temp == NULL) return 0;
     object->start = temp;
     memcpy(object->start + object->size, other->start, other->size);
@@ -268,7 +270,7 @@ int vtc_string_appendcharp(vtc_string *object, const char *other)
   // Otherwise, reallocate myself.
   else {
     new_capacity = round_up(object->size + other_size);
-    temp = realloc(object->start, new_capacity);
+    temp = mem_realloc(MEM_STRING, object->start, object->capacity, new_capacity);
     if (temp == NULL) return 0;
     object->start = temp;
     memcpy(object->start + object->size, other, other_size);
@@ -293,7 +295,7 @@ int vtc_string_appendchar(vtc_string *object, char other)
   // Otherwise reallocate myself.
   else {
     new_capacity = round_up(object->size + 1);
-    temp = realloc(object->start, new_capacity);
+    temp = mem_realloc(MEM_STRING, object->start, object->capacity, new_capacity);
     if (temp == NULL) return 0;
     object->start = temp;
     *(object->start + object->size) = other;
@@ -340,7 +342,7 @@ int vtc_string_prepend(vtc_string *object, const vtc_string *other)
   }
 
   // I was able to create temp correctly... now gut it.
-  free(object->start);
+  mem_free(MEM_STRING, object->start, object->capacity);
   object->start    = temp.start;
   object->size     = temp.size;
   object->capacity = temp.capacity;
@@ -362,7 +364,7 @@ int vtc_string_prependcharp(vtc_string *object, const char *other)
   }
 
   // I was able to create temp correctly... now gut it.
-  free(object->start);
+  mem_free(MEM_STRING, object->start, object->capacity);
   object->start    = temp.start;
   object->size     = temp.size;
   object->capacity = temp.capacity;
@@ -384,7 +386,7 @@ int vtc_string_prependchar(vtc_string *object, char other)
   }
 
   // I was able to create temp correctly... now gut it.
-  free(object->start);
+  mem_free(MEM_STRING, object->start, object->capacity);
   object->start    = temp.start;
   object->size     = temp.size;
   object->capacity = temp.capacity;